@@ -121,6 +121,8 @@ public:
 
 private:
 
+	friend class b2World;
+
 	int32 AllocateNode();
 	void FreeNode(int32 node);
 
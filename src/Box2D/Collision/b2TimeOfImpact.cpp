@@ -25,8 +25,9 @@
 #include <cstdio>
 using namespace std;
 
-int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
-int32 b2_toiRootIters, b2_toiMaxRootIters;
+// TOI statistics, per thread : independent worlds can be stepped at once in different threads.
+thread_local int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
+thread_local int32 b2_toiRootIters, b2_toiMaxRootIters;
 
 struct b2SeparationFunction
 {
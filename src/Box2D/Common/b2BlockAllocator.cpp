@@ -41,7 +41,6 @@ int32 b2BlockAllocator::s_blockSizes[b2_blockSizes] =
 	640,	// 13
 };
 uint8 b2BlockAllocator::s_blockSizeLookup[b2_maxBlockSize + 1];
-bool b2BlockAllocator::s_blockSizeLookupInitialized;
 
 struct b2Chunk
 {
@@ -65,7 +64,9 @@ b2BlockAllocator::b2BlockAllocator()
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 	memset(m_freeLists, 0, sizeof(m_freeLists));
 
-	if (s_blockSizeLookupInitialized == false)
+	// The lookup is shared by all the allocators : a local static is initialized only once,
+	// even when worlds are created at once in different threads.
+	static const bool lookupInitialized = [] ()
 	{
 		int32 j = 0;
 		for (int32 i = 1; i <= b2_maxBlockSize; ++i)
@@ -81,9 +82,9 @@ b2BlockAllocator::b2BlockAllocator()
 				s_blockSizeLookup[i] = (uint8)j;
 			}
 		}
-
-		s_blockSizeLookupInitialized = true;
-	}
+		return true;
+	}();
+	B2_NOT_USED(lookupInitialized);
 }
 
 b2BlockAllocator::~b2BlockAllocator()
@@ -0,0 +1,83 @@
+#include <Box2D/Common/b2ThreadPool.h>
+
+b2ThreadPool::b2ThreadPool(int32 count)
+{
+	b2Assert(count > 0);
+	m_count = count;
+	m_task = NULL;
+	m_context = NULL;
+	m_generation = 0;
+	m_pending = 0;
+	m_quit = false;
+
+	for (int32 i = 1; i < m_count; ++i)
+	{
+		m_threads.push_back(std::thread(&b2ThreadPool::Work, this, i));
+	}
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_start.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); ++i)
+	{
+		m_threads[i].join();
+	}
+}
+
+void b2ThreadPool::Run(b2Task task, void* context)
+{
+	if (m_count == 1)
+	{
+		task(context, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = task;
+		m_context = context;
+		m_pending = m_count - 1;
+		++m_generation;
+	}
+	m_start.notify_all();
+
+	task(context, 0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [this] { return m_pending == 0; });
+}
+
+void b2ThreadPool::Work(int32 worker)
+{
+	uint32 generation = 0;
+	for (;;)
+	{
+		b2Task task;
+		void* context;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_start.wait(lock, [&] { return m_quit || m_generation != generation; });
+			if (m_quit)
+			{
+				return;
+			}
+			generation = m_generation;
+			task = m_task;
+			context = m_context;
+		}
+
+		task(context, worker);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			--m_pending;
+		}
+		m_done.notify_one();
+	}
+}
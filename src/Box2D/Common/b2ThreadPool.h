@@ -0,0 +1,46 @@
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include <Box2D/Common/b2Settings.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+/// A task run by every worker of a pool. The worker index is in [0, worker count).
+typedef void (*b2Task)(void* context, int32 worker);
+
+/// A fixed set of worker threads, sleeping between the tasks. This is not part of
+/// the original Box2D : it is used to solve the islands in parallel.
+class b2ThreadPool
+{
+public:
+	/// Create the pool. The calling thread of Run is a worker, so count - 1 threads are started.
+	explicit b2ThreadPool(int32 count);
+	~b2ThreadPool();
+
+	/// Get the number of workers, the calling thread included.
+	int32 GetWorkerCount() const { return m_count; }
+
+	/// Run the task on every worker, the calling thread being the worker 0,
+	/// and wait for all of them to finish.
+	void Run(b2Task task, void* context);
+
+private:
+	b2ThreadPool(const b2ThreadPool&);
+	void Work(int32 worker);
+
+	int32 m_count;
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_start;
+	std::condition_variable m_done;
+
+	b2Task m_task;
+	void* m_context;
+	uint32 m_generation;
+	int32 m_pending;
+	bool m_quit;
+};
+
+#endif
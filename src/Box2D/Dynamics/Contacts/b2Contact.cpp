@@ -35,7 +35,6 @@
 #include <Box2D/Dynamics/b2World.h>
 
 b2ContactRegister b2Contact::s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
-bool b2Contact::s_initialized = false;
 
 void b2Contact::InitializeRegisters()
 {
@@ -68,11 +67,9 @@ void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* dest
 
 b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator)
 {
-	if (s_initialized == false)
-	{
-		InitializeRegisters();
-		s_initialized = true;
-	}
+	// A local static is initialized only once, even when worlds are stepped at once in different threads.
+	static const bool initialized = (InitializeRegisters(), true);
+	B2_NOT_USED(initialized);
 
 	b2Shape::Type type1 = fixtureA->GetType();
 	b2Shape::Type type2 = fixtureB->GetType();
@@ -100,8 +97,6 @@ b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtu
 
 void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
 {
-	b2Assert(s_initialized == true);
-
 	if (contact->m_manifold.pointCount > 0)
 	{
 		contact->GetFixtureA()->GetBody()->SetAwake(true);
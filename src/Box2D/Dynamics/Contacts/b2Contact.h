@@ -184,7 +184,6 @@ protected:
 	void Update(b2ContactListener* listener);
 
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
-	static bool s_initialized;
 
 	uint32 m_flags;
 
@@ -24,6 +24,10 @@
 #include <Box2D/Dynamics/b2World.h>
 #include <Box2D/Common/b2StackAllocator.h>
 
+#if B2_SIMD_SOLVER
+#include <emmintrin.h>
+#endif
+
 #define B2_DEBUG_SOLVER 0
 
 struct b2ContactPositionConstraint
@@ -51,6 +55,10 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	m_positions = def->positions;
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
+	m_batches = NULL;
+	m_batchCount = 0;
+	m_scalarIndices = NULL;
+	m_scalarCount = 0;
 
 	// Initialize position independent portions of the constraints.
 	for (int32 i = 0; i < m_count; ++i)
@@ -129,6 +137,11 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 
 b2ContactSolver::~b2ContactSolver()
 {
+	if (m_scalarIndices != NULL)
+	{
+		m_allocator->Free(m_scalarIndices);
+		m_allocator->Free(m_batches);
+	}
 	m_allocator->Free(m_velocityConstraints);
 	m_allocator->Free(m_positionConstraints);
 }
@@ -243,6 +256,13 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			}
 		}
 	}
+
+#if B2_SIMD_SOLVER
+	if (m_step.simdSolver)
+	{
+		BuildBatches();
+	}
+#endif
 }
 
 void b2ContactSolver::WarmStart()
@@ -287,8 +307,19 @@ void b2ContactSolver::WarmStart()
 
 void b2ContactSolver::SolveVelocityConstraints()
 {
-	for (int32 i = 0; i < m_count; ++i)
+	// The groups first, then the constraints which couldn't be grouped.
+	int32 count = m_count;
+#if B2_SIMD_SOLVER
+	if (m_scalarIndices != NULL)
 	{
+		SolveBatches();
+		count = m_scalarCount;
+	}
+#endif
+
+	for (int32 n = 0; n < count; ++n)
+	{
+		int32 i = m_scalarIndices != NULL ? m_scalarIndices[n] : n;
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
 
 		int32 indexA = vc->indexA;
@@ -595,6 +626,427 @@ void b2ContactSolver::SolveVelocityConstraints()
 	}
 }
 
+#if B2_SIMD_SOLVER
+
+// 4 velocity constraints with the same number of points, in SoA layout.
+struct b2ContactBatch
+{
+	int32 constraints[4];
+	int32 indexA[4];
+	int32 indexB[4];
+	int32 pointCount;
+	float32 invMassA[4], invMassB[4];
+	float32 invIA[4], invIB[4];
+	float32 normalX[4], normalY[4];
+	float32 friction[4];
+	float32 rAX[b2_maxManifoldPoints][4], rAY[b2_maxManifoldPoints][4];
+	float32 rBX[b2_maxManifoldPoints][4], rBY[b2_maxManifoldPoints][4];
+	float32 normalImpulse[b2_maxManifoldPoints][4];
+	float32 tangentImpulse[b2_maxManifoldPoints][4];
+	float32 normalMass[b2_maxManifoldPoints][4];
+	float32 tangentMass[b2_maxManifoldPoints][4];
+	float32 velocityBias[b2_maxManifoldPoints][4];
+
+	// The block solver of the 2 points constraints.
+	float32 KExX[4], KExY[4], KEyX[4], KEyY[4];
+	float32 normalMassExX[4], normalMassExY[4], normalMassEyX[4], normalMassEyY[4];
+};
+
+// A group being filled, with the bodies its constraints move.
+struct b2OpenBatch
+{
+	int32 constraints[4];
+	int32 bodies[8];
+	int32 count;
+	int32 bodyCount;
+};
+
+static void b2FillBatch(b2ContactBatch* batch, const b2OpenBatch* group, const b2ContactVelocityConstraint* constraints)
+{
+	for (int32 k = 0; k < 4; ++k)
+	{
+		const b2ContactVelocityConstraint* vc = constraints + group->constraints[k];
+		batch->constraints[k] = group->constraints[k];
+		batch->indexA[k] = vc->indexA;
+		batch->indexB[k] = vc->indexB;
+		batch->pointCount = vc->pointCount;
+		batch->invMassA[k] = vc->invMassA;
+		batch->invMassB[k] = vc->invMassB;
+		batch->invIA[k] = vc->invIA;
+		batch->invIB[k] = vc->invIB;
+		batch->normalX[k] = vc->normal.x;
+		batch->normalY[k] = vc->normal.y;
+		batch->friction[k] = vc->friction;
+
+		for (int32 j = 0; j < vc->pointCount; ++j)
+		{
+			const b2VelocityConstraintPoint* vcp = vc->points + j;
+			batch->rAX[j][k] = vcp->rA.x;
+			batch->rAY[j][k] = vcp->rA.y;
+			batch->rBX[j][k] = vcp->rB.x;
+			batch->rBY[j][k] = vcp->rB.y;
+			batch->normalImpulse[j][k] = vcp->normalImpulse;
+			batch->tangentImpulse[j][k] = vcp->tangentImpulse;
+			batch->normalMass[j][k] = vcp->normalMass;
+			batch->tangentMass[j][k] = vcp->tangentMass;
+			batch->velocityBias[j][k] = vcp->velocityBias;
+		}
+
+		batch->KExX[k] = vc->K.ex.x;
+		batch->KExY[k] = vc->K.ex.y;
+		batch->KEyX[k] = vc->K.ey.x;
+		batch->KEyY[k] = vc->K.ey.y;
+		batch->normalMassExX[k] = vc->normalMass.ex.x;
+		batch->normalMassExY[k] = vc->normalMass.ex.y;
+		batch->normalMassEyX[k] = vc->normalMass.ey.x;
+		batch->normalMassEyY[k] = vc->normalMass.ey.y;
+	}
+}
+
+void b2ContactSolver::BuildBatches()
+{
+	// The number of groups being filled for each point count. More give more
+	// groups, but take longer to search.
+	const int32 k_openCount = 4;
+
+	m_batches = (b2ContactBatch*)m_allocator->Allocate((m_count / 4) * sizeof(b2ContactBatch));
+	m_scalarIndices = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	m_batchCount = 0;
+	m_scalarCount = 0;
+
+	bool* batched = (bool*)m_allocator->Allocate(m_count * sizeof(bool));
+	b2OpenBatch open[b2_maxManifoldPoints][k_openCount];
+	int32 openCount[b2_maxManifoldPoints] = {0};
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		batched[i] = false;
+
+		// The static and kinematic bodies aren't moved, they can be in several constraints of a group.
+		int32 moved[2];
+		int32 movedCount = 0;
+		if (vc->invMassA != 0.0f || vc->invIA != 0.0f)
+		{
+			moved[movedCount++] = vc->indexA;
+		}
+		if (vc->invMassB != 0.0f || vc->invIB != 0.0f)
+		{
+			moved[movedCount++] = vc->indexB;
+		}
+
+		// Find the first group with the same point count where the constraint fits.
+		b2OpenBatch* groups = open[vc->pointCount - 1];
+		int32& count = openCount[vc->pointCount - 1];
+		int32 g = 0;
+		for (; g < count; ++g)
+		{
+			bool fits = true;
+			for (int32 b = 0; b < groups[g].bodyCount && fits; ++b)
+			{
+				for (int32 m = 0; m < movedCount; ++m)
+				{
+					if (groups[g].bodies[b] == moved[m])
+					{
+						fits = false;
+					}
+				}
+			}
+
+			if (fits)
+			{
+				break;
+			}
+		}
+
+		if (g == count)
+		{
+			if (count == k_openCount)
+			{
+				// Solved alone.
+				continue;
+			}
+
+			groups[count].count = 0;
+			groups[count].bodyCount = 0;
+			++count;
+		}
+
+		b2OpenBatch* group = groups + g;
+		group->constraints[group->count++] = i;
+		for (int32 m = 0; m < movedCount; ++m)
+		{
+			group->bodies[group->bodyCount++] = moved[m];
+		}
+
+		if (group->count == 4)
+		{
+			b2FillBatch(m_batches + m_batchCount, group, m_velocityConstraints);
+			++m_batchCount;
+			for (int32 k = 0; k < 4; ++k)
+			{
+				batched[group->constraints[k]] = true;
+			}
+
+			// The last group being filled takes its place.
+			*group = groups[--count];
+		}
+	}
+
+	// The constraints of the groups not filled are solved alone, in their order.
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		if (batched[i] == false)
+		{
+			m_scalarIndices[m_scalarCount++] = i;
+		}
+	}
+
+	m_allocator->Free(batched);
+}
+
+// The cross products of b2Math, on 4 vectors.
+static inline __m128 b2SimdCross(__m128 ax, __m128 ay, __m128 bx, __m128 by)
+{
+	return _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+}
+
+// The relative velocity at 4 contact points, as vB + b2Cross(wB, rB) - vA - b2Cross(wA, rA).
+static inline void b2SimdRelativeVelocity(__m128 vAX, __m128 vAY, __m128 wA, __m128 vBX, __m128 vBY, __m128 wB,
+										  __m128 rAX, __m128 rAY, __m128 rBX, __m128 rBY, __m128* dvX, __m128* dvY)
+{
+	*dvX = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(vBX, _mm_mul_ps(wB, rBY)), vAX), _mm_mul_ps(wA, rAY));
+	*dvY = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(vBY, _mm_mul_ps(wB, rBX)), vAY), _mm_mul_ps(wA, rAX));
+}
+
+// Select the lanes of a where mask is set, else the ones of b.
+static inline __m128 b2SimdSelect(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Same computations as SolveVelocityConstraints, on the 4 constraints of each group.
+void b2ContactSolver::SolveBatches()
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 sign = _mm_set1_ps(-0.0f);
+
+	for (int32 i = 0; i < m_batchCount; ++i)
+	{
+		b2ContactBatch* batch = m_batches + i;
+
+		float32 gathered[6][4];
+		for (int32 k = 0; k < 4; ++k)
+		{
+			const b2Velocity& velocityA = m_velocities[batch->indexA[k]];
+			const b2Velocity& velocityB = m_velocities[batch->indexB[k]];
+			gathered[0][k] = velocityA.v.x;
+			gathered[1][k] = velocityA.v.y;
+			gathered[2][k] = velocityA.w;
+			gathered[3][k] = velocityB.v.x;
+			gathered[4][k] = velocityB.v.y;
+			gathered[5][k] = velocityB.w;
+		}
+
+		__m128 vAX = _mm_loadu_ps(gathered[0]);
+		__m128 vAY = _mm_loadu_ps(gathered[1]);
+		__m128 wA = _mm_loadu_ps(gathered[2]);
+		__m128 vBX = _mm_loadu_ps(gathered[3]);
+		__m128 vBY = _mm_loadu_ps(gathered[4]);
+		__m128 wB = _mm_loadu_ps(gathered[5]);
+
+		__m128 mA = _mm_loadu_ps(batch->invMassA);
+		__m128 iA = _mm_loadu_ps(batch->invIA);
+		__m128 mB = _mm_loadu_ps(batch->invMassB);
+		__m128 iB = _mm_loadu_ps(batch->invIB);
+
+		__m128 normalX = _mm_loadu_ps(batch->normalX);
+		__m128 normalY = _mm_loadu_ps(batch->normalY);
+		__m128 tangentX = normalY;
+		__m128 tangentY = _mm_xor_ps(normalX, sign);
+		__m128 friction = _mm_loadu_ps(batch->friction);
+
+		// Solve tangent constraints first because non-penetration is more important
+		// than friction.
+		for (int32 j = 0; j < batch->pointCount; ++j)
+		{
+			__m128 rAX = _mm_loadu_ps(batch->rAX[j]);
+			__m128 rAY = _mm_loadu_ps(batch->rAY[j]);
+			__m128 rBX = _mm_loadu_ps(batch->rBX[j]);
+			__m128 rBY = _mm_loadu_ps(batch->rBY[j]);
+
+			__m128 dvX, dvY;
+			b2SimdRelativeVelocity(vAX, vAY, wA, vBX, vBY, wB, rAX, rAY, rBX, rBY, &dvX, &dvY);
+
+			__m128 vt = _mm_add_ps(_mm_mul_ps(dvX, tangentX), _mm_mul_ps(dvY, tangentY));
+			__m128 lambda = _mm_mul_ps(_mm_loadu_ps(batch->tangentMass[j]), _mm_xor_ps(vt, sign));
+
+			__m128 oldImpulse = _mm_loadu_ps(batch->tangentImpulse[j]);
+			__m128 maxFriction = _mm_mul_ps(friction, _mm_loadu_ps(batch->normalImpulse[j]));
+			__m128 newImpulse = _mm_max_ps(_mm_xor_ps(maxFriction, sign), _mm_min_ps(_mm_add_ps(oldImpulse, lambda), maxFriction));
+			lambda = _mm_sub_ps(newImpulse, oldImpulse);
+			_mm_storeu_ps(batch->tangentImpulse[j], newImpulse);
+
+			__m128 PX = _mm_mul_ps(lambda, tangentX);
+			__m128 PY = _mm_mul_ps(lambda, tangentY);
+
+			vAX = _mm_sub_ps(vAX, _mm_mul_ps(mA, PX));
+			vAY = _mm_sub_ps(vAY, _mm_mul_ps(mA, PY));
+			wA = _mm_sub_ps(wA, _mm_mul_ps(iA, b2SimdCross(rAX, rAY, PX, PY)));
+
+			vBX = _mm_add_ps(vBX, _mm_mul_ps(mB, PX));
+			vBY = _mm_add_ps(vBY, _mm_mul_ps(mB, PY));
+			wB = _mm_add_ps(wB, _mm_mul_ps(iB, b2SimdCross(rBX, rBY, PX, PY)));
+		}
+
+		// Solve normal constraints
+		if (batch->pointCount == 1)
+		{
+			__m128 rAX = _mm_loadu_ps(batch->rAX[0]);
+			__m128 rAY = _mm_loadu_ps(batch->rAY[0]);
+			__m128 rBX = _mm_loadu_ps(batch->rBX[0]);
+			__m128 rBY = _mm_loadu_ps(batch->rBY[0]);
+
+			__m128 dvX, dvY;
+			b2SimdRelativeVelocity(vAX, vAY, wA, vBX, vBY, wB, rAX, rAY, rBX, rBY, &dvX, &dvY);
+
+			__m128 vn = _mm_add_ps(_mm_mul_ps(dvX, normalX), _mm_mul_ps(dvY, normalY));
+			__m128 lambda = _mm_mul_ps(_mm_xor_ps(_mm_loadu_ps(batch->normalMass[0]), sign),
+									   _mm_sub_ps(vn, _mm_loadu_ps(batch->velocityBias[0])));
+
+			__m128 oldImpulse = _mm_loadu_ps(batch->normalImpulse[0]);
+			__m128 newImpulse = _mm_max_ps(_mm_add_ps(oldImpulse, lambda), zero);
+			lambda = _mm_sub_ps(newImpulse, oldImpulse);
+			_mm_storeu_ps(batch->normalImpulse[0], newImpulse);
+
+			__m128 PX = _mm_mul_ps(lambda, normalX);
+			__m128 PY = _mm_mul_ps(lambda, normalY);
+
+			vAX = _mm_sub_ps(vAX, _mm_mul_ps(mA, PX));
+			vAY = _mm_sub_ps(vAY, _mm_mul_ps(mA, PY));
+			wA = _mm_sub_ps(wA, _mm_mul_ps(iA, b2SimdCross(rAX, rAY, PX, PY)));
+
+			vBX = _mm_add_ps(vBX, _mm_mul_ps(mB, PX));
+			vBY = _mm_add_ps(vBY, _mm_mul_ps(mB, PY));
+			wB = _mm_add_ps(wB, _mm_mul_ps(iB, b2SimdCross(rBX, rBY, PX, PY)));
+		}
+		else
+		{
+			// The block solver : the 4 cases are computed, and the first valid one is kept.
+			__m128 r1AX = _mm_loadu_ps(batch->rAX[0]);
+			__m128 r1AY = _mm_loadu_ps(batch->rAY[0]);
+			__m128 r1BX = _mm_loadu_ps(batch->rBX[0]);
+			__m128 r1BY = _mm_loadu_ps(batch->rBY[0]);
+			__m128 r2AX = _mm_loadu_ps(batch->rAX[1]);
+			__m128 r2AY = _mm_loadu_ps(batch->rAY[1]);
+			__m128 r2BX = _mm_loadu_ps(batch->rBX[1]);
+			__m128 r2BY = _mm_loadu_ps(batch->rBY[1]);
+
+			__m128 KExX = _mm_loadu_ps(batch->KExX);
+			__m128 KExY = _mm_loadu_ps(batch->KExY);
+			__m128 KEyX = _mm_loadu_ps(batch->KEyX);
+			__m128 KEyY = _mm_loadu_ps(batch->KEyY);
+
+			__m128 aX = _mm_loadu_ps(batch->normalImpulse[0]);
+			__m128 aY = _mm_loadu_ps(batch->normalImpulse[1]);
+
+			// Relative velocity at contact
+			__m128 dv1X, dv1Y, dv2X, dv2Y;
+			b2SimdRelativeVelocity(vAX, vAY, wA, vBX, vBY, wB, r1AX, r1AY, r1BX, r1BY, &dv1X, &dv1Y);
+			b2SimdRelativeVelocity(vAX, vAY, wA, vBX, vBY, wB, r2AX, r2AY, r2BX, r2BY, &dv2X, &dv2Y);
+
+			// Compute normal velocity
+			__m128 vn1 = _mm_add_ps(_mm_mul_ps(dv1X, normalX), _mm_mul_ps(dv1Y, normalY));
+			__m128 vn2 = _mm_add_ps(_mm_mul_ps(dv2X, normalX), _mm_mul_ps(dv2Y, normalY));
+
+			// Compute b'
+			__m128 bX = _mm_sub_ps(vn1, _mm_loadu_ps(batch->velocityBias[0]));
+			__m128 bY = _mm_sub_ps(vn2, _mm_loadu_ps(batch->velocityBias[1]));
+			bX = _mm_sub_ps(bX, _mm_add_ps(_mm_mul_ps(KExX, aX), _mm_mul_ps(KEyX, aY)));
+			bY = _mm_sub_ps(bY, _mm_add_ps(_mm_mul_ps(KExY, aX), _mm_mul_ps(KEyY, aY)));
+
+			// Case 1: vn = 0
+			__m128 x1X = _mm_xor_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(batch->normalMassExX), bX),
+											   _mm_mul_ps(_mm_loadu_ps(batch->normalMassEyX), bY)), sign);
+			__m128 x1Y = _mm_xor_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(batch->normalMassExY), bX),
+											   _mm_mul_ps(_mm_loadu_ps(batch->normalMassEyY), bY)), sign);
+			__m128 valid1 = _mm_and_ps(_mm_cmpge_ps(x1X, zero), _mm_cmpge_ps(x1Y, zero));
+
+			// Case 2: vn1 = 0 and x2 = 0
+			__m128 x2X = _mm_mul_ps(_mm_xor_ps(_mm_loadu_ps(batch->normalMass[0]), sign), bX);
+			__m128 vn2Case2 = _mm_add_ps(_mm_mul_ps(KExY, x2X), bY);
+			__m128 valid2 = _mm_and_ps(_mm_cmpge_ps(x2X, zero), _mm_cmpge_ps(vn2Case2, zero));
+
+			// Case 3: vn2 = 0 and x1 = 0
+			__m128 x3Y = _mm_mul_ps(_mm_xor_ps(_mm_loadu_ps(batch->normalMass[1]), sign), bY);
+			__m128 vn1Case3 = _mm_add_ps(_mm_mul_ps(KEyX, x3Y), bX);
+			__m128 valid3 = _mm_and_ps(_mm_cmpge_ps(x3Y, zero), _mm_cmpge_ps(vn1Case3, zero));
+
+			// Case 4: x1 = 0 and x2 = 0
+			__m128 valid4 = _mm_and_ps(_mm_cmpge_ps(bX, zero), _mm_cmpge_ps(bY, zero));
+
+			// No solution : the impulses are kept.
+			__m128 xX = b2SimdSelect(valid4, zero, aX);
+			__m128 xY = b2SimdSelect(valid4, zero, aY);
+			xX = b2SimdSelect(valid3, zero, xX);
+			xY = b2SimdSelect(valid3, x3Y, xY);
+			xX = b2SimdSelect(valid2, x2X, xX);
+			xY = b2SimdSelect(valid2, zero, xY);
+			xX = b2SimdSelect(valid1, x1X, xX);
+			xY = b2SimdSelect(valid1, x1Y, xY);
+
+			// Get the incremental impulse
+			__m128 dX = _mm_sub_ps(xX, aX);
+			__m128 dY = _mm_sub_ps(xY, aY);
+
+			// Apply incremental impulse
+			__m128 P1X = _mm_mul_ps(dX, normalX);
+			__m128 P1Y = _mm_mul_ps(dX, normalY);
+			__m128 P2X = _mm_mul_ps(dY, normalX);
+			__m128 P2Y = _mm_mul_ps(dY, normalY);
+
+			vAX = _mm_sub_ps(vAX, _mm_mul_ps(mA, _mm_add_ps(P1X, P2X)));
+			vAY = _mm_sub_ps(vAY, _mm_mul_ps(mA, _mm_add_ps(P1Y, P2Y)));
+			wA = _mm_sub_ps(wA, _mm_mul_ps(iA, _mm_add_ps(b2SimdCross(r1AX, r1AY, P1X, P1Y), b2SimdCross(r2AX, r2AY, P2X, P2Y))));
+
+			vBX = _mm_add_ps(vBX, _mm_mul_ps(mB, _mm_add_ps(P1X, P2X)));
+			vBY = _mm_add_ps(vBY, _mm_mul_ps(mB, _mm_add_ps(P1Y, P2Y)));
+			wB = _mm_add_ps(wB, _mm_mul_ps(iB, _mm_add_ps(b2SimdCross(r1BX, r1BY, P1X, P1Y), b2SimdCross(r2BX, r2BY, P2X, P2Y))));
+
+			// Accumulate
+			_mm_storeu_ps(batch->normalImpulse[0], xX);
+			_mm_storeu_ps(batch->normalImpulse[1], xY);
+		}
+
+		_mm_storeu_ps(gathered[0], vAX);
+		_mm_storeu_ps(gathered[1], vAY);
+		_mm_storeu_ps(gathered[2], wA);
+		_mm_storeu_ps(gathered[3], vBX);
+		_mm_storeu_ps(gathered[4], vBY);
+		_mm_storeu_ps(gathered[5], wB);
+
+		for (int32 k = 0; k < 4; ++k)
+		{
+			b2Velocity& velocityA = m_velocities[batch->indexA[k]];
+			b2Velocity& velocityB = m_velocities[batch->indexB[k]];
+			velocityA.v.Set(gathered[0][k], gathered[1][k]);
+			velocityA.w = gathered[2][k];
+			velocityB.v.Set(gathered[3][k], gathered[4][k]);
+			velocityB.w = gathered[5][k];
+
+			// The impulses are needed by StoreImpulses and the contact listener.
+			b2ContactVelocityConstraint* vc = m_velocityConstraints + batch->constraints[k];
+			for (int32 j = 0; j < batch->pointCount; ++j)
+			{
+				vc->points[j].normalImpulse = batch->normalImpulse[j][k];
+				vc->points[j].tangentImpulse = batch->tangentImpulse[j][k];
+			}
+		}
+	}
+}
+
+#endif
+
 void b2ContactSolver::StoreImpulses()
 {
 	for (int32 i = 0; i < m_count; ++i)
@@ -27,6 +27,14 @@ class b2Contact;
 class b2Body;
 class b2StackAllocator;
 struct b2ContactPositionConstraint;
+struct b2ContactBatch;
+
+// The velocity constraints can be solved by groups of 4 with SSE2.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B2_SIMD_SOLVER 1
+#else
+#define B2_SIMD_SOLVER 0
+#endif
 
 struct b2VelocityConstraintPoint
 {
@@ -80,6 +88,11 @@ public:
 	bool SolvePositionConstraints();
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
+	// Group the velocity constraints by 4, without two constraints of a group moving
+	// the same body, so the ones of a group can be solved at once.
+	void BuildBatches();
+	void SolveBatches();
+
 	b2TimeStep m_step;
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
@@ -88,6 +101,13 @@ public:
 	b2ContactVelocityConstraint* m_velocityConstraints;
 	b2Contact** m_contacts;
 	int m_count;
+
+	// The groups of 4 velocity constraints, and the other ones, solved one at a time.
+	// m_scalarIndices is NULL if the constraints aren't grouped.
+	b2ContactBatch* m_batches;
+	int32 m_batchCount;
+	int32* m_scalarIndices;
+	int32 m_scalarCount;
 };
 
 #endif
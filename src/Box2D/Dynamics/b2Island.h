@@ -34,8 +34,10 @@ struct b2Profile;
 class b2Island
 {
 public:
+	/// The body states are indexed by the island index of the bodies : stateCapacity
+	/// is their number if it isn't bodyCapacity.
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
-			b2StackAllocator* allocator, b2ContactListener* listener);
+			b2StackAllocator* allocator, b2ContactListener* listener, int32 stateCapacity = 0);
 	~b2Island();
 
 	void Clear()
@@ -88,6 +90,9 @@ public:
 	int32 m_bodyCapacity;
 	int32 m_contactCapacity;
 	int32 m_jointCapacity;
+
+	// The static bodies are shared with islands solved at the same time : they are only read.
+	bool m_sharedStatics;
 };
 
 #endif
@@ -43,6 +43,7 @@ struct b2TimeStep
 	int32 velocityIterations;
 	int32 positionIterations;
 	bool warmStarting;
+	bool simdSolver;	// solve the contacts by groups of 4 if possible
 };
 
 /// This is an internal structure.
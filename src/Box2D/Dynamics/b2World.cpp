@@ -20,7 +20,16 @@
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2Island.h>
+#include <Box2D/Dynamics/Joints/b2DistanceJoint.h>
+#include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
+#include <Box2D/Dynamics/Joints/b2GearJoint.h>
+#include <Box2D/Dynamics/Joints/b2MouseJoint.h>
+#include <Box2D/Dynamics/Joints/b2PrismaticJoint.h>
 #include <Box2D/Dynamics/Joints/b2PulleyJoint.h>
+#include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
+#include <Box2D/Dynamics/Joints/b2RopeJoint.h>
+#include <Box2D/Dynamics/Joints/b2WeldJoint.h>
+#include <Box2D/Dynamics/Joints/b2WheelJoint.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 #include <Box2D/Collision/b2Collision.h>
@@ -32,6 +41,8 @@
 #include <Box2D/Collision/b2TimeOfImpact.h>
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2ThreadPool.h>
+#include <atomic>
 #include <new>
 
 b2World::b2World(const b2Vec2& gravity)
@@ -46,6 +57,7 @@ b2World::b2World(const b2Vec2& gravity)
 	m_jointCount = 0;
 
 	m_warmStarting = true;
+	m_simdSolver = false;
 	m_continuousPhysics = true;
 	m_subStepping = false;
 
@@ -61,10 +73,16 @@ b2World::b2World(const b2Vec2& gravity)
 	m_contactManager.m_allocator = &m_blockAllocator;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
+	m_toiCount = 0;
+
+	m_threadPool = NULL;
+	m_workerAllocators = NULL;
 }
 
 b2World::~b2World()
 {
+	SetSolverThreads(1);
+
 	// Some shapes allocate using b2Alloc.
 	b2Body* b = m_bodyList;
 	while (b)
@@ -365,6 +383,35 @@ void b2World::DestroyJoint(b2Joint* j)
 }
 
 //
+void b2World::SetSolverThreads(int32 count)
+{
+	b2Assert(IsLocked() == false);
+	if (count < 1)
+	{
+		count = 1;
+	}
+	if (count == GetSolverThreads())
+	{
+		return;
+	}
+
+	delete m_threadPool;
+	delete [] m_workerAllocators;
+	m_threadPool = NULL;
+	m_workerAllocators = NULL;
+
+	if (count > 1)
+	{
+		m_threadPool = new b2ThreadPool(count);
+		m_workerAllocators = new b2StackAllocator[count];
+	}
+}
+
+int32 b2World::GetSolverThreads() const
+{
+	return m_threadPool != NULL ? m_threadPool->GetWorkerCount() : 1;
+}
+
 void b2World::SetAllowSleeping(bool flag)
 {
 	if (flag == m_allowSleep)
@@ -389,6 +436,12 @@ void b2World::Solve(const b2TimeStep& step)
 	m_profile.solveVelocity = 0.0f;
 	m_profile.solvePosition = 0.0f;
 
+	if (m_threadPool != NULL)
+	{
+		SolveParallel(step);
+		return;
+	}
+
 	// Size the island for the worst case.
 	b2Island island(m_bodyCount,
 					m_contactManager.m_contactCount,
@@ -547,6 +600,308 @@ void b2World::Solve(const b2TimeStep& step)
 
 	m_stackAllocator.Free(stack);
 
+	SynchronizeSolved();
+}
+
+// The islands built by SolveParallel, as ranges in shared arrays.
+struct b2IslandRange
+{
+	int32 bodyStart, bodyCount, dynamicCount;
+	int32 contactStart, contactCount;
+	int32 jointStart, jointCount;
+};
+
+struct b2IslandTask
+{
+	const b2IslandRange* islands;
+	int32 islandCount;
+	b2Body** bodies;
+	b2Contact** contacts;
+	b2Joint** joints;
+	int32 staticCount;
+
+	b2TimeStep step;
+	b2Vec2 gravity;
+	bool allowSleep;
+	b2ContactListener* listener;
+
+	b2StackAllocator* allocators;
+	b2Profile* profiles;
+	std::atomic<int32> next;
+};
+
+// Solve the islands not taken yet by another worker.
+static void b2SolveIslands(void* context, int32 worker)
+{
+	b2IslandTask* task = (b2IslandTask*)context;
+	b2StackAllocator* allocator = task->allocators + worker;
+	b2Profile* total = task->profiles + worker;
+
+	for (;;)
+	{
+		int32 i = task->next.fetch_add(1);
+		if (i >= task->islandCount)
+		{
+			break;
+		}
+
+		// The states of the static bodies come first, so they have the same index in all islands.
+		const b2IslandRange& range = task->islands[i];
+		b2Island island(range.bodyCount, range.contactCount, range.jointCount,
+						allocator, task->listener, task->staticCount + range.dynamicCount);
+		island.m_sharedStatics = true;
+		memcpy(island.m_bodies, task->bodies + range.bodyStart, range.bodyCount * sizeof(b2Body*));
+		memcpy(island.m_contacts, task->contacts + range.contactStart, range.contactCount * sizeof(b2Contact*));
+		memcpy(island.m_joints, task->joints + range.jointStart, range.jointCount * sizeof(b2Joint*));
+		island.m_bodyCount = range.bodyCount;
+		island.m_contactCount = range.contactCount;
+		island.m_jointCount = range.jointCount;
+
+		b2Profile profile;
+		island.Solve(&profile, task->step, task->gravity, task->allowSleep);
+		total->solveInit += profile.solveInit;
+		total->solveVelocity += profile.solveVelocity;
+		total->solvePosition += profile.solvePosition;
+	}
+}
+
+void b2World::SolveParallel(const b2TimeStep& step)
+{
+	// Clear all the island flags.
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_flags &= ~b2Body::e_islandFlag;
+		b->m_islandIndex = -1;
+	}
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		c->m_flags &= ~b2Contact::e_islandFlag;
+	}
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->m_islandFlag = false;
+	}
+
+	// A static body can be in several islands, once for each contact or joint at most.
+	int32 bodyCapacity = m_bodyCount + m_contactManager.m_contactCount + m_jointCount;
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(bodyCapacity * sizeof(b2Body*));
+	b2Contact** contacts = (b2Contact**)m_stackAllocator.Allocate(m_contactManager.m_contactCount * sizeof(b2Contact*));
+	b2Joint** joints = (b2Joint**)m_stackAllocator.Allocate(m_jointCount * sizeof(b2Joint*));
+	b2IslandRange* islands = (b2IslandRange*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2IslandRange));
+	int32 bodyCount = 0;
+	int32 contactCount = 0;
+	int32 jointCount = 0;
+	int32 islandCount = 0;
+	int32 staticCount = 0;
+
+	// Build all awake islands, the same way as Solve.
+	int32 stackSize = m_bodyCount;
+	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	{
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		if (seed->IsAwake() == false || seed->IsActive() == false)
+		{
+			continue;
+		}
+
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2IslandRange* range = islands + islandCount++;
+		range->bodyStart = bodyCount;
+		range->dynamicCount = 0;
+		range->contactStart = contactCount;
+		range->jointStart = jointCount;
+
+		int32 stackCount = 0;
+		stack[stackCount++] = seed;
+		seed->m_flags |= b2Body::e_islandFlag;
+
+		// Perform a depth first search (DFS) on the constraint graph.
+		while (stackCount > 0)
+		{
+			// Grab the next body off the stack and add it to the island.
+			b2Body* b = stack[--stackCount];
+			b2Assert(b->IsActive() == true);
+			b2Assert(bodyCount < bodyCapacity);
+			bodies[bodyCount++] = b;
+
+			// Make sure the body is awake.
+			b->SetAwake(true);
+
+			// To keep islands as small as possible, we don't
+			// propagate islands across static bodies.
+			if (b->GetType() == b2_staticBody)
+			{
+				if (b->m_islandIndex == -1)
+				{
+					b->m_islandIndex = staticCount++;
+				}
+				continue;
+			}
+			b->m_islandIndex = range->dynamicCount++;
+
+			// Search all contacts connected to this body.
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+			{
+				b2Contact* contact = ce->contact;
+
+				// Has this contact already been added to an island?
+				if (contact->m_flags & b2Contact::e_islandFlag)
+				{
+					continue;
+				}
+
+				// Is this contact solid and touching?
+				if (contact->IsEnabled() == false ||
+					contact->IsTouching() == false)
+				{
+					continue;
+				}
+
+				// Skip sensors.
+				bool sensorA = contact->m_fixtureA->m_isSensor;
+				bool sensorB = contact->m_fixtureB->m_isSensor;
+				if (sensorA || sensorB)
+				{
+					continue;
+				}
+
+				contacts[contactCount++] = contact;
+				contact->m_flags |= b2Contact::e_islandFlag;
+
+				b2Body* other = ce->other;
+
+				// Was the other body already added to this island?
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < stackSize);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+
+			// Search all joints connect to this body.
+			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			{
+				if (je->joint->m_islandFlag == true)
+				{
+					continue;
+				}
+
+				b2Body* other = je->other;
+
+				// Don't simulate joints connected to inactive bodies.
+				if (other->IsActive() == false)
+				{
+					continue;
+				}
+
+				joints[jointCount++] = je->joint;
+				je->joint->m_islandFlag = true;
+
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < stackSize);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+		}
+
+		range->bodyCount = bodyCount - range->bodyStart;
+		range->contactCount = contactCount - range->contactStart;
+		range->jointCount = jointCount - range->jointStart;
+
+		// Allow static bodies to participate in other islands.
+		for (int32 i = range->bodyStart; i < bodyCount; ++i)
+		{
+			b2Body* b = bodies[i];
+			if (b->GetType() == b2_staticBody)
+			{
+				b->m_flags &= ~b2Body::e_islandFlag;
+			}
+		}
+	}
+
+	m_stackAllocator.Free(stack);
+
+	// The states of the other bodies follow the ones of the static bodies.
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		if (bodies[i]->GetType() != b2_staticBody)
+		{
+			bodies[i]->m_islandIndex += staticCount;
+		}
+	}
+
+	// Solve the islands.
+	int32 workerCount = m_threadPool->GetWorkerCount();
+	b2Profile* profiles = (b2Profile*)m_stackAllocator.Allocate(workerCount * sizeof(b2Profile));
+	memset(profiles, 0, workerCount * sizeof(b2Profile));
+
+	b2IslandTask task;
+	task.islands = islands;
+	task.islandCount = islandCount;
+	task.bodies = bodies;
+	task.contacts = contacts;
+	task.joints = joints;
+	task.staticCount = staticCount;
+	task.step = step;
+	task.gravity = m_gravity;
+	task.allowSleep = m_allowSleep;
+	task.listener = m_contactManager.m_contactListener;
+	task.allocators = m_workerAllocators;
+	task.profiles = profiles;
+	task.next = 0;
+	m_threadPool->Run(b2SolveIslands, &task);
+
+	// The islands don't put their static bodies to sleep, as they share them. Like when the islands are solved one
+	// after the other, a static body is left asleep if the last island it is in fell asleep, else awake.
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange& range = islands[i];
+		// The seed comes first, and falls asleep with its island.
+		bool awake = bodies[range.bodyStart]->IsAwake();
+		for (int32 j = range.bodyStart; j < range.bodyStart + range.bodyCount; ++j)
+		{
+			if (bodies[j]->GetType() == b2_staticBody)
+			{
+				bodies[j]->SetAwake(awake);
+			}
+		}
+	}
+
+	for (int32 i = 0; i < workerCount; ++i)
+	{
+		m_profile.solveInit += profiles[i].solveInit;
+		m_profile.solveVelocity += profiles[i].solveVelocity;
+		m_profile.solvePosition += profiles[i].solvePosition;
+	}
+
+	m_stackAllocator.Free(profiles);
+	m_stackAllocator.Free(islands);
+	m_stackAllocator.Free(joints);
+	m_stackAllocator.Free(contacts);
+	m_stackAllocator.Free(bodies);
+
+	SynchronizeSolved();
+}
+
+void b2World::SynchronizeSolved()
+{
 	{
 		b2Timer timer;
 		// Synchronize fixtures, check for out of range bodies.
@@ -719,6 +1074,8 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			break;
 		}
 
+		++m_toiCount;
+
 		// Advance the bodies to the TOI.
 		b2Fixture* fA = minContact->GetFixtureA();
 		b2Fixture* fB = minContact->GetFixtureB();
@@ -860,6 +1217,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		subStep.positionIterations = 20;
 		subStep.velocityIterations = step.velocityIterations;
 		subStep.warmStarting = false;
+		subStep.simdSolver = step.simdSolver;
 		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
 
 		// Reset island flags and synchronize broad-phase proxies.
@@ -897,6 +1255,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIterations)
 {
 	b2Timer stepTimer;
+	m_toiCount = 0;
 
 	// If new fixtures were added, we need to find the new contacts.
 	if (m_flags & e_newFixture)
@@ -923,6 +1282,7 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+	step.simdSolver = m_simdSolver;
 	
 	// Update contacts. This is where some contacts are destroyed.
 	{
@@ -1314,3 +1674,561 @@ void b2World::Dump()
 	b2Log("joints = NULL;\n");
 	b2Log("bodies = NULL;\n");
 }
+
+// Sequential writing of a state, only counting the bytes if data is NULL.
+struct b2StateWriter
+{
+	char* data;
+	int32 size;
+
+	void Write(const void* value, int32 count)
+	{
+		if (data != NULL)
+		{
+			memcpy(data + size, value, count);
+		}
+		size += count;
+	}
+};
+
+// Sequential reading of a state, failing at the end of the buffer.
+struct b2StateReader
+{
+	const char* data;
+	int32 size;
+	int32 position;
+
+	bool Read(void* value, int32 count)
+	{
+		if (count < 0 || count > size - position)
+		{
+			return false;
+		}
+		memcpy(value, data + position, count);
+		position += count;
+		return true;
+	}
+
+	bool Skip(int32 count)
+	{
+		if (count < 0 || count > size - position)
+		{
+			return false;
+		}
+		position += count;
+		return true;
+	}
+};
+
+// The saved motion of a body, followed by its fixture proxies.
+struct b2BodyState
+{
+	int32 flags;
+	int32 fixtureCount;
+	b2Transform xf;
+	b2Sweep sweep;
+	b2Vec2 linearVelocity;
+	float32 angularVelocity;
+	b2Vec2 force;
+	float32 torque;
+	float32 sleepTime;
+};
+
+// A saved contact, its fixtures being found by the index of their body and their index in it.
+struct b2ContactState
+{
+	int32 bodyA, fixtureA, childA;
+	int32 bodyB, fixtureB, childB;
+	uint32 flags;
+	b2Manifold manifold;
+	int32 toiCount;
+	float32 toi;
+	float32 friction;
+	float32 restitution;
+};
+
+// The size of the state of a joint : the part after b2Joint, which only holds
+// numbers and pointers which don't change, is saved as is.
+static int32 b2GetJointStateSize(b2JointType type)
+{
+	switch (type)
+	{
+	case e_revoluteJoint:
+		return sizeof(b2RevoluteJoint) - sizeof(b2Joint);
+	case e_prismaticJoint:
+		return sizeof(b2PrismaticJoint) - sizeof(b2Joint);
+	case e_distanceJoint:
+		return sizeof(b2DistanceJoint) - sizeof(b2Joint);
+	case e_pulleyJoint:
+		return sizeof(b2PulleyJoint) - sizeof(b2Joint);
+	case e_mouseJoint:
+		return sizeof(b2MouseJoint) - sizeof(b2Joint);
+	case e_gearJoint:
+		return sizeof(b2GearJoint) - sizeof(b2Joint);
+	case e_wheelJoint:
+		return sizeof(b2WheelJoint) - sizeof(b2Joint);
+	case e_weldJoint:
+		return sizeof(b2WeldJoint) - sizeof(b2Joint);
+	case e_frictionJoint:
+		return sizeof(b2FrictionJoint) - sizeof(b2Joint);
+	case e_ropeJoint:
+		return sizeof(b2RopeJoint) - sizeof(b2Joint);
+	default:
+		return 0;
+	}
+}
+
+static int32 b2GetFixtureIndex(const b2Fixture* fixture)
+{
+	int32 index = 0;
+	for (const b2Fixture* f = fixture->GetBody()->GetFixtureList(); f != fixture; f = f->GetNext())
+	{
+		++index;
+	}
+	return index;
+}
+
+static b2Fixture* b2GetFixture(b2Body* body, int32 index)
+{
+	b2Fixture* fixture = body->GetFixtureList();
+	for (int32 i = 0; i < index; ++i)
+	{
+		fixture = fixture->GetNext();
+	}
+	return fixture;
+}
+
+void b2World::WriteState(b2StateWriter* writer) const
+{
+	b2Assert(IsLocked() == false);
+
+	int32 header[3] = {m_bodyCount, m_jointCount, m_contactManager.m_contactCount};
+	writer->Write(header, sizeof(header));
+	int32 newFixture = m_flags & e_newFixture;
+	writer->Write(&newFixture, sizeof(int32));
+	writer->Write(&m_inv_dt0, sizeof(float32));
+	writer->Write(&m_stepComplete, sizeof(bool));
+
+	// The broad-phase and its tree, whose structure gives the order new contacts are found in.
+	// The user data of the nodes are pointers, found again from the fixtures.
+	const b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+	writer->Write(&broadPhase->m_proxyCount, sizeof(int32));
+	writer->Write(&broadPhase->m_moveCount, sizeof(int32));
+	writer->Write(broadPhase->m_moveBuffer, broadPhase->m_moveCount * sizeof(int32));
+
+	const b2DynamicTree* tree = &broadPhase->m_tree;
+	writer->Write(&tree->m_root, sizeof(int32));
+	writer->Write(&tree->m_nodeCount, sizeof(int32));
+	writer->Write(&tree->m_nodeCapacity, sizeof(int32));
+	writer->Write(&tree->m_freeList, sizeof(int32));
+	writer->Write(&tree->m_path, sizeof(uint32));
+	writer->Write(&tree->m_insertionCount, sizeof(int32));
+	for (int32 i = 0; i < tree->m_nodeCapacity; ++i)
+	{
+		const b2TreeNode* node = tree->m_nodes + i;
+		writer->Write(&node->height, sizeof(int32));
+		writer->Write(&node->parent, sizeof(int32));
+		if (node->height != -1)
+		{
+			writer->Write(&node->aabb, sizeof(b2AABB));
+			writer->Write(&node->child1, sizeof(int32));
+			writer->Write(&node->child2, sizeof(int32));
+		}
+	}
+
+	int32 index = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		// The index is used to save the bodies of the contacts.
+		b->m_islandIndex = index++;
+
+		b2BodyState state;
+		state.flags = b->m_flags;
+		state.fixtureCount = b->m_fixtureCount;
+		state.xf = b->m_xf;
+		state.sweep = b->m_sweep;
+		state.linearVelocity = b->m_linearVelocity;
+		state.angularVelocity = b->m_angularVelocity;
+		state.force = b->m_force;
+		state.torque = b->m_torque;
+		state.sleepTime = b->m_sleepTime;
+		writer->Write(&state, sizeof(b2BodyState));
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			writer->Write(&f->m_proxyCount, sizeof(int32));
+			for (int32 i = 0; i < f->m_proxyCount; ++i)
+			{
+				writer->Write(&f->m_proxies[i].aabb, sizeof(b2AABB));
+				writer->Write(&f->m_proxies[i].proxyId, sizeof(int32));
+			}
+		}
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		int32 type = j->m_type;
+		writer->Write(&type, sizeof(int32));
+		writer->Write((const char*)j + sizeof(b2Joint), b2GetJointStateSize(j->m_type));
+	}
+
+	// In the order of the list, which is also the order in the lists of the bodies.
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		b2ContactState state;
+		state.bodyA = c->m_fixtureA->m_body->m_islandIndex;
+		state.fixtureA = b2GetFixtureIndex(c->m_fixtureA);
+		state.childA = c->m_indexA;
+		state.bodyB = c->m_fixtureB->m_body->m_islandIndex;
+		state.fixtureB = b2GetFixtureIndex(c->m_fixtureB);
+		state.childB = c->m_indexB;
+		state.flags = c->m_flags;
+		state.manifold = c->m_manifold;
+		state.toiCount = c->m_toiCount;
+		state.toi = c->m_toi;
+		state.friction = c->m_friction;
+		state.restitution = c->m_restitution;
+		writer->Write(&state, sizeof(b2ContactState));
+	}
+}
+
+int32 b2World::GetStateSize() const
+{
+	b2StateWriter writer = {NULL, 0};
+	WriteState(&writer);
+	return writer.size;
+}
+
+void b2World::SaveState(void* buffer) const
+{
+	b2StateWriter writer = {(char*)buffer, 0};
+	WriteState(&writer);
+}
+
+bool b2World::CheckState(const void* buffer, int32 size, b2Body** bodies) const
+{
+	b2StateReader reader = {(const char*)buffer, size, 0};
+
+	int32 header[3];
+	if (reader.Read(header, sizeof(header)) == false
+		|| header[0] != m_bodyCount || header[1] != m_jointCount || header[2] < 0)
+	{
+		return false;
+	}
+	int32 contactCount = header[2];
+	if (reader.Skip(sizeof(int32) + sizeof(float32) + sizeof(bool)) == false)
+	{
+		return false;
+	}
+
+	int32 proxyCount, moveCount;
+	if (reader.Read(&proxyCount, sizeof(int32)) == false
+		|| reader.Read(&moveCount, sizeof(int32)) == false
+		|| reader.Skip(moveCount * sizeof(int32)) == false)
+	{
+		return false;
+	}
+
+	int32 treeHeader[4];
+	if (reader.Read(treeHeader, sizeof(treeHeader)) == false
+		|| reader.Skip(sizeof(uint32) + sizeof(int32)) == false)
+	{
+		return false;
+	}
+	int32 nodeCapacity = treeHeader[2];
+	for (int32 i = 0; i < nodeCapacity; ++i)
+	{
+		int32 height;
+		if (reader.Read(&height, sizeof(int32)) == false
+			|| reader.Skip(height != -1 ? sizeof(int32) + sizeof(b2AABB) + 2 * sizeof(int32) : sizeof(int32)) == false)
+		{
+			return false;
+		}
+	}
+
+	int32 index = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		bodies[index++] = b;
+
+		b2BodyState state;
+		if (reader.Read(&state, sizeof(b2BodyState)) == false || state.fixtureCount != b->m_fixtureCount)
+		{
+			return false;
+		}
+
+		// The proxies exist if the body is active.
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			int32 count;
+			int32 expected = (state.flags & b2Body::e_activeFlag) ? f->m_shape->GetChildCount() : 0;
+			if (reader.Read(&count, sizeof(int32)) == false || count != expected)
+			{
+				return false;
+			}
+
+			for (int32 i = 0; i < count; ++i)
+			{
+				int32 proxyId;
+				if (reader.Skip(sizeof(b2AABB)) == false || reader.Read(&proxyId, sizeof(int32)) == false
+					|| proxyId < 0 || proxyId >= nodeCapacity)
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		int32 type;
+		if (reader.Read(&type, sizeof(int32)) == false || type != j->m_type
+			|| reader.Skip(b2GetJointStateSize(j->m_type)) == false)
+		{
+			return false;
+		}
+	}
+
+	for (int32 i = 0; i < contactCount; ++i)
+	{
+		b2ContactState state;
+		if (reader.Read(&state, sizeof(b2ContactState)) == false
+			|| state.bodyA < 0 || state.bodyA >= m_bodyCount || state.bodyB < 0 || state.bodyB >= m_bodyCount
+			|| state.fixtureA < 0 || state.fixtureA >= bodies[state.bodyA]->m_fixtureCount
+			|| state.fixtureB < 0 || state.fixtureB >= bodies[state.bodyB]->m_fixtureCount)
+		{
+			return false;
+		}
+	}
+
+	return reader.position == size;
+}
+
+bool b2World::RestoreState(const void* buffer, int32 size)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return false;
+	}
+
+	// Nothing is changed if the state doesn't match.
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2Body*));
+	if (CheckState(buffer, size, bodies) == false)
+	{
+		m_stackAllocator.Free(bodies);
+		return false;
+	}
+
+	b2StateReader reader = {(const char*)buffer, size, 0};
+	int32 header[3];
+	reader.Read(header, sizeof(header));
+	int32 contactCount = header[2];
+
+	int32 newFixture = 0;
+	reader.Read(&newFixture, sizeof(int32));
+	reader.Read(&m_inv_dt0, sizeof(float32));
+	reader.Read(&m_stepComplete, sizeof(bool));
+	m_flags = (m_flags & ~e_newFixture) | (newFixture & e_newFixture);
+
+	// The contacts are all destroyed, and created again from the state, without calling the listener.
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+	m_contactManager.m_contactListener = NULL;
+	b2Contact* c = m_contactManager.m_contactList;
+	while (c)
+	{
+		b2Contact* next = c->m_next;
+		m_contactManager.Destroy(c);
+		c = next;
+	}
+
+	// Changing the activity of the bodies creates and destroys proxies, so the broad-phase
+	// is restored once the bodies are.
+	int32 broadPhasePosition = reader.position;
+	int32 moveCount = 0;
+	reader.Skip(sizeof(int32));
+	reader.Read(&moveCount, sizeof(int32));
+	reader.Skip(moveCount * sizeof(int32));
+	int32 treeHeader[4];
+	reader.Read(treeHeader, sizeof(treeHeader));
+	reader.Skip(sizeof(uint32) + sizeof(int32));
+	for (int32 i = 0; i < treeHeader[2]; ++i)
+	{
+		int32 height;
+		reader.Read(&height, sizeof(int32));
+		reader.Skip(height != -1 ? sizeof(int32) + sizeof(b2AABB) + 2 * sizeof(int32) : sizeof(int32));
+	}
+
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = bodies[i];
+		b2BodyState state;
+		reader.Read(&state, sizeof(b2BodyState));
+
+		bool active = (state.flags & b2Body::e_activeFlag) != 0;
+		if (active != b->IsActive())
+		{
+			b->SetActive(active);
+		}
+
+		b->m_flags = (uint16)state.flags;
+		b->m_xf = state.xf;
+		b->m_sweep = state.sweep;
+		b->m_linearVelocity = state.linearVelocity;
+		b->m_angularVelocity = state.angularVelocity;
+		b->m_force = state.force;
+		b->m_torque = state.torque;
+		b->m_sleepTime = state.sleepTime;
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			reader.Skip(sizeof(int32));
+			for (int32 j = 0; j < f->m_proxyCount; ++j)
+			{
+				reader.Read(&f->m_proxies[j].aabb, sizeof(b2AABB));
+				reader.Read(&f->m_proxies[j].proxyId, sizeof(int32));
+			}
+		}
+	}
+	int32 jointsPosition = reader.position;
+
+	b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+	reader.position = broadPhasePosition;
+	reader.Read(&broadPhase->m_proxyCount, sizeof(int32));
+	reader.Read(&broadPhase->m_moveCount, sizeof(int32));
+	if (broadPhase->m_moveCount > broadPhase->m_moveCapacity)
+	{
+		b2Free(broadPhase->m_moveBuffer);
+		broadPhase->m_moveCapacity = broadPhase->m_moveCount;
+		broadPhase->m_moveBuffer = (int32*)b2Alloc(broadPhase->m_moveCapacity * sizeof(int32));
+	}
+	reader.Read(broadPhase->m_moveBuffer, broadPhase->m_moveCount * sizeof(int32));
+
+	b2DynamicTree* tree = &broadPhase->m_tree;
+	reader.Read(&tree->m_root, sizeof(int32));
+	reader.Read(&tree->m_nodeCount, sizeof(int32));
+	int32 nodeCapacity = 0;
+	reader.Read(&nodeCapacity, sizeof(int32));
+	if (nodeCapacity > tree->m_nodeCapacity)
+	{
+		b2Free(tree->m_nodes);
+		tree->m_nodes = (b2TreeNode*)b2Alloc(nodeCapacity * sizeof(b2TreeNode));
+		tree->m_nodeCapacity = nodeCapacity;
+	}
+	reader.Read(&tree->m_freeList, sizeof(int32));
+	reader.Read(&tree->m_path, sizeof(uint32));
+	reader.Read(&tree->m_insertionCount, sizeof(int32));
+	for (int32 i = 0; i < nodeCapacity; ++i)
+	{
+		b2TreeNode* node = tree->m_nodes + i;
+		reader.Read(&node->height, sizeof(int32));
+		reader.Read(&node->parent, sizeof(int32));
+		node->userData = NULL;
+		if (node->height != -1)
+		{
+			reader.Read(&node->aabb, sizeof(b2AABB));
+			reader.Read(&node->child1, sizeof(int32));
+			reader.Read(&node->child2, sizeof(int32));
+		}
+	}
+	// The nodes allocated beyond the stored ones are free : they end the free list, in the order
+	// the tree would have used them by growing, so the next proxies get the same nodes.
+	if (tree->m_nodeCapacity > nodeCapacity)
+	{
+		for (int32 i = nodeCapacity; i < tree->m_nodeCapacity; ++i)
+		{
+			tree->m_nodes[i].next = i + 1 < tree->m_nodeCapacity ? i + 1 : b2_nullNode;
+			tree->m_nodes[i].height = -1;
+			tree->m_nodes[i].userData = NULL;
+		}
+		if (tree->m_freeList == b2_nullNode)
+		{
+			tree->m_freeList = nodeCapacity;
+		}
+		else
+		{
+			int32 last = tree->m_freeList;
+			while (tree->m_nodes[last].next != b2_nullNode)
+			{
+				last = tree->m_nodes[last].next;
+			}
+			tree->m_nodes[last].next = nodeCapacity;
+		}
+	}
+
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		for (b2Fixture* f = bodies[i]->m_fixtureList; f; f = f->m_next)
+		{
+			for (int32 j = 0; j < f->m_proxyCount; ++j)
+			{
+				tree->m_nodes[f->m_proxies[j].proxyId].userData = f->m_proxies + j;
+			}
+		}
+	}
+
+	reader.position = jointsPosition;
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		reader.Skip(sizeof(int32));
+		reader.Read((char*)j + sizeof(b2Joint), b2GetJointStateSize(j->m_type));
+	}
+
+	// The contacts are added at the head of the lists, so they are created from the last one.
+	int32 contactsPosition = reader.position;
+	for (int32 i = contactCount - 1; i >= 0; --i)
+	{
+		b2ContactState state;
+		reader.position = contactsPosition + i * sizeof(b2ContactState);
+		reader.Read(&state, sizeof(b2ContactState));
+
+		b2Fixture* fixtureA = b2GetFixture(bodies[state.bodyA], state.fixtureA);
+		b2Fixture* fixtureB = b2GetFixture(bodies[state.bodyB], state.fixtureB);
+		b2Body* bodyA = fixtureA->m_body;
+		b2Body* bodyB = fixtureB->m_body;
+		c = b2Contact::Create(fixtureA, state.childA, fixtureB, state.childB, &m_blockAllocator);
+		b2Assert(c->m_fixtureA == fixtureA);
+
+		c->m_flags = state.flags;
+		c->m_manifold = state.manifold;
+		c->m_toiCount = state.toiCount;
+		c->m_toi = state.toi;
+		c->m_friction = state.friction;
+		c->m_restitution = state.restitution;
+
+		// Insert into the world and the bodies, as b2ContactManager::AddPair.
+		c->m_prev = NULL;
+		c->m_next = m_contactManager.m_contactList;
+		if (m_contactManager.m_contactList != NULL)
+		{
+			m_contactManager.m_contactList->m_prev = c;
+		}
+		m_contactManager.m_contactList = c;
+
+		c->m_nodeA.contact = c;
+		c->m_nodeA.other = bodyB;
+		c->m_nodeA.prev = NULL;
+		c->m_nodeA.next = bodyA->m_contactList;
+		if (bodyA->m_contactList != NULL)
+		{
+			bodyA->m_contactList->prev = &c->m_nodeA;
+		}
+		bodyA->m_contactList = &c->m_nodeA;
+
+		c->m_nodeB.contact = c;
+		c->m_nodeB.other = bodyA;
+		c->m_nodeB.prev = NULL;
+		c->m_nodeB.next = bodyB->m_contactList;
+		if (bodyB->m_contactList != NULL)
+		{
+			bodyB->m_contactList->prev = &c->m_nodeB;
+		}
+		bodyB->m_contactList = &c->m_nodeB;
+
+		++m_contactManager.m_contactCount;
+	}
+
+	m_contactManager.m_contactListener = listener;
+	m_stackAllocator.Free(bodies);
+	return true;
+}
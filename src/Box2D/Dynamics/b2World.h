@@ -34,6 +34,8 @@ class b2Body;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
+class b2ThreadPool;
+struct b2StateWriter;
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -149,6 +151,13 @@ public:
 	void SetWarmStarting(bool flag) { m_warmStarting = flag; }
 	bool GetWarmStarting() const { return m_warmStarting; }
 
+	/// Enable/disable the solving of the velocity constraints of independent contacts
+	/// by groups of 4 with SSE2. It changes the order the contacts are solved in, so the
+	/// results are close to the ones of the scalar solver, but not the same.
+	/// Disabled by default. Has no effect if SSE2 isn't available.
+	void SetSimdSolver(bool flag) { m_simdSolver = flag; }
+	bool GetSimdSolver() const { return m_simdSolver; }
+
 	/// Enable/disable continuous physics. For testing.
 	void SetContinuousPhysics(bool flag) { m_continuousPhysics = flag; }
 	bool GetContinuousPhysics() const { return m_continuousPhysics; }
@@ -157,6 +166,13 @@ public:
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
 
+	/// Set the number of threads solving the islands, 1 by default. With more, all the islands
+	/// are built first, then solved in parallel by a pool of threads, the calling thread included.
+	/// The results are the same whatever the number of threads.
+	/// @warning b2ContactListener::PostSolve may then be called by several threads at once.
+	void SetSolverThreads(int32 count);
+	int32 GetSolverThreads() const;
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
@@ -200,10 +216,28 @@ public:
 	/// Get the current profile.
 	const b2Profile& GetProfile() const;
 
+	/// Get the number of time of impact events solved during the last time step.
+	int32 GetTOICount() const;
+
 	/// Dump the world into the log file.
 	/// @warning this should be called outside of a time step.
 	void Dump();
 
+	/// Get the size in bytes of the state written by SaveState.
+	int32 GetStateSize() const;
+
+	/// Write the state of the simulation in buffer, which must be GetStateSize() bytes long :
+	/// the motion and sleep state of the bodies, the contacts with their impulses, the joints
+	/// and the broad-phase. The bodies, fixtures and joints themselves aren't saved.
+	/// @warning this should be called outside of a time step.
+	void SaveState(void* buffer) const;
+
+	/// Restore a state written by SaveState. The world must have the same bodies, fixtures and
+	/// joints, in the same order : the simulation then goes on exactly as after SaveState.
+	/// The contact listener isn't called. Returns false if the state doesn't match the world.
+	/// @warning this should be called outside of a time step.
+	bool RestoreState(const void* buffer, int32 size);
+
 private:
 
 	// m_flags
@@ -220,8 +254,13 @@ private:
 	friend class b2Controller;
 
 	void Solve(const b2TimeStep& step);
+	void SolveParallel(const b2TimeStep& step);
+	void SynchronizeSolved();
 	void SolveTOI(const b2TimeStep& step);
 
+	void WriteState(b2StateWriter* writer) const;
+	bool CheckState(const void* buffer, int32 size, b2Body** bodies) const;
+
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
@@ -250,12 +289,18 @@ private:
 
 	// These are for debugging the solver.
 	bool m_warmStarting;
+	bool m_simdSolver;
 	bool m_continuousPhysics;
 	bool m_subStepping;
 
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+	int32 m_toiCount;
+
+	// The workers solving the islands in parallel, NULL if they are solved by the calling thread.
+	b2ThreadPool* m_threadPool;
+	b2StackAllocator* m_workerAllocators;
 };
 
 inline b2Body* b2World::GetBodyList()
@@ -346,4 +391,9 @@ inline const b2Profile& b2World::GetProfile() const
 	return m_profile;
 }
 
+inline int32 b2World::GetTOICount() const
+{
+	return m_toiCount;
+}
+
 #endif
@@ -0,0 +1,47 @@
+
+#include "core/hash.hpp"
+
+namespace core
+{
+    /** @brief The FNV-1a offset basis. */
+    const uint64_t fnvOffset = 14695981039346656037ULL;
+    /** @brief The FNV-1a prime. */
+    const uint64_t fnvPrime = 1099511628211ULL;
+
+    Hash::Hash()
+        : m_value(fnvOffset)
+    {}
+
+    Hash::Hash(const Hash& cp)
+        : m_value(cp.m_value)
+    {}
+
+    Hash& Hash::operator=(const Hash& cp)
+    {
+        m_value = cp.m_value;
+        return *this;
+    }
+
+    Hash::~Hash()
+    {}
+
+    void Hash::add(const void* data, size_t size)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for(size_t i = 0; i < size; ++i) {
+            m_value ^= bytes[i];
+            m_value *= fnvPrime;
+        }
+    }
+
+    uint64_t Hash::value() const
+    {
+        return m_value;
+    }
+
+    void Hash::reset()
+    {
+        m_value = fnvOffset;
+    }
+}
+
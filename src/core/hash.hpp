@@ -0,0 +1,41 @@
+
+#ifndef DEF_CORE_HASH
+#define DEF_CORE_HASH
+
+#include <cstdint>
+#include <cstddef>
+
+namespace core
+{
+    /** @brief A 64 bits FNV-1a hash, fed with the raw bytes of values.
+     * The hash of floats depends on their exact bits : two states hashing the same are identical, not only close.
+     */
+    class Hash
+    {
+        public:
+            Hash();
+            Hash(const Hash& cp);
+            Hash& operator=(const Hash& cp);
+            ~Hash();
+
+            /** @brief Add size bytes from data to the hash. */
+            void add(const void* data, size_t size);
+            /** @brief Add the bytes of a value without padding, like a number or a bool. */
+            template <typename T> void add(const T& value);
+            /** @brief Get the hash of all the bytes added since the creation or the last reset. */
+            uint64_t value() const;
+            /** @brief Restart the hash from the beginning. */
+            void reset();
+
+        private:
+            uint64_t m_value; /**< @brief The current value of the hash. */
+    };
+
+    template <typename T> void Hash::add(const T& value)
+    {
+        add(&value, sizeof(T));
+    }
+}
+
+#endif
+
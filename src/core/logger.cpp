@@ -3,6 +3,7 @@
 #include "core/systemtime.hpp"
 #include <vector>
 #include <sstream>
+#include <mutex>
 
 namespace core
 {
@@ -24,6 +25,8 @@ namespace core
          * If false, nothing will be logged.
          */
         static bool initializated = false;
+        /** @brief Prevents the messages logged at once by different threads from mixing. */
+        static std::mutex outputsMutex;
 
         void init()
         {
@@ -114,6 +117,7 @@ namespace core
                 whole << ">";
             whole << " " << msg << "\t[" << file << ":" << line << "] ";
 
+            std::lock_guard<std::mutex> lock(outputsMutex);
             for(size_t i = 0; i < outputs.size(); ++i) {
                 (*outputs[i].os) << whole.str() << std::endl;
             }
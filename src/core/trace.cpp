@@ -0,0 +1,164 @@
+
+#include "core/trace.hpp"
+#include "core/logger.hpp"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace core
+{
+    Trace::Trace()
+        : m_columns(0)
+    {}
+
+    Trace::~Trace()
+    {
+        close();
+    }
+
+    /*************************
+     *        Writing        *
+     *************************/
+    bool Trace::open(const std::string& path, const std::vector<std::string>& columns)
+    {
+        close();
+        m_ofs.open(path.c_str(), std::ios::out | std::ios::trunc);
+        if(!m_ofs) {
+            std::ostringstream oss;
+            oss << "Couldn't open the trace file \"" << path << "\".";
+            core::logger::logm(oss.str(), core::logger::WARNING);
+            return false;
+        }
+
+        m_columns = columns.size();
+        m_ofs << "# frame";
+        for(const std::string& col : columns)
+            m_ofs << " " << col;
+        m_ofs << "\n";
+        m_ofs << std::hex << std::setfill('0');
+        return true;
+    }
+
+    bool Trace::opened() const
+    {
+        return m_ofs.is_open();
+    }
+
+    void Trace::record(unsigned long frame, const uint64_t* hashes)
+    {
+        if(!m_ofs.is_open())
+            return;
+        m_ofs << std::dec << frame << std::hex;
+        for(size_t i = 0; i < m_columns; ++i)
+            m_ofs << " " << std::setw(16) << hashes[i];
+        m_ofs << "\n";
+    }
+
+    void Trace::close()
+    {
+        if(m_ofs.is_open())
+            m_ofs.close();
+        m_ofs.clear();
+        m_columns = 0;
+    }
+
+    /*************************
+     *       Comparing       *
+     *************************/
+    bool Trace::diff(const std::string& first, const std::string& second, Divergence* div)
+    {
+        std::ifstream ifs1(first.c_str());
+        std::ifstream ifs2(second.c_str());
+        std::vector<std::string> cols1, cols2;
+        if(!readHeader(ifs1, first, &cols1) || !readHeader(ifs2, second, &cols2))
+            return false;
+        if(cols1 != cols2) {
+            std::ostringstream oss;
+            oss << "The traces \"" << first << "\" and \"" << second << "\" don't hash the same subsystems.";
+            core::logger::logm(oss.str(), core::logger::WARNING);
+            return false;
+        }
+
+        div->diverged = false;
+        div->frame = 0;
+        div->line = 1;
+        div->column.clear();
+        unsigned long frame1, frame2;
+        std::vector<uint64_t> hashes1, hashes2;
+        while(true) {
+            ++div->line;
+            bool read1 = readFrame(ifs1, cols1.size(), &frame1, &hashes1);
+            bool read2 = readFrame(ifs2, cols2.size(), &frame2, &hashes2);
+            if(!read1 && !read2)
+                return true;
+
+            /* A trace ends before the other. */
+            if(!read1 || !read2) {
+                div->diverged = true;
+                div->frame = read1 ? frame1 : frame2;
+                div->column = "end";
+                return true;
+            }
+
+            if(frame1 != frame2) {
+                div->diverged = true;
+                div->frame = std::min(frame1, frame2);
+                div->column = "frame";
+                return true;
+            }
+
+            for(size_t i = 0; i < cols1.size(); ++i) {
+                if(hashes1[i] != hashes2[i]) {
+                    div->diverged = true;
+                    div->frame = frame1;
+                    div->column = cols1[i];
+                    return true;
+                }
+            }
+        }
+    }
+
+    bool Trace::readHeader(std::ifstream& ifs, const std::string& path, std::vector<std::string>* columns)
+    {
+        std::string line;
+        if(!ifs || !std::getline(ifs, line)) {
+            std::ostringstream oss;
+            oss << "Couldn't read the trace file \"" << path << "\".";
+            core::logger::logm(oss.str(), core::logger::WARNING);
+            return false;
+        }
+
+        std::istringstream iss(line);
+        std::string word;
+        iss >> word;
+        if(word != "#" || !(iss >> word) || word != "frame") {
+            std::ostringstream oss;
+            oss << "The file \"" << path << "\" is not a trace file.";
+            core::logger::logm(oss.str(), core::logger::WARNING);
+            return false;
+        }
+
+        columns->clear();
+        while(iss >> word)
+            columns->push_back(word);
+        return true;
+    }
+
+    bool Trace::readFrame(std::ifstream& ifs, size_t columns, unsigned long* frame, std::vector<uint64_t>* hashes)
+    {
+        std::string line;
+        if(!std::getline(ifs, line))
+            return false;
+
+        std::istringstream iss(line);
+        if(!(iss >> std::dec >> *frame))
+            return false;
+        hashes->resize(columns);
+        for(size_t i = 0; i < columns; ++i) {
+            if(!(iss >> std::hex >> (*hashes)[i]))
+                return false;
+        }
+        return true;
+    }
+}
+
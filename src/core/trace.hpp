@@ -0,0 +1,64 @@
+
+#ifndef DEF_CORE_TRACE
+#define DEF_CORE_TRACE
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+
+namespace core
+{
+    /** @brief A trace of the hashes of a simulation state, one line per frame and one column per subsystem.
+     * Two traces of the same match can be compared to find the first frame at which they diverge, and which subsystem
+     * diverged first. The file is a text file : a header line "# frame <columns...>", then for each recorded frame its
+     * number followed by the hashes in hexadecimal.
+     */
+    class Trace
+    {
+        public:
+            Trace();
+            Trace(const Trace&) = delete;
+            ~Trace();
+
+            /** @brief Open a trace file for writing, truncating it.
+             * @param path    The path to the file.
+             * @param columns The names of the subsystems hashed, one per column.
+             * @return False if the file couldn't be opened.
+             */
+            bool open(const std::string& path, const std::vector<std::string>& columns);
+            /** @brief Indicates if a trace file is opened. */
+            bool opened() const;
+            /** @brief Write the hashes of a frame, there must be one per column. */
+            void record(unsigned long frame, const uint64_t* hashes);
+            /** @brief Close the trace file, flushing it. */
+            void close();
+
+            /** @brief Describes where two traces diverge. */
+            struct Divergence {
+                bool diverged;       /**< @brief Indicates if the traces diverge. */
+                unsigned long frame; /**< @brief The first frame which differs. */
+                size_t line;         /**< @brief The line of this frame in the files, starting at 1. */
+                std::string column;  /**< @brief The first subsystem differing, "end" if a trace ends before the other. */
+            };
+            /** @brief Compare two trace files.
+             * @param first  The path to the reference trace.
+             * @param second The path to the trace to compare.
+             * @param div    Where the divergence found is stored.
+             * @return False if a file couldn't be read or the traces don't have the same columns.
+             */
+            static bool diff(const std::string& first, const std::string& second, Divergence* div);
+
+        private:
+            std::ofstream m_ofs; /**< @brief The file written. */
+            size_t m_columns;    /**< @brief The number of hashes per frame. */
+
+            /** @brief Read the header of a trace file and return its columns. */
+            static bool readHeader(std::ifstream& ifs, const std::string& path, std::vector<std::string>* columns);
+            /** @brief Read a frame from a trace file, return false at the end of the file. */
+            static bool readFrame(std::ifstream& ifs, size_t columns, unsigned long* frame, std::vector<uint64_t>* hashes);
+    };
+}
+
+#endif
+
@@ -76,6 +76,11 @@ namespace events
         removeSaveds();
     }
 
+    bool Events::wait(Uint32 timeout)
+    {
+        return SDL_WaitEventTimeout(NULL, (int)timeout) == 1;
+    }
+
     void Events::update()
     {
         /* Initialising */
@@ -29,6 +29,11 @@ namespace events
              ************************/
             /** @brief Must be called at each loop. It will get the new events and store them. */
             void update();
+            /** @brief Blocks until an event is available or timeout milliseconds passed.
+             * The event is not consumed : it will be handled by the next call to update.
+             * @return True if an event is available.
+             */
+            bool wait(Uint32 timeout);
 
             /************************
              *       Keyboard       *
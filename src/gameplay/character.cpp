@@ -1,6 +1,5 @@
 
 #include "character.hpp"
-#include "global.hpp"
 #include "core/pathParser.hpp"
 #include "core/logger.hpp"
 #include "graphics/graphics.hpp"
@@ -26,8 +25,10 @@ namespace gameplay
     const float maxRunSpeed = 10.0f;
     /** @brief The time between an attack and a death to count as a kill in ms. */
     const Uint32 attackSuccessTime = 10000;
+    /** @brief The number of attacks created in advance for each character. */
+    const size_t attackPool = 8;
 
-    size_t Character::m_count = 0;
+    std::atomic<size_t> Character::m_count(0);
     const char* const Character::m_luaCalls[(unsigned int)ActionID::None] = {
         "walk",
         "run",
@@ -66,19 +67,20 @@ namespace gameplay
         "lost",
     };
 
-    Character::Character(const std::string& path)
-        : m_path(path), m_name("broken"), m_desc("Couldn't load."), m_valid(false), m_flip(false), m_manaRecov(manaRecov), m_world(NULL), m_ch(NULL)
+    Character::Character(const std::string& path, graphics::Graphics* gfx)
+        : m_path(path), m_name("broken"), m_desc("Couldn't load."), m_valid(false), m_prevColor(None), m_flip(false), m_clock(NULL), m_gfx(gfx), m_manaRecov(manaRecov), m_world(NULL), m_ch(NULL)
     {
-        ++m_count;
         std::ostringstream oss;
-        oss << "/characters/" << core::path::head(path) << m_count;
+        oss << "/characters/" << core::path::head(path) << ++m_count;
         m_namespace = oss.str();
     }
 
     Character::~Character()
     {
-        global::gfx->enterNamespace("/");
-        global::gfx->deleteNamespace(m_namespace);
+        if(m_gfx) {
+            m_gfx->enterNamespace("/");
+            m_gfx->deleteNamespace(m_namespace);
+        }
 
         if(m_ch && m_world)
             m_world->deleteNamespace(m_namespace);
@@ -109,24 +111,26 @@ namespace gameplay
         }
 
         /* Loading the preview.png picture. */
-        if(!global::gfx->createNamespace(m_namespace)) {
-            std::ostringstream oss;
-            oss << "Couldn't create \"" << m_namespace << "\" namespace for character.";
-            core::logger::logm(oss.str(), core::logger::WARNING);
-            return false;
-        }
+        if(m_gfx) {
+            if(!m_gfx->createNamespace(m_namespace)) {
+                std::ostringstream oss;
+                oss << "Couldn't create \"" << m_namespace << "\" namespace for character.";
+                core::logger::logm(oss.str(), core::logger::WARNING);
+                return false;
+            }
 
-        global::gfx->enterNamespace(m_namespace);
-        if(!global::gfx->loadTexture("preview", m_path + "/preview.png")) {
-            std::ostringstream oss;
-            oss << "Couldn't load \"" << m_path << "/preview.png\" texture for " << m_namespace << " character.";
-            core::logger::logm(oss.str(), core::logger::WARNING);
-            return false;
+            m_gfx->enterNamespace(m_namespace);
+            if(!m_gfx->loadTexture("preview", m_path + "/preview.png")) {
+                std::ostringstream oss;
+                oss << "Couldn't load \"" << m_path << "/preview.png\" texture for " << m_namespace << " character.";
+                core::logger::logm(oss.str(), core::logger::WARNING);
+                return false;
+            }
         }
 
         /* Loading the preview.lua script. */
         lua::exposure::Save::expose(&m_preview);
-        lua::exposure::Graphics::expose(&m_preview);
+        lua::exposure::Graphics::expose(&m_preview, m_gfx);
         lua::exposure::Path::expose(&m_preview);
         if(!m_preview.load(m_path + "/preview.lua")) {
             std::ostringstream oss;
@@ -136,13 +140,15 @@ namespace gameplay
         }
 
         /* Preparing the namespace for the script. */
-        if(!global::gfx->createNamespace("script")) {
-            std::ostringstream oss;
-            oss << "Couldn't create \"" << m_namespace << "/script\" namespace for character.";
-            core::logger::logm(oss.str(), core::logger::WARNING);
-            return false;
+        if(m_gfx) {
+            if(!m_gfx->createNamespace("script")) {
+                std::ostringstream oss;
+                oss << "Couldn't create \"" << m_namespace << "/script\" namespace for character.";
+                core::logger::logm(oss.str(), core::logger::WARNING);
+                return false;
+            }
+            m_gfx->enterNamespace("script");
         }
-        global::gfx->enterNamespace("script");
 
         if(!m_preview.existsFunction("validate"))
             m_valid = true;
@@ -158,8 +164,10 @@ namespace gameplay
             core::logger::logm(oss.str(), core::logger::WARNING);
             return false;
         }
-        else
+        else {
             m_preview.callFunction<void, int>("loadPreview", NULL, (int)None);
+            m_prevColor = None;
+        }
 
         return true;
     }
@@ -181,28 +189,35 @@ namespace gameplay
 
     void Character::preview(const geometry::AABB& msize) const
     {
-        global::gfx->enterNamespace(m_namespace);
+        if(!m_gfx)
+            return;
+        m_gfx->enterNamespace(m_namespace);
         drawPrev("preview", msize);
     }
 
     void Character::bigPreview(Color color, const geometry::AABB& msize)
     {
-        global::gfx->enterNamespace(m_namespace + "/script");
-        m_preview.callFunction<void, int>("loadPreview", NULL, (int)color);
+        if(!m_gfx)
+            return;
+        m_gfx->enterNamespace(m_namespace + "/script");
+        if(color != m_prevColor) {
+            m_preview.callFunction<void, int>("loadPreview", NULL, (int)color);
+            m_prevColor = color;
+        }
         drawPrev("preview", msize);
     }
 
     void Character::drawPrev(const std::string& nm, const geometry::AABB& msize, bool flip, bool hp) const
     {
-        if(global::gfx->rctype(nm) != graphics::Graphics::TEXT)
+        if(!m_gfx || m_gfx->rctype(nm) != graphics::Graphics::TEXT)
             return;
 
         geometry::AABB used = msize;
         geometry::Point dec(0.0f, 0.0f);
 
-        float twidth  = (float)global::gfx->getTextureWidth(nm);
-        float theight = (float)global::gfx->getTextureHeight(nm);
-        geometry::Point hot = global::gfx->getTextureHotPoint(nm);
+        float twidth  = (float)m_gfx->getTextureWidth(nm);
+        float theight = (float)m_gfx->getTextureHeight(nm);
+        geometry::Point hot = m_gfx->getTextureHotPoint(nm);
 
         float ratioSize = used.width / used.height;
         float ratioPict = twidth / theight;  
@@ -218,29 +233,29 @@ namespace gameplay
                 dec.x = 0.0f;
         }
 
-        global::gfx->push();
-        global::gfx->move(dec.x, dec.y);
+        m_gfx->push();
+        m_gfx->move(dec.x, dec.y);
         if(hp) {
-            global::gfx->move(-used.width / 2.0f, -used.height / 2.0f);
-            global::gfx->move(0.0f, -(1 - hot.y / theight) * used.height);
+            m_gfx->move(-used.width / 2.0f, -used.height / 2.0f);
+            m_gfx->move(0.0f, -(1 - hot.y / theight) * used.height);
             float fact = flip ? 1.0f : -1.0f;
-            global::gfx->move(fact * (hot.x/twidth - 0.5f) * used.width, 0.0f);
+            m_gfx->move(fact * (hot.x/twidth - 0.5f) * used.width, 0.0f);
         }
         if(flip) {
-            global::gfx->move(used.width, 0.0f);
-            global::gfx->scale(-1.0f, 1.0f);
+            m_gfx->move(used.width, 0.0f);
+            m_gfx->scale(-1.0f, 1.0f);
         }
-        global::gfx->draw(used, nm);
-        global::gfx->pop();
+        m_gfx->draw(used, nm);
+        m_gfx->pop();
     }
 
-    bool Character::load(Color c, int nb)
+    bool Character::load(Color c, int nb, Character* charas[4])
     {
         /* Loading the script. */
         lua::exposure::Save::expose(&m_perso);
-        lua::exposure::Graphics::expose(&m_perso);
+        lua::exposure::Graphics::expose(&m_perso, m_gfx);
         lua::exposure::Path::expose(&m_perso);
-        lua::exposure::Character::expose(&m_perso);
+        lua::exposure::Character::expose(&m_perso, charas);
         if(!m_perso.load(m_path + "/perso.lua")) {
             std::ostringstream oss;
             oss << "Couldn't load \"" << m_path << "/perso.lua\" script for " << m_namespace << " character.";
@@ -250,14 +265,16 @@ namespace gameplay
         m_perso.setVariable("characterID", nb);
 
         /* Preparing the namespace. */
-        global::gfx->enterNamespace(m_namespace);
-        if(!global::gfx->createNamespace("perso")) {
-            std::ostringstream oss;
-            oss << "Couldn't create \"" << m_namespace << "/perso\" namespace for character.";
-            core::logger::logm(oss.str(), core::logger::WARNING);
-            return false;
+        if(m_gfx) {
+            m_gfx->enterNamespace(m_namespace);
+            if(!m_gfx->createNamespace("perso")) {
+                std::ostringstream oss;
+                oss << "Couldn't create \"" << m_namespace << "/perso\" namespace for character.";
+                core::logger::logm(oss.str(), core::logger::WARNING);
+                return false;
+            }
+            m_gfx->enterNamespace("perso");
         }
-        global::gfx->enterNamespace("perso");
 
         /* Checking the presence of necessary methods. */
         bool valid = true;
@@ -318,7 +335,7 @@ namespace gameplay
         m_damages     = 0;
         m_dead        = false;
         m_stuned      = false;
-        m_lastReload  = SDL_GetTicks();
+        m_lastReload  = ticks();
         m_lastAtt     = NULL;
         m_lastAttTime = 0;
 
@@ -335,7 +352,7 @@ namespace gameplay
 
         /* Recovering mana. */
         {
-            Uint32 ntime = SDL_GetTicks();
+            Uint32 ntime = ticks();
             Uint32 spent = ntime - m_lastReload;
             unsigned int nmana = 0;
             nmana = (unsigned int)((float)spent * m_manaRecov);
@@ -346,7 +363,7 @@ namespace gameplay
 
         /* Don't accpet actions when stunned. */
         if(m_stuned) {
-            if(SDL_GetTicks() - m_stun > m_stunTime)
+            if(ticks() - m_stun > m_stunTime)
                 m_stuned = false;
             return;
         }
@@ -815,46 +832,54 @@ namespace gameplay
         /* Getting physic position. */
         geometry::Point pos(0.0f, 0.0f);
         if(m_ch)
-            pos = m_ch->getPosition();
+            pos = m_ch->getDrawPosition();
 
         /* Getting in the right namespace. */
-        global::gfx->enterNamespace(m_namespace);
-        global::gfx->enterNamespace("perso");
+        if(m_gfx) {
+            m_gfx->enterNamespace(m_namespace);
+            m_gfx->enterNamespace("perso");
+        }
 
         /* Updating animation. */
         actuateByLua();
 
         /* Drawing. */
-        global::gfx->push();
-        global::gfx->move(pos.x, pos.y);
-        if(m_useMsize)
-            drawPrev("drawed", m_msize, m_actual.flip, true);
-        else
-            global::gfx->blitTexture("drawed", geometry::Point(0.0f,0.0f), m_actual.flip); /* TODO center */
-        global::gfx->pop();
-
-        /* Drawing the attacks. */
-        global::gfx->push();
-        std::vector<AttackSt> toremove;
-        for(auto it = m_attacks.begin(); it != m_attacks.end(); ++it) {
-            if(it->ended) {
-                toremove.push_back(*it);
+        if(m_gfx) {
+            m_gfx->push();
+            m_gfx->move(pos.x, pos.y);
+            if(m_useMsize)
+                drawPrev("drawed", m_msize, m_actual.flip, true);
+            else
+                m_gfx->blitTexture("drawed", geometry::Point(0.0f,0.0f), m_actual.flip); /* TODO center */
+            m_gfx->pop();
+        }
+
+        /* Drawing the attacks : their scripts are run without graphics too, as they end them. */
+        if(m_gfx)
+            m_gfx->push();
+        /* The lua callbacks may create attacks : the pool musn't be iterated with iterators. */
+        for(size_t i = 0; i < m_attacks.size(); ++i) {
+            if(!m_attacks[i].used)
+                continue;
+            if(m_attacks[i].ended) {
+                removeAttack(i);
                 continue;
             }
-            if(it->draw.empty())
+            if(m_attacks[i].draw.empty())
                 continue;
-            pos = m_world->getEntity(it->name)->getPosition();
-            global::gfx->move(pos.x, pos.y);
+            pos = m_attacks[i].ent->getDrawPosition();
+            if(m_gfx) {
+                m_gfx->move(pos.x, pos.y);
+                if(m_attacks[i].flip == m_flip)
+                    m_gfx->scale(-1.0f, 1.0f);
+            }
             bool ret;
-            if(it->flip == m_flip)
-                global::gfx->scale(-1.0f, 1.0f);
-            m_perso.callFunction<bool,unsigned int>(it->draw, &ret, SDL_GetTicks() - it->begin);
+            m_perso.callFunction<bool,unsigned int>(m_attacks[i].draw, &ret, ticks() - m_attacks[i].begin);
             if(!ret)
-                toremove.push_back(*it);
+                removeAttack(i);
         }
-        for(auto it = toremove.begin(); it != toremove.end(); ++it)
-            removeAttack(*it);
-        global::gfx->pop();
+        if(m_gfx)
+            m_gfx->pop();
     }
 
     void Character::actuateByLua()
@@ -862,7 +887,7 @@ namespace gameplay
         if(m_actual.id == ActionID::None)
             return;
 
-        unsigned long ms = SDL_GetTicks() - m_begin;
+        unsigned long ms = ticks() - m_begin;
         if(m_begin == 0) {
             m_begin = ms;
             ms = 0;
@@ -873,7 +898,7 @@ namespace gameplay
         if(!ret) {
             actuateByPhysic(m_next, m_actual);
             m_actual = m_next;
-            m_begin = SDL_GetTicks();
+            m_begin = ticks();
         }
     }
 
@@ -889,8 +914,10 @@ namespace gameplay
 
     void Character::appear(float percent, const geometry::AABB& msize)
     {
-        global::gfx->enterNamespace(m_namespace);
-        global::gfx->enterNamespace("perso");
+        if(!m_gfx)
+            return;
+        m_gfx->enterNamespace(m_namespace);
+        m_gfx->enterNamespace("perso");
         m_perso.callFunction<void, float>("appear", NULL, percent);
         geometry::AABB used(msize);
         used.width = 1e10f;
@@ -901,7 +928,7 @@ namespace gameplay
     {
         m_msize       = msize;
         m_useMsize    = true;
-        m_begin       = SDL_GetTicks();
+        m_begin       = ticks();
         m_actual.flip = false;
         m_actual.id   = ActionID::Lost;
         m_next.flip   = false;
@@ -912,7 +939,7 @@ namespace gameplay
     {
         m_msize       = msize;
         m_useMsize    = true;
-        m_begin       = SDL_GetTicks();
+        m_begin       = ticks();
         m_actual.flip = false;
         m_actual.id   = ActionID::Won;
         m_next.flip   = false;
@@ -921,7 +948,7 @@ namespace gameplay
 
     Character* Character::clone() const
     {
-        Character* cl = new Character(m_path);
+        Character* cl = new Character(m_path, m_gfx);
         if(!cl->preload()) {
             delete cl;
             return NULL;
@@ -946,6 +973,16 @@ namespace gameplay
             return false;
         }
 
+        /* Creating the attacks in advance, so they don't slow the game down. */
+        m_attacks.clear();
+        m_freeAttacks.clear();
+        m_attackCount = 0;
+        m_attacks.reserve(attackPool);
+        for(size_t i = 0; i < attackPool; ++i) {
+            if(!growAttacks())
+                break;
+        }
+
         return true;
     }
 
@@ -1058,7 +1095,7 @@ namespace gameplay
         if(m_damages < 0)
             m_damages = 0;
         m_lastAtt = from;
-        m_lastAttTime = SDL_GetTicks();
+        m_lastAttTime = ticks();
     }
 
     int Character::getDamages() const
@@ -1088,21 +1125,21 @@ namespace gameplay
         m_stuned = false;
         m_stun   = 0;
         /* Set death time. */
-        m_death = SDL_GetTicks();
+        m_death = ticks();
         /* Indicate death */
         m_dead = true;
         /* Warp far from the map. */
         warp(geometry::Point(-1e10f,-1e10f));
 
         /* Handle points. */
-        if(m_lastAtt && SDL_GetTicks() - m_lastAttTime < attackSuccessTime)
+        if(m_lastAtt && ticks() - m_lastAttTime < attackSuccessTime)
             m_lastAtt->addPoints(1);
         addPoints(-1);
     }
 
     bool Character::dead()
     {
-        if(SDL_GetTicks() - m_death < deathTime)
+        if(ticks() - m_death < deathTime)
             return true;
         else if(m_dead) {
             warp(m_phpos);
@@ -1119,10 +1156,10 @@ namespace gameplay
         m_ch->setLinearVelocity(0.0f, 0.0f);
         if(!m_stuned) {
             m_stuned   = true;
-            m_stun     = SDL_GetTicks();
+            m_stun     = ticks();
             m_stunTime = ms;
         } else {
-            Uint32 tmpStun  = SDL_GetTicks();
+            Uint32 tmpStun  = ticks();
             Uint32 duration = std::max(tmpStun + ms, m_stun + m_stunTime);
             m_stun          = tmpStun;
             m_stunTime      = duration - m_stun;
@@ -1132,7 +1169,7 @@ namespace gameplay
         m_next.id   = ActionID::None;
 
         m_lastAtt = from;
-        m_lastAttTime = SDL_GetTicks();
+        m_lastAttTime = ticks();
     }
 
     void Character::impact(float x, float y, Character* from, bool fixe)
@@ -1151,17 +1188,58 @@ namespace gameplay
         m_ch->applyLinearImpulse(x, y);
 
         m_lastAtt = from;
-        m_lastAttTime = SDL_GetTicks();
+        m_lastAttTime = ticks();
     }
 
     float Character::stunProgress() const
     {
         if(!m_stuned)
             return 1.0f;
-        float percent = float(SDL_GetTicks() - m_stun) / (float)m_stunTime;
+        float percent = float(ticks() - m_stun) / (float)m_stunTime;
         return percent;
     }
 
+    void Character::clock(const Uint32* ticks)
+    {
+        m_clock = ticks;
+        m_lastReload = this->ticks();
+    }
+
+    Uint32 Character::ticks() const
+    {
+        if(m_clock)
+            return *m_clock;
+        else
+            return SDL_GetTicks();
+    }
+
+    void Character::hash(core::Hash& state, core::Hash& damages, core::Hash& attacks) const
+    {
+        state.add(m_actual.id);
+        state.add(m_actual.flip);
+        state.add(m_next.id);
+        state.add(m_next.flip);
+        state.add(m_doubleJump);
+        state.add(m_stir);
+        state.add(m_stuned);
+        state.add(m_dead);
+
+        damages.add(m_damages);
+        damages.add(m_points);
+
+        attacks.add(m_attackCount);
+        for(const AttackSt& att : m_attacks) {
+            if(!att.used)
+                continue;
+            attacks.add(att.name.data(), att.name.size());
+            attacks.add(att.physic);
+            attacks.add(att.ended);
+            attacks.add(att.flip);
+            attacks.add(att.rect.width);
+            attacks.add(att.rect.height);
+        }
+    }
+
     float Character::manaProgress() const
     {
         return (float)mana() / (float)manaMax();
@@ -1169,30 +1247,6 @@ namespace gameplay
 
     bool Character::createAttack(const geometry::AABB& rect, bool physic, const std::string& mvx, const std::string& mvy, const std::string& drw, const std::string& contact, bool gravity)
     {
-        /* Store the attack. */
-        AttackSt st;
-        st.physic = physic;
-        st.rect   = rect;
-        st.begin  = SDL_GetTicks();
-        st.ch     = this;
-        st.ended  = false;
-        st.flip   = m_actual.flip;
-        std::ostringstream nm;
-        nm << "attack" << m_attackCount;
-        ++m_attackCount;
-        st.name = nm.str();
-        if(mvx.empty() || !m_perso.existsFunction(mvx))
-            st.moveX.clear();
-        else
-            st.moveX = mvx;
-        if(mvy.empty() || !m_perso.existsFunction(mvy))
-            st.moveY.clear();
-        else
-            st.moveY = mvy;
-        if(drw.empty() || !m_perso.existsFunction(drw))
-            st.draw.clear();
-        else
-            st.draw = drw;
         /* Only contact callback is mandatory. */
         if(contact.empty() || !m_perso.existsFunction(contact)) {
             std::ostringstream oss;
@@ -1200,60 +1254,72 @@ namespace gameplay
             core::logger::logm(oss.str(), core::logger::DEBUG);
             return false;
         }
-        st.contact = contact;
+
+        std::string moveX, moveY, draw;
+        if(!mvx.empty() && m_perso.existsFunction(mvx))
+            moveX = mvx;
+        if(!mvy.empty() && m_perso.existsFunction(mvy))
+            moveY = mvy;
+        if(!drw.empty() && m_perso.existsFunction(drw))
+            draw = drw;
 
         /* Getting the position. */
         geometry::Point pos(0.0f, 0.0f);
-        if(!st.moveX.empty())
-            m_perso.callFunction<float,int>(st.moveX, &pos.x, 0);
-        if(!st.moveY.empty())
-            m_perso.callFunction<float,int>(st.moveY, &pos.y, 0);
-        physics::Entity* used = m_ch;
-        if(st.flip == m_flip)
+        if(!moveX.empty())
+            m_perso.callFunction<float,int>(moveX, &pos.x, 0);
+        if(!moveY.empty())
+            m_perso.callFunction<float,int>(moveY, &pos.y, 0);
+        if(m_actual.flip == m_flip)
             pos.x *= -1.0f;
-
-        /* Creating the entity. */
-        if(st.physic) {
+        if(physic) {
             pos.x += m_ch->getPosition().x;
             pos.y += m_ch->getPosition().y;
         }
-        m_world->enterNamespace(m_namespace);
-        used = m_world->createEntity(st.name, pos, b2_dynamicBody);
-        if(!gravity)
-            used->setGravityScale(0.0f);
-        if(!used)
+
+        /* Getting an attack from the pool and resetting its entity. */
+        int id = acquireAttack();
+        if(id < 0)
             return false;
-        if(!used->createFixture("main", st.rect, 1, 1, physics::Entity::Type::ThisType,
-                    physics::Entity::Type::ThisCollideWith, geometry::Point(0,0), true)) {
-            m_world->destroyEntity(st.name);
+        AttackSt& st = m_attacks[id];
+        if(!st.ent->resizeFixture("main", rect)) {
+            removeAttack(id);
             return false;
         }
-
-        /* Adding it to the list. */
-        auto it = m_attacks.insert(m_attacks.end(), st);
-
-        /* Setting up the callback. */
-        m_world->setCallback(st.name, &attackcallback, &(*it));
+        st.physic  = physic;
+        st.rect    = rect;
+        st.begin   = ticks();
+        st.ended   = false;
+        st.flip    = m_actual.flip;
+        st.moveX   = moveX;
+        st.moveY   = moveY;
+        st.draw    = draw;
+        st.contact = contact;
+        st.ent->setPosition(pos);
+        st.ent->setLinearVelocity(0.0f, 0.0f);
+        st.ent->setAngularVelocity(0.0f);
+        st.ent->setGravityScale(gravity ? 1.0f : 0.0f);
+        st.ent->setActive(true);
         return true;
     }
 
     void Character::attackCallbacks()
     {
-        for(auto it = m_attacks.begin(); it != m_attacks.end(); ++it) {
-            Uint32 ms = SDL_GetTicks() - it->begin;
+        for(AttackSt& att : m_attacks) {
+            if(!att.used)
+                continue;
+            Uint32 ms = ticks() - att.begin;
             geometry::Point mv(0.0f, 0.0f);
-            if(!it->moveX.empty())
-                m_perso.callFunction<float,unsigned int>(it->moveX, &mv.x, ms);
-            if(it->flip == m_flip)
+            if(!att.moveX.empty())
+                m_perso.callFunction<float,unsigned int>(att.moveX, &mv.x, ms);
+            if(att.flip == m_flip)
                 mv.x *= -1.0f;
-            if(!it->moveY.empty())
-                m_perso.callFunction<float,unsigned int>(it->moveY, &mv.y, ms);
+            if(!att.moveY.empty())
+                m_perso.callFunction<float,unsigned int>(att.moveY, &mv.y, ms);
 
-            physics::Entity* ent = m_world->getEntity(it->name);
-            geometry::Point pos(ent->getPosition());
+            geometry::Point pos(att.ent->getPosition());
             pos.x += mv.x;
             pos.y += mv.y;
-            ent->setPosition(pos);
+            att.ent->setPosition(pos);
         }
     }
 
@@ -1268,22 +1334,75 @@ namespace gameplay
             return;
         /* But not with our character. */
         AttackSt* st = (AttackSt*)data;
-        if(st->ch->entity() == chara)
+        if(!st->used || st->ch->entity() == chara)
             return;
 
+        /* The lua callback may create attacks, moving the pool. */
+        Character* ch = st->ch;
+        size_t id = st - &ch->m_attacks[0];
         physics::Character* c = (physics::Character*)chara;
         bool ret;
-        st->ch->m_perso.callFunction<bool,int>(st->contact, &ret, c->getID());
+        ch->m_perso.callFunction<bool,int>(st->contact, &ret, c->getID());
 
         if(!ret)
-            st->ended = true;
+            ch->m_attacks[id].ended = true;
+    }
+
+    bool Character::growAttacks()
+    {
+        std::ostringstream nm;
+        nm << "attack" << m_attackCount;
+        ++m_attackCount;
+
+        m_world->enterNamespace(m_namespace);
+        physics::Entity* ent = m_world->createEntity(nm.str(), geometry::Point(0.0f, 0.0f), b2_dynamicBody);
+        if(!ent)
+            return false;
+        if(!ent->createFixture("main", geometry::AABB(1.0f, 1.0f), 1, 1, physics::Entity::Type::ThisType,
+                    physics::Entity::Type::ThisCollideWith, geometry::Point(0,0), true)) {
+            m_world->destroyEntity(nm.str());
+            return false;
+        }
+        ent->setActive(false);
+
+        AttackSt st;
+        st.name  = nm.str();
+        st.ch    = this;
+        st.ended = false;
+        st.ent   = ent;
+        st.used  = false;
+        const AttackSt* old = m_attacks.data();
+        m_attacks.push_back(st);
+        m_freeAttacks.push_back(m_attacks.size() - 1);
+
+        /* The callbacks data point in the pool : they must follow it when it moves. */
+        if(m_attacks.data() != old) {
+            for(AttackSt& att : m_attacks)
+                m_world->setCallback(att.name, &attackcallback, &att);
+        }
+        else
+            m_world->setCallback(st.name, &attackcallback, &m_attacks.back());
+        return true;
     }
 
-    void Character::removeAttack(const AttackSt& st)
+    int Character::acquireAttack()
     {
-        st.ch->m_world->enterNamespace(st.ch->m_namespace);
-        st.ch->m_world->destroyEntity(st.name);
-        st.ch->m_attacks.remove_if([&] (const AttackSt& ast) { return st.name == ast.name; });
+        if(m_freeAttacks.empty() && !growAttacks())
+            return -1;
+        size_t id = m_freeAttacks.back();
+        m_freeAttacks.pop_back();
+        m_attacks[id].used = true;
+        return (int)id;
+    }
+
+    void Character::removeAttack(size_t id)
+    {
+        AttackSt& st = m_attacks[id];
+        if(!st.used)
+            return;
+        st.ent->setActive(false);
+        st.used = false;
+        m_freeAttacks.push_back(id);
     }
 
     bool Character::flipped() const
@@ -3,9 +3,12 @@
 #define DEF_GAMEPLAY_CHARACTER
 
 #include <string>
-#include <list>
+#include <vector>
+#include <atomic>
 #include "geometry/aabb.hpp"
+#include "graphics/graphics.hpp"
 #include "lua/script.hpp"
+#include "core/hash.hpp"
 #include "physics/World.hpp"
 #include "physics/Character.hpp"
 
@@ -19,8 +22,10 @@ namespace gameplay
         public:
             /** @brief Initialize the character. Doesn't load anything.
              * @param path The path to the directory of this caracter.
+             * @param gfx  The graphics to draw with, NULL to play without graphics : nothing is loaded nor drawn, but the
+             * animations of the scripts are still run by draw, as they end the actions and the attacks.
              */
-            Character(const std::string& path);
+            Character(const std::string& path, graphics::Graphics* gfx);
             Character() = delete;
             Character(const Character&) = delete;
             ~Character();
@@ -48,6 +53,7 @@ namespace gameplay
              */
             void preview(const geometry::AABB& msize) const;
             /** @brief Print the big preview picture.
+             * The script is only called when the color changes, the loaded preview is kept otherwise.
              * @param color The color of the character.
              * @param msize the max size of the picture.
              */
@@ -55,8 +61,9 @@ namespace gameplay
 
             /** @brief Load the character main script and rcs for a specified color.
              * @param nb The id of the character in [0;3].
+             * @param charas The 4 characters of the match, the script acting on them : the array must outlive the character.
              */
-            bool load(Color c, int nb);
+            bool load(Color c, int nb, Character* charas[4]);
             /** @brief The controls that can be sent to the character. */
             enum Control {
                 Walk,   /**< @brief The walk control. */
@@ -165,18 +172,34 @@ namespace gameplay
             /** @brief Inflict an impact on the character. */
             void impact(float x, float y, Character* from = NULL, bool fixe = false);
 
+            /** @brief Use a game time instead of the real time for the timers of the character.
+             * @param ticks The game time in ms, read at each use : it must outlive the character. NULL to use the real time.
+             */
+            void clock(const Uint32* ticks);
+            /** @brief Returns the time in ms used by the timers of the character. */
+            Uint32 ticks() const;
+
+            /** @brief Adds the state of the character to hashes, used to check that a match replays identically.
+             * The timestamps and the mana, depending on the real time, aren't hashed.
+             * @param state   Hashes the actions, the jumps, the stun and the death.
+             * @param damages Hashes the damages and the points.
+             * @param attacks Hashes the attacks occuring.
+             */
+            void hash(core::Hash& state, core::Hash& damages, core::Hash& attacks) const;
+
             /* Methods exposed to lua. */
             bool createAttack(const geometry::AABB& rect, bool physic, const std::string& mvx, const std::string& mvy, const std::string& drw, const std::string& contact, bool gravity = false);
 
         private:
             std::string m_namespace;  /**< @brief The name of the namespace used by this character in gfx, audio and physics. */
             std::string m_path;       /**< @brief The path to the directory of the character. */
-            static size_t m_count;    /**< @brief The number of created characters. */
+            static std::atomic<size_t> m_count; /**< @brief The number of created characters, which can be created in different threads. */
 
             lua::Script m_preview;    /**< @brief The preview.lua script. */
             std::string m_name;       /**< @brief The name of the character. */
             std::string m_desc;       /**< @brief The description of the character. */
             bool m_valid;             /**< @brief Has the character been validated. */
+            Color m_prevColor;        /**< @brief The color of the big preview loaded by the script, reloaded only when it changes. */
 
             lua::Script m_perso;      /**< @brief The perso.lua script. */
             /** @brief Describe the possible actions of the character. */
@@ -231,6 +254,8 @@ namespace gameplay
             bool m_useMsize;          /**< @brief Must the action be drawn with a maximum size. */
             geometry::AABB m_msize;   /**< @brief The maximum size used when drawing. */
             bool m_flip;              /**< @brief Must the picture be flipped when drawing to the left. */
+            const Uint32* m_clock;    /**< @brief The game time used instead of the real time, NULL if there is none. */
+            graphics::Graphics* m_gfx; /**< @brief The graphics used, NULL if there are none. */
 
             /** @brief Link an actionID to the corresponding lua function. */
             static const char* const m_luaCalls[(unsigned int)ActionID::None];
@@ -275,9 +300,13 @@ namespace gameplay
                 Character* ch;        /**< @brief Pointer to the character calling. */
                 bool ended;           /**< @brief Indicates if the attack must be deleted. */
                 bool flip;            /**< @brief Must the attacks be flipped. */
+                physics::Entity* ent; /**< @brief The physic entity of the attack, disabled while unused. */
+                bool used;            /**< @brief Indicates if the attack is occuring or is free in the pool. */
             };
-            /**< @brief The list of all the attacks occuring. */
-            std::list<AttackSt> m_attacks;  
+            /** @brief The pool of attacks : the unused ones keep their physic entity, disabled. */
+            std::vector<AttackSt> m_attacks;
+            /** @brief The indexes of the unused attacks of the pool. */
+            std::vector<size_t> m_freeAttacks;
             int m_attackCount;        /**< @brief Count the number of attacks created. */
 
             /* Internal methods. */
@@ -298,8 +327,12 @@ namespace gameplay
             void attackCallbacks();
             /** @brief The callback for the collision with attacks. */
             static void attackcallback(physics::Entity*, physics::Entity* chara, bool bg, void* data);
-            /** @brief Remove an attack callback. */
-            static void removeAttack(const AttackSt& st);
+            /** @brief Adds an unused attack to the pool, with its physic entity disabled. */
+            bool growAttacks();
+            /** @brief Returns the index of an unused attack of the pool, creating one if needed, or -1 if it couldn't. */
+            int acquireAttack();
+            /** @brief Remove an attack : its entity is disabled and kept in the pool. */
+            void removeAttack(size_t id);
     };
 }
 
@@ -37,6 +37,8 @@ namespace gameplay
         m_namespace = "/" + id;
         for(unsigned int i = 0; i < (unsigned int)Last; ++i)
             m_ctrls[i] = NULL;
+        if(id.empty())
+            return;
 
         /* Checking the existence of controls config. */
         m_evs.enterNamespace(m_namespace);
@@ -143,19 +145,19 @@ namespace gameplay
         }
 
         if(dir != m_prevdir)
-            m_turned = SDL_GetTicks();
+            m_turned = m_ch->ticks();
         if(dir == Character::Right && m_prevdir == Character::Left)
             dir = Character::TurnRight;
         else if(dir == Character::Left && m_prevdir == Character::Right)
             dir = Character::TurnLeft;
         else if(m_prevdir == Character::TurnLeft || m_prevdir == Character::TurnRight) {
-            if(SDL_GetTicks() - m_turned > turnTime)
+            if(m_ch->ticks() - m_turned > turnTime)
                 dir = m_prevdir;
         }
         if(dir != Character::Fixed)
             m_prevdir = dir;
 
-        if(ctrl == Character::Attack && dir != Character::Fixed && SDL_GetTicks() - m_turned < smashTime)
+        if(ctrl == Character::Attack && dir != Character::Fixed && m_ch->ticks() - m_turned < smashTime)
             ctrl = Character::Smash;
 
         m_ch->action(ctrl, dir);
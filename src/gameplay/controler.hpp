@@ -16,6 +16,7 @@ namespace gameplay
         public:
             /** @brief Open the controler for the setted id.
              * It will fail if the id is unexistant or if it has already been opened.
+             * An empty id gives a controler which isn't opened, for a character driven by the code.
              */
             Controler(const std::string& id);
             Controler(const Controler&) = delete;
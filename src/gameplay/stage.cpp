@@ -1,6 +1,5 @@
 
 #include "stage.hpp"
-#include "global.hpp"
 #include "core/pathParser.hpp"
 #include "core/logger.hpp"
 #include "lua/graphicsExposure.hpp"
@@ -9,6 +8,7 @@
 #include "lua/charaExposure.hpp"
 #include <sstream>
 #include <fstream>
+#include <algorithm>
 
 namespace gameplay
 {
@@ -16,16 +16,18 @@ namespace gameplay
     const int pixelsPerPhysic = 100;
     /** @brief Time of appearance of characters in milliseconds. */
     const Uint32 appearTime = 5000;
-    int Stage::m_count = 0;
+    std::atomic<int> Stage::m_count(0);
 
-    Stage::Stage(const std::string& path)
-        : m_path(path), m_namespace(getNamespace()), m_valid(false), m_nbPlayers(0), m_started(false)
+    Stage::Stage(const std::string& path, graphics::Graphics* gfx, core::Config* cfg)
+        : m_gfx(gfx), m_cfg(cfg), m_path(path), m_namespace(getNamespace()), m_valid(false), m_nbPlayers(0), m_started(false), m_frame(0), m_clocked(false), m_updates(0), m_ticks(0), m_baking(false)
     {}
 
     Stage::~Stage()
     {
-        global::gfx->enterNamespace("/");
-        global::gfx->deleteNamespace(m_namespace);
+        if(m_gfx) {
+            m_gfx->enterNamespace("/");
+            m_gfx->deleteNamespace(m_namespace);
+        }
 
         m_world.enterNamespace("/");
         if(m_world.existsNamespace(m_namespace))
@@ -50,19 +52,21 @@ namespace gameplay
 
         /* Loading the preview picture. */
         std::string path = m_path + "/preview.png";
-        global::gfx->enterNamespace(m_namespace);
-        if(!global::gfx->loadTexture("preview", path)) {
-            std::ostringstream oss;
-            oss << "Couldn't load texture " << path <<" when loading the stage " << m_path << ".";
-            core::logger::logm(oss.str(), core::logger::ERROR);
-            return false;
+        if(m_gfx) {
+            m_gfx->enterNamespace(m_namespace);
+            if(!m_gfx->loadTexture("preview", path)) {
+                std::ostringstream oss;
+                oss << "Couldn't load texture " << path <<" when loading the stage " << m_path << ".";
+                core::logger::logm(oss.str(), core::logger::ERROR);
+                return false;
+            }
         }
 
         /* Loading the lua script. */
         path = m_path + "/validate.lua";
         lua::Script script;
         lua::exposure::Save::expose(&script);
-        lua::exposure::Graphics::expose(&script);
+        lua::exposure::Graphics::expose(&script, m_gfx);
         if(!script.load(path)) {
             std::ostringstream oss;
             oss << "Couldn't load lua script " << path << " when loading the stage " << m_path << " : the stage will be automaticly validated.";
@@ -95,11 +99,13 @@ namespace gameplay
 
     void Stage::draw(const geometry::AABB& rect) const
     {
-        global::gfx->enterNamespace(m_namespace);
+        if(!m_gfx)
+            return;
+        m_gfx->enterNamespace(m_namespace);
         geometry::Point dec(0.0f, 0.0f);
         geometry::AABB used = rect;
         float ratioSize = rect.width / rect.height;
-        float ratioPict = (float)global::gfx->getTextureWidth("preview") / (float)global::gfx->getTextureHeight("preview");
+        float ratioPict = (float)m_gfx->getTextureWidth("preview") / (float)m_gfx->getTextureHeight("preview");
 
         if(ratioPict > ratioSize) {
             used.height = used.width / ratioPict;
@@ -110,19 +116,18 @@ namespace gameplay
             dec.x = (rect.width - used.width) / 2.0f;
         }
 
-        global::gfx->push();
-        global::gfx->move(dec.x, dec.y);
-        global::gfx->draw(used, "preview");
-        global::gfx->pop();
+        m_gfx->push();
+        m_gfx->move(dec.x, dec.y);
+        m_gfx->draw(used, "preview");
+        m_gfx->pop();
     }
 
     std::string Stage::getNamespace()
     {
         std::ostringstream oss;
-        oss << "/stages/" << m_count << "/";
-        global::gfx->createNamespace(oss.str());
-
-        ++m_count;
+        oss << "/stages/" << m_count++ << "/";
+        if(m_gfx)
+            m_gfx->createNamespace(oss.str());
         return oss.str();
     }
 
@@ -132,6 +137,7 @@ namespace gameplay
         m_nbPlayers = 0;
         for(int i = 0; i < 4; ++i) {
             m_ctrls[i] = ctrls[i];
+            m_charas[i] = m_ctrls[i] ? m_ctrls[i]->attached() : NULL;
             if(m_ctrls[i])
                 ++m_nbPlayers;
         }
@@ -145,12 +151,12 @@ namespace gameplay
 
         /* Loading the lua script. */
         lua::exposure::Save::expose(&m_script);
-        lua::exposure::Graphics::expose(&m_script);
-        global::gfx->enterNamespace(m_namespace);
+        lua::exposure::Graphics::expose(&m_script, m_gfx);
+        if(m_gfx)
+            m_gfx->enterNamespace(m_namespace);
         lua::exposure::Path::expose(&m_script);
-        lua::exposure::Character::expose(&m_script);
-        lua::exposure::Stage::expose(&m_script);
-        lua::exposure::Stage::setUsedStage(this);
+        lua::exposure::Character::expose(&m_script, m_charas);
+        lua::exposure::Stage::expose(&m_script, this);
         if(!m_script.load(m_path + "/stage.lua"))
             return false;
         m_script.setVariable("characterNB", m_nbPlayers);
@@ -171,30 +177,63 @@ namespace gameplay
             return false;
         }
 
+        /* The platforms and obstacles the script adds are baked once it is loaded, except the ones it watches. */
         bool ret;
+        m_baking = m_cfg->get<bool>("phbake");
+        m_statics.clear();
         m_script.callFunction<bool, std::string>("init", &ret, m_path);
         if(!ret) {
             std::ostringstream oss;
             oss << "The stage script for \"" << m_path << "\" failed on init.";
             core::logger::logm(oss.str(), core::logger::ERROR);
+            m_baking = false;
             return false;
         }
+        bake();
 
-        /* Setting up the drawing. */
-        global::gfx->invertYAxis(true);
-        m_windowRect.width = (float)global::gfx->windowWidth() / (float)pixelsPerPhysic;
-        m_windowRect.height = (float)global::gfx->windowHeight() / (float)pixelsPerPhysic;
-        geometry::AABB toshow = ratioResize(m_maxSize, m_windowRect, true).first;
-        global::gfx->setVirtualSize(toshow.width, toshow.height);
+        /* Setting up the drawing, the whole stage being the window without graphics. */
+        if(m_gfx) {
+            m_gfx->invertYAxis(true);
+            m_windowRect.width = (float)m_gfx->windowWidth() / (float)pixelsPerPhysic;
+            m_windowRect.height = (float)m_gfx->windowHeight() / (float)pixelsPerPhysic;
+            geometry::AABB toshow = ratioResize(m_maxSize, m_windowRect, true).first;
+            m_gfx->setVirtualSize(toshow.width, toshow.height);
+        }
+        else
+            m_windowRect = m_maxSize;
         for(int i = 0; i < m_nbPlayers; ++i)
             m_ctrls[i]->attached()->physicMSize(1.0f, true);
-        m_world.enableDebugDraw(global::cfg->get<bool>("phdebug"));
+        m_world.debugDrawAABBs(m_cfg->get<bool>("phdebugaabb"));
+        m_world.debugDrawContacts(m_cfg->get<bool>("phdebugcontacts"));
+        m_world.enableDebugDraw(m_cfg->get<bool>("phdebug"));
+        m_world.stepRate(m_cfg->get<float>("phrate"));
+        m_world.maxSubsteps(m_cfg->get<int>("phsubsteps"));
+        m_world.iterations(m_cfg->get<int>("phvelit"), m_cfg->get<int>("phposit"));
+        m_world.fixedStep(m_cfg->get<bool>("phfixed"));
+        m_world.deferEvents(m_cfg->get<bool>("phdeferevents"));
+        m_world.solverThreads(m_cfg->get<int>("phthreads"));
+        m_world.simdSolver(m_cfg->get<bool>("phsimd"));
+        int level = std::max(0, std::min(m_cfg->get<int>("phstatslevel"), (int)core::logger::FATAL));
+        m_world.logStats((unsigned int)std::max(0, m_cfg->get<int>("phstats")), (core::logger::Level)level);
+
+        /* The trace of the hashes of the state, to check that a match replays identically. */
+        std::string trace = m_cfg->get<std::string>("phtrace");
+        m_frame = 0;
+        m_updates = 0;
+        m_ticks = 0;
+        if(!trace.empty()) {
+            std::vector<std::string> columns = {"physics", "characters", "damages", "attacks"};
+            m_trace.open(trace, columns);
+        }
+        /* Tracing the game doesn't change it : only the headless runs step with the updates. */
+        m_clocked = !m_gfx;
 
         m_justLoaded = true;
         m_beggining = 0;
         for(int i = 0; i < m_nbPlayers; ++i) {
             m_ctrls[i]->attached()->appearancePos(m_appearPos[i]);
             m_ctrls[i]->attached()->world(&m_world);
+            m_ctrls[i]->attached()->clock(m_clocked ? &m_ticks : NULL);
             ((physics::Character*)m_ctrls[i]->attached()->entity())->setID(i);
         }
 
@@ -203,6 +242,12 @@ namespace gameplay
 
     void Stage::update(const events::Events&)
     {
+        /* Without graphics, the game time is derived from the number of updates, so the timers don't depend on the real time. */
+        if(m_clocked) {
+            ++m_updates;
+            m_ticks = (Uint32)((double)m_updates * (double)m_world.stepDuration() * 1000.0);
+        }
+
         /* Controls update. */
         for(int i = 0; i < m_nbPlayers; ++i)
             m_ctrls[i]->update();
@@ -211,12 +256,12 @@ namespace gameplay
         if(m_justLoaded) {
             m_justLoaded = false;
             m_started = false;
-            m_beggining = SDL_GetTicks();
+            m_beggining = ticks();
             return;
         }
 
         /* Appearance and starts. */
-        Uint32 time = SDL_GetTicks() - m_beggining;
+        Uint32 time = ticks() - m_beggining;
         if(time <= appearTime)
             return;
         if(!m_started) {
@@ -235,18 +280,45 @@ namespace gameplay
             }
         }
 
-        m_world.step();
+        /* Without graphics, each update is one step, so the frames don't depend on the real time. */
+        if(m_clocked)
+            m_world.step(m_world.stepDuration());
+        else
+            m_world.step();
 
         /* Death of characters. */
         for(int i = 0; i < m_nbPlayers; ++i) {
             if(!isIn(m_ctrls[i]->attached()->getPos(), m_deathRect, m_center))
                 m_ctrls[i]->attached()->die();
         }
+
+        if(m_trace.opened())
+            traceFrame();
+        ++m_frame;
+    }
+
+    Uint32 Stage::ticks() const
+    {
+        if(m_clocked)
+            return m_ticks;
+        else
+            return SDL_GetTicks();
+    }
+
+    void Stage::traceFrame()
+    {
+        core::Hash physics, characters, damages, attacks;
+        m_world.hash(physics);
+        for(int i = 0; i < m_nbPlayers; ++i)
+            m_ctrls[i]->attached()->hash(characters, damages, attacks);
+
+        uint64_t hashes[4] = {physics.value(), characters.value(), damages.value(), attacks.value()};
+        m_trace.record(m_frame, hashes);
     }
             
     float Stage::appearProgress() const
     {
-        Uint32 time = SDL_GetTicks() - m_beggining;
+        Uint32 time = ticks() - m_beggining;
         if(time > appearTime)
             return 1.0f;
         else
@@ -255,29 +327,41 @@ namespace gameplay
 
     void Stage::draw()
     {
+        /* Without graphics, only the scripts of the characters are run, as they end their actions and attacks. */
+        if(!m_gfx) {
+            if(ticks() - m_beggining > appearTime) {
+                for(int i = 0; i < m_nbPlayers; ++i)
+                    m_ctrls[i]->attached()->draw();
+            }
+            return;
+        }
+
+        /* The HUD keeps the window resolution, only the stage itself is scaled. */
+        m_gfx->beginScene();
+
         /* Drawing the BG. */
-        global::gfx->setVirtualSize(m_windowRect.width, m_windowRect.height);
+        m_gfx->setVirtualSize(m_windowRect.width, m_windowRect.height);
         if(m_drawstaticbg) {
-            global::gfx->enterNamespace(m_namespace);
+            m_gfx->enterNamespace(m_namespace);
             m_script.callFunction<void>("drawStaticBG", NULL);
         }
 
         centerView();
         if(m_drawbg) {
-            global::gfx->enterNamespace(m_namespace);
+            m_gfx->enterNamespace(m_namespace);
             m_script.callFunction<void>("drawBG", NULL);
         }
 
         /* Drawing the appearance. */
-        Uint32 time = SDL_GetTicks() - m_beggining;
+        Uint32 time = ticks() - m_beggining;
         if(time <= appearTime) {
             float percent = (float)time / (float)appearTime * 100.0f;
             for(int i = 0; i < m_nbPlayers; ++i) {
                 geometry::AABB size = m_ctrls[i]->attached()->phSize();
-                global::gfx->push();
-                global::gfx->move(m_appearPos[i].x, m_appearPos[i].y);
+                m_gfx->push();
+                m_gfx->move(m_appearPos[i].x, m_appearPos[i].y);
                 m_ctrls[i]->attached()->appear(percent, size);
-                global::gfx->pop();
+                m_gfx->pop();
             }
         }
 
@@ -289,15 +373,16 @@ namespace gameplay
 
         /* Drawing the FG. */
         if(m_drawfg) {
-            global::gfx->enterNamespace(m_namespace);
+            m_gfx->enterNamespace(m_namespace);
             m_script.callFunction<void>("drawFG", NULL);
         }
-        m_world.debugDraw(global::gfx);
+        m_world.debugDraw(m_gfx);
+        m_gfx->endScene();
 
-        global::gfx->identity();
-        global::gfx->setVirtualSize(m_windowRect.width, m_windowRect.height);
+        m_gfx->identity();
+        m_gfx->setVirtualSize(m_windowRect.width, m_windowRect.height);
         if(m_drawstaticfg) {
-            global::gfx->enterNamespace(m_namespace);
+            m_gfx->enterNamespace(m_namespace);
             m_script.callFunction<void>("drawStaticFG", NULL);
         }
     }
@@ -383,8 +468,8 @@ namespace gameplay
         center.y += decy;
 
         /* Apply in graphics. */
-        global::gfx->setVirtualSize(englobe.width, englobe.height);
-        global::gfx->move(-center.x + englobe.width/2.0f, -center.y + englobe.height/2.0f);
+        m_gfx->setVirtualSize(englobe.width, englobe.height);
+        m_gfx->move(-center.x + englobe.width/2.0f, -center.y + englobe.height/2.0f);
     }
             
     std::pair<geometry::AABB,geometry::Point> Stage::ratioResize(const geometry::AABB& res, const geometry::AABB& fit, bool large) const
@@ -472,14 +557,86 @@ namespace gameplay
     bool Stage::addPlatform(const std::string& nm, const geometry::Point& center, const geometry::AABB& rect, float friction)
     {
         m_world.enterNamespace(m_namespace);
+        if(findStatic(nm) >= 0) {
+            core::logger::logm("Tried to override the existing static shape \"" + nm + "\" : cancelled operation.", core::logger::WARNING);
+            return false;
+        }
+        if(m_baking && !m_world.existsEntity(nm)) {
+            StaticShape shape = {nm, {center, rect, friction * 5.0f}, true, -1};
+            m_statics.push_back(shape);
+            return true;
+        }
         return m_world.createPlatform(nm, center, rect, friction * 5.0f) != NULL;
     }
 
     bool Stage::addObstacle(const std::string& nm, const geometry::Point& center, const geometry::AABB& rect, float friction)
     {
         m_world.enterNamespace(m_namespace);
+        if(findStatic(nm) >= 0) {
+            core::logger::logm("Tried to override the existing static shape \"" + nm + "\" : cancelled operation.", core::logger::WARNING);
+            return false;
+        }
+        if(m_baking && !m_world.existsEntity(nm)) {
+            StaticShape shape = {nm, {center, rect, friction * 5.0f}, false, -1};
+            m_statics.push_back(shape);
+            return true;
+        }
         return m_world.createObstacle(nm, center, rect, friction * 5.0f) != NULL;
     }
+
+    int Stage::findStatic(const std::string& nm) const
+    {
+        for(size_t i = 0; i < m_statics.size(); ++i) {
+            if(m_statics[i].name == nm)
+                return (int)i;
+        }
+        return -1;
+    }
+
+    bool Stage::takeStatic(const std::string& nm, StaticShape* shape)
+    {
+        int id = findStatic(nm);
+        if(id < 0)
+            return false;
+        *shape = m_statics[id];
+        m_statics.erase(m_statics.begin() + id);
+        if(shape->baked < 0)
+            return true;
+
+        m_world.enterNamespace(m_namespace);
+        return m_world.unbakeStatic(shape->platform ? "_bakedplatforms" : "_bakedobstacles", (size_t)shape->baked);
+    }
+
+    bool Stage::unbake(const std::string& nm)
+    {
+        StaticShape shape;
+        if(!takeStatic(nm, &shape))
+            return false;
+
+        m_world.enterNamespace(m_namespace);
+        if(shape.platform)
+            return m_world.createPlatform(nm, shape.rect.center, shape.rect.rect, shape.rect.friction) != NULL;
+        else
+            return m_world.createObstacle(nm, shape.rect.center, shape.rect.rect, shape.rect.friction) != NULL;
+    }
+
+    void Stage::bake()
+    {
+        /* The shapes are kept with their index in the baked rectangles, so they can be unbaked later. */
+        std::vector<physics::World::StaticRect> platforms, obstacles;
+        for(StaticShape& shape : m_statics) {
+            std::vector<physics::World::StaticRect>& rects = shape.platform ? platforms : obstacles;
+            shape.baked = (int)rects.size();
+            rects.push_back(shape.rect);
+        }
+        m_baking = false;
+
+        m_world.enterNamespace(m_namespace);
+        if(!platforms.empty())
+            m_world.bakeStatic("_bakedplatforms", platforms, physics::Entity::Type::Platform);
+        if(!obstacles.empty())
+            m_world.bakeStatic("_bakedobstacles", obstacles, physics::Entity::Type::Obstacle);
+    }
             
     bool Stage::addSensor(const std::string& nm, const geometry::Point& center, const geometry::AABB& rect)
     {
@@ -495,6 +652,11 @@ namespace gameplay
 
     void Stage::removeEntity(const std::string& nm)
     {
+        StaticShape shape;
+        if(findStatic(nm) >= 0) {
+            takeStatic(nm, &shape);
+            return;
+        }
         unsetEntityCallbacks(nm);
         m_world.destroyEntity(nm);
     }
@@ -525,6 +687,8 @@ namespace gameplay
             
     bool Stage::setEntityCallbacks(const std::string& nm, const std::string& begincontact, const std::string& endcontact, const std::string& incontact)
     {
+        /* A watched shape must keep its own entity. */
+        unbake(nm);
         m_world.enterNamespace(m_namespace);
         if(!m_world.existsEntity(nm))
             return false;
@@ -3,12 +3,16 @@
 #define DEF_GAMEPLAY_STAGE
 
 #include <string>
+#include <atomic>
 #include "controler.hpp"
 #include "events/events.hpp"
 #include "physics/World.hpp"
 #include "physics/Entity.hpp"
 #include "geometry/aabb.hpp"
+#include "graphics/graphics.hpp"
+#include "core/config.hpp"
 #include "lua/script.hpp"
+#include "core/trace.hpp"
 #include "lua/stageExposure.hpp"
 
 namespace gameplay
@@ -21,7 +25,13 @@ namespace gameplay
         public:
             Stage() = delete;
             Stage(const Stage&) = delete;
-            Stage(const std::string& path);
+            /** @brief Initialize the stage. Doesn't load anything.
+             * @param path The path to the directory of the stage.
+             * @param gfx  The graphics to draw with, NULL to play without graphics : each update is then one physics step,
+             * the game time is derived from the updates and draw only runs the animations of the characters.
+             * @param cfg  The configuration giving the physics options.
+             */
+            Stage(const std::string& path, graphics::Graphics* gfx, core::Config* cfg);
             ~Stage();
 
             /** @brief Load the preview of the stage. */
@@ -73,7 +83,9 @@ namespace gameplay
             void unsetEntityCallbacks(const std::string& nm);
 
         private:
-            static int m_count;              /**< @brief Count of all stages. */
+            static std::atomic<int> m_count; /**< @brief Count of all stages, which can be created in different threads. */
+            graphics::Graphics* m_gfx;       /**< @brief The graphics used, NULL if there are none. */
+            core::Config* m_cfg;             /**< @brief The configuration of the physics. */
             std::string m_path;              /**< @brief Path to the directory of the stage. */
             std::string m_namespace;         /**< @brief The namespace used by the stage. */
             std::string m_name;              /**< @brief The name of the stage. */
@@ -81,6 +93,7 @@ namespace gameplay
 
             physics::World m_world;          /**< @brief The physic world used. */
             gameplay::Controler* m_ctrls[4]; /**< @brief The controlers used. */
+            gameplay::Character* m_charas[4]; /**< @brief The characters attached to the controlers, used by the lua script. */
             int m_nbPlayers;                 /**< @brief The number of players [1-4]. */
             lua::Script m_script;            /**< @brief The lua script. */
             bool m_drawbg;                   /**< @brief Indicates if the lua script has a drawBG function. */
@@ -99,7 +112,25 @@ namespace gameplay
             Uint32 m_beggining;              /**< @brief The time of the beggining of the game. */
             geometry::Point m_appearPos[4];  /**< @brief The pos of appearance of each character, setted by the script. */
             bool m_started;                  /**< @brief Setted to true when the physics are launched, false before. */
+
+            /* Determinism checking. */
+            core::Trace m_trace;             /**< @brief The trace of the hashes of the state after each update, if enabled. */
+            unsigned long m_frame;           /**< @brief The number of updates since the physics were launched. */
+            bool m_clocked;                  /**< @brief Is the game time derived from the updates : only without graphics. */
+            unsigned long m_updates;         /**< @brief The number of updates since the stage was loaded, counted if m_clocked. */
+            Uint32 m_ticks;                  /**< @brief The game time in ms if m_clocked, derived from m_updates. */
             
+            /* Baking of the static geometry. */
+            /** @brief A platform or obstacle added while loading, baked once the script is loaded. */
+            struct StaticShape {
+                std::string name;                    /**< @brief The name given by the script. */
+                physics::World::StaticRect rect;     /**< @brief Its rectangle. */
+                bool platform;                       /**< @brief Is it a platform or an obstacle. */
+                int baked;                           /**< @brief Its index in the rectangles baked, -1 while waiting. */
+            };
+            bool m_baking;                           /**< @brief Are the platforms and obstacles added kept to be baked. */
+            std::vector<StaticShape> m_statics;      /**< @brief The platforms and obstacles waiting to be baked or baked, by name. */
+
             /* Lua callbacks. */
             /** @brief A structure to store the callbacks for an entity. */
             struct EntityCallbacks {
@@ -117,6 +148,18 @@ namespace gameplay
 
             /** @brief Create and return the namespace used. */
             std::string getNamespace();
+            /** @brief Returns the index in m_statics of a shape waiting to be baked or baked, -1 if there is none with this name. */
+            int findStatic(const std::string& nm) const;
+            /** @brief Removes a shape from m_statics, and from the baked geometry if it has already been baked. */
+            bool takeStatic(const std::string& nm, StaticShape* shape);
+            /** @brief Creates the own entity of a shape waiting to be baked or baked, which won't be baked. */
+            bool unbake(const std::string& nm);
+            /** @brief Bakes the platforms and the obstacles waiting in a static entity each. */
+            void bake();
+            /** @brief Returns the time in ms of the appearance and the characters timers : the game time if m_clocked, the real time otherwise. */
+            Uint32 ticks() const;
+            /** @brief Write the hashes of the physics, characters, damages and attacks to the trace. */
+            void traceFrame();
             /** @brief Center the view on the character shown. */
             void centerView();
             /** @brief Make a rect fit/englobe another one with ratio respect.
@@ -2,17 +2,10 @@
 #include "global.hpp"
 #include "core/i18n.hpp"
 #include "gameplay/controler.hpp"
-#include "lua/graphicsExposure.hpp"
+#include "events/keysave.hpp"
 
 namespace global
 {
-    graphics::Graphics* gfx = NULL;
-    core::Config* cfg = NULL;
-    events::Events* evs = NULL;
-    audio::Audio* audio = NULL;
-    gui::Gui* gui = NULL;
-    gui::Theme* theme = NULL;
-            
     init_exception::init_exception(const char* msg) noexcept
         : m_msg(msg)
         {}
@@ -75,6 +68,28 @@ namespace global
         global::cfg->define("guitheme",   'T', _i("The path to the gui theme."), "/usr/share/warrior/guirc");
         global::cfg->define("name",        0,  _i("The name of the window."), "Project Warror");
         global::cfg->define("phdebug",     0,  _i("Enable debug draw in the physic engine."), false);
+        global::cfg->define("phdebugaabb", 0,  _i("Draw the broad-phase AABBs of the fixtures in the physics debug draw."), false);
+        global::cfg->define("phdebugcontacts", 0, _i("Draw the contact points and normals in the physics debug draw."), false);
+        global::cfg->define("phfixed",     0,  _i("Simulate the physics with steps of fixed duration, the drawing being interpolated."), true);
+        global::cfg->define("phrate",      0,  _i("The number of physics steps per second in fixed step mode."), 60.0f);
+        global::cfg->define("phsubsteps",  0,  _i("The maximum number of physics steps per frame in fixed step mode."), 5);
+        global::cfg->define("phvelit",     0,  _i("The number of iterations of the physics velocity solver."), 10);
+        global::cfg->define("phposit",     0,  _i("The number of iterations of the physics position solver."), 8);
+        global::cfg->define("phdeferevents", 0, _i("Call the collision callbacks after the physics steps instead of during them. This changes when the lua scripts see the collisions."), false);
+        global::cfg->define("phthreads",   0,  _i("The number of threads solving the physics, the results being the same whatever it is."), 1);
+        global::cfg->define("phsimd",      0,  _i("Solve the physics contacts by groups of 4 with SIMD instructions. It is faster, but the results are slightly different from the ones of the default solver."), false);
+        global::cfg->define("phbake",      0,  _i("Merge the platforms and obstacles of the stages in a single static body each, the ones touching being merged in one fixture."), true);
+        global::cfg->define("phstats",     0,  _i("Log the statistics of the physics every this number of steps, 0 to never log them."), 0);
+        global::cfg->define("phstatslevel", 0, _i("The level the physics statistics are logged with, from 0 (debug) to 5 (fatal)."), 1);
+        global::cfg->define("phtrace",     0,  _i("The path of a file where the hashes of the state of the match are written after each update. Compare two of them with tracediff. Tracing doesn't change the game, which follows the real time : only the headless runs, without graphics, do one physics step per update with a game time derived from the updates, so that their traces can be compared."), "");
+        global::cfg->define("renderthread", 0, _i("Draw the frames in a dedicated thread, while the next one is computed."), false);
+        global::cfg->define("dynres",       0, _i("Lower the resolution of the stage when the GPU is too slow to draw it."), false);
+        global::cfg->define("dynresmin",    0, _i("The minimum scale of the resolution of the stage, between 0.1 and 1."), 0.5f);
+        global::cfg->define("dynrestarget", 0, _i("The time the GPU should take to draw the stage, in milliseconds."), 12.0f);
+        global::cfg->define("record",      0,  _i("Record the frames from the start. Recording can also be toggled with the reckey event."), false);
+        global::cfg->define("reckey",      0,  _i("The saved event toggling the recording of the frames, as in the controlers file : \"(key) <code>\" for a key."),
+                events::KeySave(events::KeyMap::F12).save());
+        global::cfg->define("recprefix",   0,  _i("The prefix of the PNG files written when recording : the directory must exist."), "/tmp/warrior_");
         /* Audio options */
         global::cfg->define("frequence", 0, _i("The frequence of the audio output."), 44100);
         global::cfg->define("sounds",    0, _i("The volume of the sounds, between 0 and 255."), 255);
@@ -117,7 +132,22 @@ namespace global
                 throw init_exception("Couldn't open the window.");
         }
 
-        lua::exposure::Graphics::setGraphicsInstance(global::gfx);
+        /* Dynamic resolution. */
+        if(global::cfg->get<bool>("dynres")) {
+            global::gfx->resolutionBounds(global::cfg->get<float>("dynresmin"), 1.0f);
+            global::gfx->resolutionTarget(global::cfg->get<float>("dynrestarget"));
+            if(!global::gfx->dynamicResolution(true))
+                core::logger::logm("Couldn't enable the dynamic resolution.", core::logger::WARNING);
+        }
+
+        /* Render thread. */
+        if(global::cfg->get<bool>("renderthread"))
+            global::gfx->renderThread(true);
+
+        /* Start recording. */
+        if(global::cfg->get<bool>("record")
+                && !global::gfx->startRecording(global::cfg->get<std::string>("recprefix")))
+            core::logger::logm("Couldn't start recording the frames.", core::logger::WARNING);
     }
 
     void loadEvents()
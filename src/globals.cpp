@@ -0,0 +1,15 @@
+
+#include "global.hpp"
+
+/* The global variables are defined apart from the initialization of the game, so that the tools using the
+ * libraries which read them can link with them without the rest of the game. */
+namespace global
+{
+    graphics::Graphics* gfx = NULL;
+    core::Config* cfg = NULL;
+    events::Events* evs = NULL;
+    audio::Audio* audio = NULL;
+    gui::Gui* gui = NULL;
+    gui::Theme* theme = NULL;
+}
+
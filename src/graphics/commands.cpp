@@ -0,0 +1,237 @@
+
+#include "graphics/commands.hpp"
+
+namespace graphics
+{
+    namespace internal
+    {
+        CommandList::CommandList()
+        {}
+
+        CommandList::~CommandList()
+        {}
+
+        /*************************
+         *       Recording       *
+         *************************/
+        void CommandList::clear()
+        {
+            Command cmd;
+            cmd.type = CLEAR;
+            m_cmds.push_back(cmd);
+        }
+
+        void CommandList::projection(float w, float h, bool invert)
+        {
+            Command cmd;
+            cmd.type = PROJECTION;
+            cmd.invert = invert;
+            cmd.xy[0] = w;
+            cmd.xy[1] = h;
+            m_cmds.push_back(cmd);
+        }
+
+        void CommandList::quad(const float* m, GLuint texture, float x, float y, float w, float h,
+                float u0, float v0, float u1, float v1, const GLubyte* rgba)
+        {
+            Command cmd;
+            cmd.type = QUAD;
+            cmd.texture = texture;
+            cmd.textref = NULL;
+            for(int i = 0; i < 4; ++i)
+                cmd.rgba[i] = rgba[i];
+
+            const float xs[] = {x, x + w, x + w, x};
+            const float ys[] = {y, y, y + h, y + h};
+            for(int i = 0; i < 4; ++i) {
+                cmd.xy[2*i]     = m[0] * xs[i] + m[2] * ys[i] + m[4];
+                cmd.xy[2*i + 1] = m[1] * xs[i] + m[3] * ys[i] + m[5];
+            }
+
+            cmd.uv[0] = u0;
+            cmd.uv[1] = v0;
+            cmd.uv[2] = u1;
+            cmd.uv[3] = v1;
+            m_cmds.push_back(cmd);
+        }
+
+        void CommandList::quad(const float* m, const GLuint* texture, float x, float y, float w, float h,
+                float u0, float v0, float u1, float v1, const GLubyte* rgba)
+        {
+            quad(m, (GLuint)0, x, y, w, h, u0, v0, u1, v1, rgba);
+            m_cmds.back().textref = texture;
+        }
+
+        void CommandList::primitive(const float* m, GLenum mode, GLuint texture, const Vertex* vs, size_t nb, float width)
+        {
+            if(nb == 0)
+                return;
+
+            Command cmd;
+            cmd.type = PRIMITIVE;
+            cmd.mode = mode;
+            cmd.texture = texture;
+            cmd.first = static_cast<GLsizei>(m_vertices.size());
+            cmd.count = static_cast<GLsizei>(nb);
+            cmd.xy[0] = width;
+
+            for(size_t i = 0; i < nb; ++i) {
+                Vertex v = vs[i];
+                v.x = m[0] * vs[i].x + m[2] * vs[i].y + m[4];
+                v.y = m[1] * vs[i].x + m[3] * vs[i].y + m[5];
+                m_vertices.push_back(v);
+            }
+            m_cmds.push_back(cmd);
+        }
+
+        void CommandList::width(float w)
+        {
+            Command cmd;
+            cmd.type = WIDTH;
+            cmd.xy[0] = w;
+            m_cmds.push_back(cmd);
+        }
+
+        void CommandList::filter(GLuint texture, bool smooth)
+        {
+            Command cmd;
+            cmd.type = FILTER;
+            cmd.texture = texture;
+            cmd.invert = smooth;
+            m_cmds.push_back(cmd);
+        }
+
+        void CommandList::call(void (*fn)(void*), void* data)
+        {
+            Command cmd;
+            cmd.type = CALL;
+            cmd.fn = fn;
+            cmd.data = data;
+            m_cmds.push_back(cmd);
+        }
+
+        void CommandList::reset()
+        {
+            m_cmds.clear();
+            m_vertices.clear();
+        }
+
+        size_t CommandList::size() const
+        {
+            return m_cmds.size();
+        }
+
+        /*************************
+         *       Execution       *
+         *************************/
+        void CommandList::execute(Shaders* shads) const
+        {
+            glMatrixMode(GL_MODELVIEW);
+            glLoadIdentity();
+
+            bool inquads = false;
+            GLuint texture = 0;
+            GLfloat width = 1.0f;
+            for(const Command& cmd : m_cmds) {
+                /* Continuing the actual block of quads if possible. */
+                GLuint cmdtext = (cmd.type == QUAD && cmd.textref != NULL) ? *cmd.textref : cmd.texture;
+                if(inquads && (cmd.type != QUAD || cmdtext != texture)) {
+                    glEnd();
+                    inquads = false;
+                }
+
+                switch(cmd.type) {
+                    case CLEAR:
+                        glClearColor(0, 0, 0, 0);
+                        glClearDepth(1.0f);
+                        glClear(GL_COLOR_BUFFER_BIT);
+                        glEnable(GL_BLEND);
+                        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                        shads->enable(true);
+                        break;
+
+                    case PROJECTION:
+                        glMatrixMode(GL_PROJECTION);
+                        glLoadIdentity();
+                        if(cmd.invert)
+                            glOrtho(0, cmd.xy[0], 0, cmd.xy[1], 1, -1);
+                        else
+                            glOrtho(0, cmd.xy[0], cmd.xy[1], 0, 1, -1);
+                        glMatrixMode(GL_MODELVIEW);
+                        break;
+
+                    case QUAD:
+                        if(!inquads) {
+                            texture = cmdtext;
+                            shads->text(texture != 0);
+                            if(texture != 0)
+                                glBindTexture(GL_TEXTURE_2D, texture);
+                            glBegin(GL_QUADS);
+                            inquads = true;
+                        }
+                        glColor4ub(cmd.rgba[0], cmd.rgba[1], cmd.rgba[2], cmd.rgba[3]);
+                        glTexCoord2f(cmd.uv[0], cmd.uv[1]); glVertex2f(cmd.xy[0], cmd.xy[1]);
+                        glTexCoord2f(cmd.uv[2], cmd.uv[1]); glVertex2f(cmd.xy[2], cmd.xy[3]);
+                        glTexCoord2f(cmd.uv[2], cmd.uv[3]); glVertex2f(cmd.xy[4], cmd.xy[5]);
+                        glTexCoord2f(cmd.uv[0], cmd.uv[3]); glVertex2f(cmd.xy[6], cmd.xy[7]);
+                        break;
+
+                    case PRIMITIVE:
+                        shads->text(cmd.texture != 0);
+                        if(cmd.texture != 0)
+                            glBindTexture(GL_TEXTURE_2D, cmd.texture);
+                        if(cmd.xy[0] >= 0.0f) {
+                            glPointSize(cmd.xy[0]);
+                            glLineWidth(cmd.xy[0]);
+                        }
+                        draw(cmd.mode, &m_vertices[cmd.first], cmd.count);
+                        if(cmd.xy[0] >= 0.0f) {
+                            glPointSize(width);
+                            glLineWidth(width);
+                        }
+                        break;
+
+                    case WIDTH:
+                        width = cmd.xy[0];
+                        glPointSize(width);
+                        glLineWidth(width);
+                        break;
+
+                    case FILTER:
+                        glBindTexture(GL_TEXTURE_2D, cmd.texture);
+                        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, cmd.invert ? GL_LINEAR : GL_NEAREST);
+                        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, cmd.invert ? GL_LINEAR : GL_NEAREST);
+                        break;
+
+                    case CALL:
+                        cmd.fn(cmd.data);
+                        break;
+
+                    default:
+                        break;
+                }
+            }
+
+            if(inquads)
+                glEnd();
+        }
+
+        void CommandList::draw(GLenum mode, const Vertex* vs, size_t nb)
+        {
+            if(nb == 0)
+                return;
+
+            glEnableClientState(GL_VERTEX_ARRAY);
+            glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+            glEnableClientState(GL_COLOR_ARRAY);
+            glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &vs[0].x);
+            glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &vs[0].u);
+            glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &vs[0].r);
+            glDrawArrays(mode, 0, static_cast<GLsizei>(nb));
+            glDisableClientState(GL_COLOR_ARRAY);
+            glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+            glDisableClientState(GL_VERTEX_ARRAY);
+        }
+    }
+}
+
@@ -0,0 +1,121 @@
+
+#ifndef DEF_GRAPHICS_COMMANDS
+#define DEF_GRAPHICS_COMMANDS
+
+#include "graphics/shaders.hpp"
+#include <vector>
+
+namespace graphics
+{
+    namespace internal
+    {
+        /** @brief Records drawing commands, to be executed later, possibly by another thread.
+         *
+         * Recording a command doesn't need the openGL context : the vertices are transformed
+         * when recorded, so the whole list can be built while the context is used by another
+         * thread. Consecutive quads using the same texture are sent in a single glBegin/glEnd block,
+         * the other primitives are drawn from a vertex array stored with the list.
+         */
+        class CommandList
+        {
+            public:
+                /** @brief A vertex of a primitive. */
+                struct Vertex {
+                    GLfloat x, y;       /**< @brief The position. */
+                    GLfloat u, v;       /**< @brief The texture coordinates. */
+                    GLubyte r, g, b, a; /**< @brief The color. */
+                };
+
+                CommandList();
+                CommandList(const CommandList&) = delete;
+                ~CommandList();
+
+                /** @name Recording.
+                 * @{
+                 */
+                /** @brief Clears the screen and enables the shaders : the beginning of a frame. */
+                void clear();
+                /** @brief Sets an orthogonal projection of size w*h, with the y axis going up if invert. */
+                void projection(float w, float h, bool invert);
+                /** @brief Draws a quad.
+                 * @param m The transformation applied : x' = m[0]*x + m[2]*y + m[4], y' = m[1]*x + m[3]*y + m[5].
+                 * @param texture The openGL texture used, 0 to draw a plain colored quad.
+                 * @param x The minimal x of the quad.
+                 * @param y The minimal y of the quad.
+                 * @param w The width of the quad.
+                 * @param h The height of the quad.
+                 * @param u0 The horizontal texture coordinate at x.
+                 * @param v0 The vertical texture coordinate at y.
+                 * @param u1 The horizontal texture coordinate at x + w.
+                 * @param v1 The vertical texture coordinate at y + h.
+                 * @param rgba The color of the quad.
+                 */
+                void quad(const float* m, GLuint texture, float x, float y, float w, float h,
+                        float u0, float v0, float u1, float v1, const GLubyte* rgba);
+                /** @brief Draws a quad whose texture is only known when executed, read from *texture : the other parameters are the ones of quad. */
+                void quad(const float* m, const GLuint* texture, float x, float y, float w, float h,
+                        float u0, float v0, float u1, float v1, const GLubyte* rgba);
+                /** @brief Draws a primitive.
+                 * @param m The transformation applied to the vertices, as for quad.
+                 * @param mode The openGL primitive : GL_POINTS, GL_LINES, GL_TRIANGLES or GL_QUADS.
+                 * @param texture The openGL texture used, 0 to draw a plain colored primitive.
+                 * @param vs The nb vertices of the primitive, copied.
+                 * @param width The size of the points and lines, negative to use the default one.
+                 */
+                void primitive(const float* m, GLenum mode, GLuint texture, const Vertex* vs, size_t nb, float width = -1.0f);
+                /** @brief Sets the default size of the points and lines. */
+                void width(float w);
+                /** @brief Sets if a texture is smoothed (linear filtering) or not. */
+                void filter(GLuint texture, bool smooth);
+                /** @brief Calls fn with data when executed, to run other openGL code at this point of the list. */
+                void call(void (*fn)(void*), void* data);
+                /** @brief Removes all the commands. */
+                void reset();
+                /** @} */
+
+                /** @brief Returns the number of commands recorded. */
+                size_t size() const;
+                /** @brief Executes all the commands : the openGL context must be current in the calling thread.
+                 * The modelview matrix is left to identity.
+                 */
+                void execute(Shaders* shads) const;
+
+                /** @brief Draws nb vertices directly : the openGL context must be current in the calling thread. */
+                static void draw(GLenum mode, const Vertex* vs, size_t nb);
+
+            private:
+                /** @brief The type of a command. */
+                enum Type : unsigned char {
+                    CLEAR,      /**< @brief Clears the screen. */
+                    PROJECTION, /**< @brief Sets the projection. */
+                    QUAD,       /**< @brief Draws a quad. */
+                    PRIMITIVE,  /**< @brief Draws vertices of the vertex array. */
+                    WIDTH,      /**< @brief Sets the default width of points and lines. */
+                    FILTER,     /**< @brief Sets the filtering of a texture. */
+                    CALL        /**< @brief Calls a function. */
+                };
+
+                /** @brief A recorded command. The vertices of quads are transformed when recorded. */
+                struct Command {
+                    Type type;        /**< @brief The type of the command. */
+                    bool invert;      /**< @brief For projections, is the y axis inverted, for filters is the texture smoothed. */
+                    GLubyte rgba[4];  /**< @brief The color of the quad. */
+                    GLuint texture;   /**< @brief The texture of the quad or primitive, 0 if none. */
+                    const GLuint* textref; /**< @brief Where to read the texture of the quad when executed, NULL to use texture. */
+                    GLenum mode;      /**< @brief The openGL primitive. */
+                    GLsizei first;    /**< @brief The index of the first vertex of the primitive in the vertex array. */
+                    GLsizei count;    /**< @brief The number of vertices of the primitive. */
+                    GLfloat xy[8];    /**< @brief The transformed vertices of the quad, the size of the projection or the width. */
+                    GLfloat uv[4];    /**< @brief The texture coordinates of the quad : u0, v0, u1, v1. */
+                    void (*fn)(void*);/**< @brief The function called. */
+                    void* data;       /**< @brief The argument of the function called. */
+                };
+
+                std::vector<Command> m_cmds;     /**< @brief The recorded commands. */
+                std::vector<Vertex> m_vertices;  /**< @brief The transformed vertices of the primitives. */
+        };
+    }
+}
+
+#endif
+
@@ -145,10 +145,8 @@ namespace graphics
 
         void Font::draw(const std::string& str, const geometry::Point& pos, float size, bool smooth, bool invert)
         {
-            core::UTF8String utf(str);
             m_shads->text(true);
             glBindTexture(GL_TEXTURE_2D, m_text->glID());
-            glColor4ub(255, 255, 255, 255);
 
             if(smooth) {
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -159,52 +157,18 @@ namespace graphics
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
             }
 
-            geometry::Point actPos = pos;
-            float fact = 1.0f;
-            if(size < 0.0f)
-                size = m_yspacing;
-            else
-                fact = size / m_yspacing;
-
-            if(invert) {
-                unsigned int nbret = 0;
-                for(size_t i = 0; i < utf.size(); ++i) {
-                    if(utf[i] == 10) /* 10 is new line */
-                        ++nbret;
-                }
-                actPos.y += (float)nbret * size;
-            }
+            layout(str, pos, size, invert);
+            if(!m_quads.empty())
+                CommandList::draw(GL_QUADS, &m_quads[0], m_quads.size());
+        }
 
-            for(size_t i = 0; i < utf.size(); ++i) {
-                if(utf[i] == 10) { /* 10 is new line */
-                    actPos.x = pos.x;
-                    if(invert)
-                        actPos.y -= size;
-                    else
-                        actPos.y += size;
-                }
-                else if(!hasLetter(utf[i])) { /* If the letter is not found, draw a space */
-                    actPos.x += m_xspacing * fact;
-                }
-                else { /* Draw the letter */
-                    Letter l = m_letters[utf[i]];
-                    glBegin(GL_QUADS);
-                    if(invert) {
-                        glTexCoord2f(l.lt.x, l.rb.y); glVertex2f(actPos.x,              actPos.y);
-                        glTexCoord2f(l.rb.x, l.rb.y); glVertex2f(actPos.x + l.w * fact, actPos.y);
-                        glTexCoord2f(l.rb.x, l.lt.y); glVertex2f(actPos.x + l.w * fact, actPos.y + l.h * fact);
-                        glTexCoord2f(l.lt.x, l.lt.y); glVertex2f(actPos.x,              actPos.y + l.h * fact);
-                    }
-                    else {
-                        glTexCoord2f(l.lt.x, l.lt.y); glVertex2f(actPos.x,              actPos.y);
-                        glTexCoord2f(l.rb.x, l.lt.y); glVertex2f(actPos.x + l.w * fact, actPos.y);
-                        glTexCoord2f(l.rb.x, l.rb.y); glVertex2f(actPos.x + l.w * fact, actPos.y + l.h * fact);
-                        glTexCoord2f(l.lt.x, l.rb.y); glVertex2f(actPos.x,              actPos.y + l.h * fact);
-                    }
-                    glEnd();
-                    actPos.x += (float)l.w * fact + m_letterSP * fact;
-                }
-            }
+        void Font::record(CommandList* list, const float* m, const std::string& str, const geometry::Point& pos, float size,
+                bool smooth, bool invert)
+        {
+            list->filter(m_text->glID(), smooth);
+            layout(str, pos, size, invert);
+            if(!m_quads.empty())
+                list->primitive(m, GL_QUADS, m_text->glID(), &m_quads[0], m_quads.size());
         }
 
         geometry::AABB Font::stringSize(const std::string& str, float size) const
@@ -293,6 +257,54 @@ namespace graphics
             l->lt = lt;
             l->rb = rb;
         }
+
+        void Font::layout(const std::string& str, const geometry::Point& pos, float size, bool invert)
+        {
+            core::UTF8String utf(str);
+            m_quads.clear();
+
+            geometry::Point actPos = pos;
+            float fact = 1.0f;
+            if(size < 0.0f)
+                size = m_yspacing;
+            else
+                fact = size / m_yspacing;
+
+            if(invert) {
+                unsigned int nbret = 0;
+                for(size_t i = 0; i < utf.size(); ++i) {
+                    if(utf[i] == 10) /* 10 is new line */
+                        ++nbret;
+                }
+                actPos.y += (float)nbret * size;
+            }
+
+            for(size_t i = 0; i < utf.size(); ++i) {
+                if(utf[i] == 10) { /* 10 is new line */
+                    actPos.x = pos.x;
+                    if(invert)
+                        actPos.y -= size;
+                    else
+                        actPos.y += size;
+                }
+                else if(!hasLetter(utf[i])) { /* If the letter is not found, draw a space */
+                    actPos.x += m_xspacing * fact;
+                }
+                else { /* Draw the letter */
+                    Letter l = m_letters[utf[i]];
+                    float top = invert ? l.rb.y : l.lt.y;
+                    float bottom = invert ? l.lt.y : l.rb.y;
+                    const CommandList::Vertex quad[] = {
+                        {actPos.x,              actPos.y,              l.lt.x, top,    255, 255, 255, 255},
+                        {actPos.x + l.w * fact, actPos.y,              l.rb.x, top,    255, 255, 255, 255},
+                        {actPos.x + l.w * fact, actPos.y + l.h * fact, l.rb.x, bottom, 255, 255, 255, 255},
+                        {actPos.x,              actPos.y + l.h * fact, l.lt.x, bottom, 255, 255, 255, 255}
+                    };
+                    m_quads.insert(m_quads.end(), quad, quad + 4);
+                    actPos.x += (float)l.w * fact + m_letterSP * fact;
+                }
+            }
+        }
     }
 }
 
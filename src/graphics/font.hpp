@@ -4,10 +4,12 @@
 
 #include "graphics/shaders.hpp"
 #include "graphics/texture.hpp"
+#include "graphics/commands.hpp"
 #include "geometry/point.hpp"
 #include "geometry/aabb.hpp"
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace graphics
 {
@@ -32,6 +34,9 @@ namespace graphics
                  * @param invert If true, the drawn text will be flipped vertically.
                  */
                 void draw(const std::string& str, const geometry::Point& pos, float size, bool smooth = true, bool invert = false);
+                /** @brief Records the drawing of a text in list, with the transformation m : the other parameters are the ones of draw. */
+                void record(CommandList* list, const float* m, const std::string& str, const geometry::Point& pos, float size,
+                        bool smooth = true, bool invert = false);
 
                 /* Information access */
                 /** @brief Get the size of a text, setting a line height to size. */
@@ -57,6 +62,7 @@ namespace graphics
                 float m_letterSP; /**< @brief Space between letters. */
                 Texture* m_text;  /**< @brief The texture managing the font texture. */
                 Shaders* m_shads; /**< @brief The shaders, used to render text. */
+                std::vector<CommandList::Vertex> m_quads; /**< @brief The vertices of the quads of the last text laid out. */
 
                 /* Internal methods */
                 /** @brief Get the color of a pixel in an SDL_Surface. */
@@ -65,6 +71,8 @@ namespace graphics
                 void pixel(SDL_Surface* s, int x, int y, Uint32 pix);
                 /** @brief Adapt the letter l to only fit the drawn letter. */
                 void fitToChar(Letter* l, SDL_Surface* surf, Uint32 bg);
+                /** @brief Fills m_quads with the quads of the letters of a text, the parameters being the ones of draw. */
+                void layout(const std::string& str, const geometry::Point& pos, float size, bool invert);
         };
     }
 }
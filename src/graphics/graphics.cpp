@@ -3,6 +3,7 @@
 #include "core/logger.hpp"
 #include <sstream>
 #include <cstring>
+#include <cmath>
 
 namespace graphics
 {
@@ -10,14 +11,21 @@ namespace graphics
     const float epsilon = 0.000001f;
     /** @brief Used to convert degres in radians. */
     const float deg2rad = 0.0174532925199433f;
+    /** @brief The size of the tiles of the textures too big to be uploaded at once. */
+    const int defaultTile = 512;
     std::map<std::string,std::string> Graphics::Entity::loaded;
 
     Graphics::Graphics()
         : m_win(NULL), m_ctx(0), m_shads(&m_exts),
         m_virtualW(0.0f), m_virtualH(0.0f), m_appliedW(0.0f), m_appliedH(0.0f), m_bandWidth(0.0f),
         m_bandLR(true), m_virtualR(false), m_yinvert(false), m_indraw(false),
-        m_lineWidth(1.0f)
-    {}
+        m_lineWidth(1.0f), m_frames(0), m_rec(&m_exts),
+        m_tested(0), m_culled(0), m_lastTested(0), m_lastCulled(0),
+        m_threaded(false), m_list(0), m_owner(false), m_thread(NULL), m_mutex(NULL), m_cond(NULL),
+        m_submitted(NULL), m_quit(false), m_syncs(0), m_lastSyncs(0), m_scaler(&m_exts), m_dynres(false), m_inscene(false)
+    {
+        m_repere = {1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f};
+    }
 
     Graphics::~Graphics()
     {
@@ -84,6 +92,10 @@ namespace graphics
     void Graphics::closeWindow()
     {
         internal::Movie::free();
+        stopThread();
+        m_rec.stop();
+        if(m_ctx)
+            m_scaler.free();
         if(m_win)
         {
             core::logger::logm("Destroying the window.", core::logger::MSG);
@@ -231,6 +243,15 @@ namespace graphics
             return false;
         }
 
+        /* Dynamic resolution */
+        if(m_dynres && !m_scaler.init(windowWidth(), windowHeight()))
+            m_dynres = false;
+
+        /* Render thread */
+        m_owner = true;
+        if(m_threaded && !startThread())
+            m_threaded = false;
+
         return true;
     }
 
@@ -247,7 +268,9 @@ namespace graphics
         computeBands();
 
         /* If in drawing mode, apply changes immediatly. */
-        if(m_indraw) {
+        if(m_indraw && m_threaded)
+            m_lists[m_list].projection(m_appliedW, m_appliedH, m_yinvert);
+        else if(m_indraw) {
             glMatrixMode(GL_PROJECTION);
             glLoadIdentity();
             if(m_yinvert)
@@ -369,6 +392,7 @@ namespace graphics
 
     void Graphics::deleteNamespace(const std::string& name)
     {
+        acquire();
         m_fs.deleteNamespace(name);
     }
 
@@ -391,12 +415,18 @@ namespace graphics
             case TEXT:
                 if(tofree->stored.text)  delete tofree->stored.text;
                 break;
+            case TILED:
+                if(tofree->stored.tiled) delete tofree->stored.tiled;
+                break;
             case MOVIE:
                 if(tofree->stored.movie) delete tofree->stored.movie;
                 break;
             case FONT:
                 if(tofree->stored.font)  delete tofree->stored.font;
                 break;
+            case PARTS:
+                if(tofree->stored.parts) delete tofree->stored.parts;
+                break;
             case NONE:
             default:
                 /* Invalid entity, shouldn't happen */
@@ -415,6 +445,21 @@ namespace graphics
 
     bool Graphics::loadTexture(const std::string& name, const std::string& path)
     {
+        return loadPicture(name, path, 0);
+    }
+
+    bool Graphics::loadTiledTexture(const std::string& name, const std::string& path, int tile)
+    {
+        if(tile <= 0) {
+            core::logger::logm("Invalid size of tiles, using the default one.", core::logger::WARNING);
+            tile = defaultTile;
+        }
+        return loadPicture(name, path, tile);
+    }
+
+    bool Graphics::loadPicture(const std::string& name, const std::string& path, int tile)
+    {
+        acquire();
         if(m_fs.existsEntity(name)) {
             std::ostringstream oss;
             oss << "Name \"" << name << "\" already exists in \"" << actualNamespace() << "\"";
@@ -429,7 +474,27 @@ namespace graphics
             Entity::loaded[path] = m_fs.actualNamespace() + name;
 
         internal::Texture* text = new internal::Texture(&m_exts);
-        if(!text->load(path)) {
+        SDL_Surface* surf = text->preload(path);
+        if(surf == NULL) {
+            delete text;
+            std::ostringstream oss;
+            oss << "Couldn't load picture file : \"" << path << "\"";
+            core::logger::logm(oss.str(), core::logger::ERROR);
+            return false;
+        }
+
+        /* Pictures too big for the hardware are tiled. */
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        if(tile == 0 && (surf->w > maxSize || surf->h > maxSize)) {
+            std::ostringstream oss;
+            oss << "Picture file \"" << path << "\" is bigger than the maximum texture size " << maxSize << ", it will be tiled.";
+            core::logger::logm(oss.str(), core::logger::MSG);
+            tile = defaultTile;
+        }
+
+        if(tile == 0 && !text->loadsdl(surf)) {
+            SDL_FreeSurface(surf);
             delete text;
             std::ostringstream oss;
             oss << "Couldn't load picture file : \"" << path << "\"";
@@ -438,12 +503,24 @@ namespace graphics
         }
 
         Entity* ent = new Entity;
-        ent->type = TEXT;
-        ent->stored.text = text;
         ent->path = path;
+        if(tile == 0) {
+            SDL_FreeSurface(surf);
+            ent->type = TEXT;
+            ent->stored.text = text;
+        }
+        else {
+            delete text;
+            ent->type = TILED;
+            ent->stored.tiled = new internal::TiledTexture(&m_exts);
+            ent->stored.tiled->loadsdl(surf, tile);
+        }
 
         if(!m_fs.createEntity(name, ent)) {
-            delete text;
+            if(ent->type == TEXT)
+                delete ent->stored.text;
+            else
+                delete ent->stored.tiled;
             delete ent;
             std::ostringstream oss;
             oss << "Couldn't create entity for picture file : \"" << path << "\"";
@@ -454,8 +531,9 @@ namespace graphics
             return true;
     }
 
-    bool Graphics::loadMovie(const std::string& name, const std::string& path)
+    bool Graphics::loadMovie(const std::string& name, const std::string& path, bool cache)
     {
+        acquire();
         if(m_fs.existsEntity(name)) {
             std::ostringstream oss;
             oss << "Name \"" << name << "\" already exists in \"" << actualNamespace() << "\"";
@@ -464,7 +542,7 @@ namespace graphics
         }
 
         internal::Movie* mov = new internal::Movie(&m_shads);
-        if(!mov->load(path)) {
+        if(!mov->load(path, cache)) {
             delete mov;
             std::ostringstream oss;
             oss << "Couldn't load movie file : \"" << path << "\"";
@@ -490,6 +568,7 @@ namespace graphics
 
     bool Graphics::loadFont(const std::string& name, const std::string& path)
     {
+        acquire();
         if(m_fs.existsEntity(name)) {
             std::ostringstream oss;
             oss << "Name \"" << name << "\" already exists in \"" << actualNamespace() << "\"";
@@ -531,6 +610,7 @@ namespace graphics
 
     bool Graphics::loadTextureFromText(const std::string& name, const std::string& font, const std::string& txt, const Color& bgc, float pts, bool alpha, unsigned char precision)
     {
+        acquire();
         if(m_fs.existsEntity(name)) {
             std::ostringstream oss;
             oss << "Name \"" << name << "\" already exists in \"" << actualNamespace() << "\"";
@@ -612,6 +692,7 @@ namespace graphics
 
     void Graphics::free(const std::string& name)
     {
+        acquire();
         m_fs.deleteEntity(name);
     }
 
@@ -633,35 +714,56 @@ namespace graphics
      *************************/
     int Graphics::getTextureWidth(const std::string& name) const
     {
-        if(rctype(name) != TEXT)
-            return 0;
-        else
+        RcType type = rctype(name);
+        if(type == TEXT)
             return m_fs.getEntityValue(name)->stored.text->width();
+        else if(type == TILED)
+            return m_fs.getEntityValue(name)->stored.tiled->width();
+        else
+            return 0;
     }
 
     int Graphics::getTextureHeight(const std::string& name) const
     {
-        if(rctype(name) != TEXT)
-            return 0;
-        else
+        RcType type = rctype(name);
+        if(type == TEXT)
             return m_fs.getEntityValue(name)->stored.text->height();
+        else if(type == TILED)
+            return m_fs.getEntityValue(name)->stored.tiled->height();
+        else
+            return 0;
     }
 
     bool Graphics::setTextureHotpoint(const std::string& name, int x, int y)
     {
-        if(rctype(name) != TEXT)
+        RcType type = rctype(name);
+        if(type != TEXT && type != TILED)
             return false;
         Entity* ent = m_fs.getEntityValue(name);
-        ent->stored.text->hotpoint(geometry::Point((float)x,(float)y));
+        if(type == TEXT)
+            ent->stored.text->hotpoint(geometry::Point((float)x,(float)y));
+        else
+            ent->stored.tiled->hotpoint(geometry::Point((float)x,(float)y));
         return true;
     }
 
     geometry::Point Graphics::getTextureHotPoint(const std::string& name) const
     {
-        if(rctype(name) != TEXT)
-            return geometry::Point(0,0);
+        RcType type = rctype(name);
         Entity* ent = m_fs.getEntityValue(name);
-        return ent->stored.text->hotpoint();
+        if(type == TEXT)
+            return ent->stored.text->hotpoint();
+        else if(type == TILED)
+            return ent->stored.tiled->hotpoint();
+        else
+            return geometry::Point(0,0);
+    }
+
+    size_t Graphics::residentTiles(const std::string& name) const
+    {
+        if(rctype(name) != TILED)
+            return 0;
+        return m_fs.getEntityValue(name)->stored.tiled->resident();
     }
 
     /*************************
@@ -716,38 +818,192 @@ namespace graphics
             m_fs.getEntityValue(name)->stored.movie->replay();
     }
 
+    /*************************
+     * Particles management  *
+     *************************/
+    bool Graphics::createParticles(const std::string& name, const std::string& texture, size_t max)
+    {
+        if(m_fs.existsEntity(name)) {
+            std::ostringstream oss;
+            oss << "Name \"" << name << "\" already exists in \"" << actualNamespace() << "\"";
+            core::logger::logm(oss.str(), core::logger::ERROR);
+            return false;
+        }
+
+        internal::Particles* parts = new internal::Particles(max);
+        parts->texture(texture);
+
+        Entity* ent = new Entity;
+        ent->type = PARTS;
+        ent->stored.parts = parts;
+
+        if(!m_fs.createEntity(name, ent)) {
+            delete parts;
+            delete ent;
+            std::ostringstream oss;
+            oss << "Couldn't create entity for particle system : \"" << name << "\"";
+            core::logger::logm(oss.str(), core::logger::ERROR);
+            return false;
+        }
+        else
+            return true;
+    }
+
+    internal::Particles* Graphics::getParticles(const std::string& name) const
+    {
+        if(rctype(name) != PARTS) {
+            core::logger::logm("Tryed to access to non-existant particle system : " + name, core::logger::WARNING);
+            return NULL;
+        }
+        else
+            return m_fs.getEntityValue(name)->stored.parts;
+    }
+
+    void Graphics::particlesTexture(const std::string& name, const std::string& texture)
+    {
+        internal::Particles* parts = getParticles(name);
+        if(parts)
+            parts->texture(texture);
+    }
+
+    void Graphics::particlesPosition(const std::string& name, const geometry::Point& pos)
+    {
+        internal::Particles* parts = getParticles(name);
+        if(parts)
+            parts->position(pos);
+    }
+
+    void Graphics::particlesRate(const std::string& name, float rate)
+    {
+        internal::Particles* parts = getParticles(name);
+        if(parts)
+            parts->rate(rate);
+    }
+
+    void Graphics::particlesLife(const std::string& name, float minl, float maxl)
+    {
+        internal::Particles* parts = getParticles(name);
+        if(parts)
+            parts->life(minl, maxl);
+    }
+
+    void Graphics::particlesVelocity(const std::string& name, float angle, float spread, float mins, float maxs)
+    {
+        internal::Particles* parts = getParticles(name);
+        if(parts)
+            parts->velocity(angle, spread, mins, maxs);
+    }
+
+    void Graphics::particlesGravity(const std::string& name, float x, float y)
+    {
+        internal::Particles* parts = getParticles(name);
+        if(parts)
+            parts->gravity(x, y);
+    }
+
+    void Graphics::particlesTint(const std::string& name, const Color& col)
+    {
+        internal::Particles* parts = getParticles(name);
+        if(parts)
+            parts->tint(col);
+    }
+
+    void Graphics::particlesSizeCurve(const std::string& name, const std::vector<float>& keys)
+    {
+        internal::Particles* parts = getParticles(name);
+        if(parts)
+            parts->sizeCurve(keys);
+    }
+
+    void Graphics::particlesAlphaCurve(const std::string& name, const std::vector<float>& keys)
+    {
+        internal::Particles* parts = getParticles(name);
+        if(parts)
+            parts->alphaCurve(keys);
+    }
+
+    size_t Graphics::burstParticles(const std::string& name, size_t count)
+    {
+        internal::Particles* parts = getParticles(name);
+        if(parts)
+            return parts->burst(count);
+        else
+            return 0;
+    }
+
+    size_t Graphics::particlesCount(const std::string& name) const
+    {
+        internal::Particles* parts = getParticles(name);
+        if(parts)
+            return parts->count();
+        else
+            return 0;
+    }
+
     /*************************
      *    Transformations    *
      *************************/
     void Graphics::rotate(float angle)
     {
-        glRotatef(angle, 0, 0, 1);
+        if(!m_threaded)
+            glRotatef(angle, 0, 0, 1);
+        float cs = std::cos(angle * deg2rad);
+        float sn = std::sin(angle * deg2rad);
+        Repere r = m_repere;
+        m_repere.a =  r.a * cs + r.c * sn;
+        m_repere.b =  r.b * cs + r.d * sn;
+        m_repere.c = -r.a * sn + r.c * cs;
+        m_repere.d = -r.b * sn + r.d * cs;
     }
 
     void Graphics::scale(float x, float y)
     {
-        glScalef(x, y, 1.0f);
+        if(!m_threaded)
+            glScalef(x, y, 1.0f);
+        m_repere.a *= x;
+        m_repere.b *= x;
+        m_repere.c *= y;
+        m_repere.d *= y;
     }
 
     void Graphics::move(float x, float y)
     {
-        glTranslatef(x, y, 0.0f);
+        if(!m_threaded)
+            glTranslatef(x, y, 0.0f);
+        m_repere.x0 += m_repere.a * x + m_repere.c * y;
+        m_repere.y0 += m_repere.b * x + m_repere.d * y;
     }
 
     void Graphics::push()
     {
-        glPushMatrix();
+        if(!m_threaded)
+            glPushMatrix();
+        m_reperes.push_back(m_repere);
     }
 
     bool Graphics::pop()
     {
+        if(m_threaded) {
+            if(m_reperes.empty())
+                return false;
+            m_repere = m_reperes.back();
+            m_reperes.pop_back();
+            return true;
+        }
+
         glPopMatrix();
+        if(!m_reperes.empty()) {
+            m_repere = m_reperes.back();
+            m_reperes.pop_back();
+        }
         return glGetError() != GL_STACK_UNDERFLOW;
     }
 
     void Graphics::identity()
     {
-        glLoadIdentity();
+        if(!m_threaded)
+            glLoadIdentity();
+        m_repere = {1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f};
         if(m_virtualR) {
             if(m_bandLR)
                 move(m_bandWidth, 0.0f);
@@ -756,12 +1012,98 @@ namespace graphics
         }
     }
 
+    /*************************
+     *        Culling        *
+     *************************/
+    std::pair<geometry::AABB,geometry::Point> Graphics::visibleRect() const
+    {
+        std::pair<geometry::AABB,geometry::Point> ret;
+        const Repere& r = m_repere;
+        float det = r.a * r.d - r.b * r.c;
+        if(std::abs(det) < epsilon)
+            return ret;
+
+        /* Applying the inverse of the repere to the corners of the view. */
+        const float xs[] = {0.0f, m_appliedW, m_appliedW, 0.0f};
+        const float ys[] = {0.0f, 0.0f, m_appliedH, m_appliedH};
+        geometry::Point p1, p2;
+        for(int i = 0; i < 4; ++i) {
+            float x = xs[i] - r.x0;
+            float y = ys[i] - r.y0;
+            geometry::Point p(( r.d * x - r.c * y) / det,
+                              (-r.b * x + r.a * y) / det);
+            if(i == 0)
+                p1 = p2 = p;
+            p1.x = std::min(p1.x, p.x);
+            p1.y = std::min(p1.y, p.y);
+            p2.x = std::max(p2.x, p.x);
+            p2.y = std::max(p2.y, p.y);
+        }
+
+        ret.first.set(p2.x - p1.x, p2.y - p1.y);
+        ret.second = p1;
+        return ret;
+    }
+
+    bool Graphics::isVisible(const geometry::Point& pos, const geometry::AABB& rect) const
+    {
+        /* Applying the repere to the corners of the rectangle. */
+        const Repere& r = m_repere;
+        const float xs[] = {pos.x, pos.x + rect.width, pos.x + rect.width, pos.x};
+        const float ys[] = {pos.y, pos.y, pos.y + rect.height, pos.y + rect.height};
+        float minx = 0.0f, maxx = 0.0f, miny = 0.0f, maxy = 0.0f;
+        for(int i = 0; i < 4; ++i) {
+            float x = r.a * xs[i] + r.c * ys[i] + r.x0;
+            float y = r.b * xs[i] + r.d * ys[i] + r.y0;
+            if(i == 0) {
+                minx = maxx = x;
+                miny = maxy = y;
+            }
+            minx = std::min(minx, x);
+            maxx = std::max(maxx, x);
+            miny = std::min(miny, y);
+            maxy = std::max(maxy, y);
+        }
+
+        return maxx >= 0.0f && minx <= m_appliedW
+            && maxy >= 0.0f && miny <= m_appliedH;
+    }
+
+    unsigned int Graphics::cullTested() const
+    {
+        return m_lastTested;
+    }
+
+    unsigned int Graphics::cullCulled() const
+    {
+        return m_lastCulled;
+    }
+
+    bool Graphics::cull(const geometry::Point& pos, float w, float h)
+    {
+        /* Outside of drawing, the repere is not the one used to display. */
+        if(!m_indraw)
+            return false;
+
+        ++m_tested;
+        if(isVisible(pos, geometry::AABB(w, h)))
+            return false;
+        ++m_culled;
+        return true;
+    }
+
     /*************************
      *       Drawing         *
      *************************/
     void Graphics::blitTexture(const std::string& name, const geometry::Point& pos, bool flip)
     {
-        if(rctype(name) != TEXT) {
+        if(rctype(name) == TILED) {
+            internal::TiledTexture* tiled = m_fs.getEntityValue(name)->stored.tiled;
+            geometry::Point ori(pos.x - tiled->hotpoint().x, pos.y - tiled->hotpoint().y);
+            drawTiled(tiled, ori, (float)tiled->width(), (float)tiled->height(), flip);
+            return;
+        }
+        else if(rctype(name) != TEXT) {
             core::logger::logm(std::string("Tried to blit an unexistant texture : ") + name, core::logger::WARNING);
             return;
         }
@@ -770,9 +1112,8 @@ namespace graphics
         geometry::Point ori = pos;
         ori.x -= text->hotpoint().x;
         ori.y -= text->hotpoint().y;
-
-        m_shads.text(true);
-        glBindTexture(GL_TEXTURE_2D, text->glID());
+        if(cull(ori, (float)text->width(), (float)text->height()))
+            return;
 
         float xfill = 1.0f, xempty = 0.0f;
         if(flip) {
@@ -780,6 +1121,16 @@ namespace graphics
             xempty = 1.0f;
         }
 
+        if(m_threaded && m_indraw) {
+            record(text->glID(), ori.x, ori.y, (float)text->width(), (float)text->height(),
+                    xempty, (m_yinvert ? 1.0f : 0.0f), xfill, (m_yinvert ? 0.0f : 1.0f), Color(255, 255, 255));
+            return;
+        }
+
+        acquire();
+        m_shads.text(true);
+        glBindTexture(GL_TEXTURE_2D, text->glID());
+
         glColor4ub(255, 255, 255, 255);
         glBegin(GL_QUADS);
         if(m_yinvert) {
@@ -799,41 +1150,41 @@ namespace graphics
 
     void Graphics::draw(const geometry::Point& point, const Color& col, float width)
     {
-        if(width >= 0.0f)
-            glPointSize(width);
-        m_shads.text(false);
-
-        glBegin(GL_POINTS);
-        glColor4ub(col.r, col.g, col.b, col.a);
-        glVertex2f(point.x, point.y);
-        glEnd();
-
-        glPointSize(m_lineWidth);
+        m_prim.clear();
+        vertex(point.x, point.y, 0.0f, 0.0f, col);
+        primitive(GL_POINTS, 0, width);
     }
 
     void Graphics::draw(const geometry::Line& line, const Color& col, float width)
     {
-        if(width >= 0)
-            glLineWidth(width);
-
-        m_shads.text(false);
-        glBegin(GL_LINES);
-        glColor4ub(col.r, col.g, col.b, col.a);
-        glVertex2f(line.p1.x, line.p1.y);
-        glVertex2f(line.p2.x, line.p2.y);
-        glEnd();
-
-        glLineWidth(width);
+        m_prim.clear();
+        vertex(line.p1.x, line.p1.y, 0.0f, 0.0f, col);
+        vertex(line.p2.x, line.p2.y, 0.0f, 0.0f, col);
+        primitive(GL_LINES, 0, width);
     }
 
     void Graphics::draw(const geometry::AABB& aabb, const std::string& text, float repeatX, float repeatY)
     {
-        if(rctype(text) != TEXT) {
+        if(rctype(text) == TILED) {
+            drawTiled(m_fs.getEntityValue(text)->stored.tiled, geometry::Point(0.0f, 0.0f), aabb.width, aabb.height, false, repeatX, repeatY);
+            return;
+        }
+        else if(rctype(text) != TEXT) {
             core::logger::logm(std::string("Tried to use an unexistant texture (AABB blitting) : ") + text, core::logger::WARNING);
             return;
         }
 
+        if(cull(geometry::Point(0.0f, 0.0f), aabb.width, aabb.height))
+            return;
+
         internal::Texture* t = m_fs.getEntityValue(text)->stored.text;
+        if(m_threaded && m_indraw) {
+            record(t->glID(), 0.0f, 0.0f, aabb.width, aabb.height,
+                    0.0f, (m_yinvert ? repeatY : 0.0f), repeatX, (m_yinvert ? 0.0f : repeatY), Color(255, 255, 255));
+            return;
+        }
+
+        acquire();
         m_shads.text(true);
         glBindTexture(GL_TEXTURE_2D, t->glID());
         glColor4ub(255, 255, 255, 255);
@@ -856,6 +1207,15 @@ namespace graphics
 
     void Graphics::draw(const geometry::AABB& aabb, const Color& col)
     {
+        if(cull(geometry::Point(0.0f, 0.0f), aabb.width, aabb.height))
+            return;
+
+        if(m_threaded && m_indraw) {
+            record(0, 0.0f, 0.0f, aabb.width, aabb.height, 0.0f, 0.0f, 0.0f, 0.0f, col);
+            return;
+        }
+
+        acquire();
         m_shads.text(false);
         glBegin(GL_QUADS);
         glColor4ub(col.r, col.g, col.b, col.a);
@@ -874,10 +1234,8 @@ namespace graphics
         }
 
         internal::Texture* t = m_fs.getEntityValue(text)->stored.text;
-        m_shads.text(true);
-        glBindTexture(GL_TEXTURE_2D, t->glID());
-        glColor4ub(255, 255, 255, 255);
-
+        Color white(255, 255, 255);
+        m_prim.clear();
         float lx = std::cos(0.0f) * circle.radius;
         float ly = std::sin(0.0f) * circle.radius;
         float ltx = (std::cos(0.0f) + 1) / 2 * repeatX;
@@ -893,29 +1251,27 @@ namespace graphics
             float ntx = (ca + 1) / 2 * repeatX;
             float nty = (sa + 1) / 2 * repeatY;
 
-            glBegin(GL_POLYGON);
-            glTexCoord2f(mx, my ); glVertex2f(0.0f, 0.0f);
+            vertex(0.0f, 0.0f, mx, my, white);
             if(m_yinvert) {
-                glTexCoord2f(ntx,-nty+2*mx); glVertex2f(nx,   ny);
-                glTexCoord2f(ltx,-lty+2*my); glVertex2f(lx,   ly);
+                vertex(nx, ny, ntx, -nty+2*mx, white);
+                vertex(lx, ly, ltx, -lty+2*my, white);
             }
             else {
-                glTexCoord2f(ntx,nty); glVertex2f(nx,   ny);
-                glTexCoord2f(ltx,lty); glVertex2f(lx,   ly);
+                vertex(nx, ny, ntx, nty, white);
+                vertex(lx, ly, ltx, lty, white);
             }
-            glEnd();
 
             lx = nx;
             ly = ny;
             ltx = ntx;
             lty = nty;
         }
+        primitive(GL_TRIANGLES, t->glID());
     }
 
     void Graphics::draw(const geometry::Circle& circle, const Color& col)
     {
-        m_shads.text(false);
-        glColor4ub(col.r, col.g, col.b, col.a);
+        m_prim.clear();
         float lx = std::cos(0.0f) * circle.radius;
         float ly = std::sin(0.0f) * circle.radius;
 
@@ -924,15 +1280,14 @@ namespace graphics
             float nx = std::cos(angle) * circle.radius;
             float ny = std::sin(angle) * circle.radius;
 
-            glBegin(GL_POLYGON);
-            glVertex2f(0.0f, 0.0f);
-            glVertex2f(nx, ny);
-            glVertex2f(lx, ly);
-            glEnd();
+            vertex(0.0f, 0.0f, 0.0f, 0.0f, col);
+            vertex(nx, ny, 0.0f, 0.0f, col);
+            vertex(lx, ly, 0.0f, 0.0f, col);
 
             lx = nx;
             ly = ny;
         }
+        primitive(GL_TRIANGLES, 0);
     }
 
     void Graphics::draw(const geometry::Polygon& poly, const std::string& text, float repeatX, float repeatY)
@@ -946,9 +1301,7 @@ namespace graphics
             return;
 
         internal::Texture* t = m_fs.getEntityValue(text)->stored.text;
-        m_shads.text(true);
-        glBindTexture(GL_TEXTURE_2D, t->glID());
-        glColor4ub(255, 255, 255, 255);
+        Color white(255, 255, 255);
 
         float minx = poly.points[0].x;
         float miny = poly.points[0].y;
@@ -967,33 +1320,34 @@ namespace graphics
         float interx = maxx - minx;
         float intery = maxy - miny;
 
+        /* Each convex part is sent as a fan of triangles. */
+        m_prim.clear();
         std::vector<geometry::Polygon> conv = poly.convexify();
         for(geometry::Polygon p : conv) {
-            glBegin(GL_POLYGON);
-            for(size_t i = 0; i < p.points.size(); ++i) {
-                float tx = (p.points[i].x - minx) / interx * repeatX;
-                float ty = (p.points[i].y - miny) / intery * repeatY;
-                if(m_yinvert)
-                    glTexCoord2f(tx, -ty);
-                else
-                    glTexCoord2f(tx, ty);
-                glVertex2f(p.points[i].x, p.points[i].y);
+            for(size_t i = 1; i + 1 < p.points.size(); ++i) {
+                const size_t ids[] = {0, i, i + 1};
+                for(size_t id : ids) {
+                    float tx = (p.points[id].x - minx) / interx * repeatX;
+                    float ty = (p.points[id].y - miny) / intery * repeatY;
+                    vertex(p.points[id].x, p.points[id].y, tx, (m_yinvert ? -ty : ty), white);
+                }
             }
-            glEnd();
         }
+        primitive(GL_TRIANGLES, t->glID());
     }
 
     void Graphics::draw(const geometry::Polygon& poly, const Color& col)
     {
-        m_shads.text(false);
+        m_prim.clear();
         std::vector<geometry::Polygon> conv = poly.convexify();
         for(geometry::Polygon p : conv) {
-            glBegin(GL_POLYGON);
-            glColor4ub(col.r, col.g, col.b, col.a);
-            for(size_t i = 0; i < p.points.size(); ++i)
-                glVertex2f(p.points[i].x, p.points[i].y);
-            glEnd();
+            for(size_t i = 1; i + 1 < p.points.size(); ++i) {
+                vertex(p.points[0].x,     p.points[0].y,     0.0f, 0.0f, col);
+                vertex(p.points[i].x,     p.points[i].y,     0.0f, 0.0f, col);
+                vertex(p.points[i + 1].x, p.points[i + 1].y, 0.0f, 0.0f, col);
+            }
         }
+        primitive(GL_TRIANGLES, 0);
     }
 
     void Graphics::draw(const std::string& str, const std::string& font, float pts)
@@ -1004,11 +1358,29 @@ namespace graphics
         }
 
         internal::Font* f = m_fs.getEntityValue(font)->stored.font;
+        if(m_threaded && m_indraw) {
+            const float m[] = {m_repere.a, m_repere.b, m_repere.c, m_repere.d, m_repere.x0, m_repere.y0};
+            f->record(&m_lists[m_list], m, str, geometry::Point(0.0f, 0.0f), pts, true, m_yinvert);
+            return;
+        }
+
+        acquire();
         f->draw(str, geometry::Point(0.0f, 0.0f), pts, true, m_yinvert);
     }
 
+    void Graphics::drawTriangles(const std::vector<Vertex>& vertices)
+    {
+        drawArray(GL_TRIANGLES, vertices, -1.0f);
+    }
+
+    void Graphics::drawLines(const std::vector<Vertex>& vertices, float width)
+    {
+        drawArray(GL_LINES, vertices, width);
+    }
+
     bool Graphics::play(const std::string& movie, const geometry::AABB& rect, bool ratio)
     {
+        acquire();
         if(rctype(movie) != MOVIE) {
             core::logger::logm(std::string("Tried to play an unexistant movie : ") + movie, core::logger::WARNING);
             return false;
@@ -1020,8 +1392,42 @@ namespace graphics
         return ret;
     }
 
+    size_t Graphics::drawParticles(const std::string& name)
+    {
+        internal::Particles* parts = getParticles(name);
+        if(!parts)
+            return 0;
+
+        parts->updateTime();
+        std::string tname = parts->texture();
+        if(rctype(tname) != TEXT) {
+            core::logger::logm(std::string("Tried to use an unexistant texture (particles drawing) : ") + tname, core::logger::WARNING);
+            return 0;
+        }
+
+        internal::Texture* text = m_fs.getEntityValue(tname)->stored.text;
+        parts->build((float)text->width(), (float)text->height(), m_yinvert);
+        if(m_threaded && m_indraw) {
+            const float m[] = {m_repere.a, m_repere.b, m_repere.c, m_repere.d, m_repere.x0, m_repere.y0};
+            parts->record(&m_lists[m_list], m, text->glID());
+            return parts->count();
+        }
+
+        acquire();
+        m_shads.text(true);
+        glBindTexture(GL_TEXTURE_2D, text->glID());
+        parts->submit();
+        return parts->count();
+    }
+
     float Graphics::defaultWidth(float nval)
     {
+        if(m_threaded && m_indraw) {
+            m_lists[m_list].width(nval);
+            return (m_lineWidth = nval);
+        }
+
+        acquire();
         glPointSize(nval);
         glLineWidth(nval);
         return (m_lineWidth = nval);
@@ -1034,6 +1440,19 @@ namespace graphics
 
     void Graphics::beginDraw()
     {
+        if(m_threaded) {
+            m_lists[m_list].clear();
+            m_lists[m_list].projection(m_appliedW, m_appliedH, m_yinvert);
+            m_lists[m_list].width(m_lineWidth);
+            identity();
+            m_reperes.clear();
+            m_tested = 0;
+            m_culled = 0;
+            m_syncs = 0;
+            m_indraw = true;
+            return;
+        }
+
         glClearColor(0, 0, 0, 0);
         glClearDepth(1.0f);
 
@@ -1052,11 +1471,15 @@ namespace graphics
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         m_shads.enable(true);
 
+        m_reperes.clear();
+        m_tested = 0;
+        m_culled = 0;
         m_indraw = true;
     }
 
     void Graphics::endDraw()
     {
+        endScene();
         if(m_virtualR) {
             geometry::AABB band;
             identity();
@@ -1077,9 +1500,495 @@ namespace graphics
             draw(band, c);
         }
 
-        glFlush();
-        SDL_GL_SwapWindow(m_win);
+        if(m_threaded)
+            submit();
+        else {
+            m_rec.capture();
+            glFlush();
+            SDL_GL_SwapWindow(m_win);
+        }
         m_indraw = false;
+        ++m_frames;
+        m_lastTested = m_tested;
+        m_lastCulled = m_culled;
+        m_lastSyncs = m_syncs;
+    }
+
+    unsigned int Graphics::frames() const
+    {
+        return m_frames;
+    }
+
+    /*************************
+     *       Recording       *
+     *************************/
+    bool Graphics::startRecording(const std::string& prefix)
+    {
+        acquire();
+        if(!m_win)
+            return false;
+        return m_rec.start(prefix, windowWidth(), windowHeight());
+    }
+
+    void Graphics::stopRecording()
+    {
+        acquire();
+        m_rec.stop();
+    }
+
+    bool Graphics::isRecording() const
+    {
+        return m_rec.recording();
+    }
+
+    unsigned int Graphics::droppedFrames() const
+    {
+        return m_rec.dropped();
+    }
+
+    /*************************
+     *  Dynamic resolution   *
+     *************************/
+    bool Graphics::dynamicResolution(bool enable)
+    {
+        if(enable == m_dynres)
+            return true;
+        if(m_inscene) {
+            core::logger::logm("Can't change the dynamic resolution state while drawing the scene.", core::logger::WARNING);
+            return false;
+        }
+
+        acquire();
+        if(!enable)
+            m_scaler.free();
+        else if(m_win && !m_scaler.init(windowWidth(), windowHeight()))
+            return false;
+        m_dynres = enable;
+        return true;
+    }
+
+    bool Graphics::dynamicResolution() const
+    {
+        return m_dynres;
+    }
+
+    void Graphics::resolutionBounds(float min, float max)
+    {
+        m_scaler.bounds(min, max);
+    }
+
+    void Graphics::resolutionTarget(float ms)
+    {
+        m_scaler.target(ms);
+    }
+
+    float Graphics::resolutionScale() const
+    {
+        return m_dynres ? m_scaler.scale() : 1.0f;
+    }
+
+    void Graphics::beginScene()
+    {
+        if(!m_dynres || !m_indraw || m_inscene)
+            return;
+        m_inscene = true;
+
+        if(m_threaded)
+            m_lists[m_list].call(&Graphics::sceneBegin, this);
+        else
+            sceneBegin(this);
+    }
+
+    void Graphics::endScene()
+    {
+        if(!m_inscene)
+            return;
+        m_inscene = false;
+
+        if(m_threaded)
+            m_lists[m_list].call(&Graphics::sceneEnd, this);
+        else
+            sceneEnd(this);
+    }
+
+    void Graphics::sceneBegin(void* data)
+    {
+        Graphics* gfx = static_cast<Graphics*>(data);
+        gfx->m_scaler.begin();
+    }
+
+    void Graphics::sceneEnd(void* data)
+    {
+        Graphics* gfx = static_cast<Graphics*>(data);
+        gfx->m_scaler.end(&gfx->m_shads);
+    }
+
+    /*************************
+     *     Render thread     *
+     *************************/
+    bool Graphics::renderThread(bool enable)
+    {
+        if(enable == m_threaded)
+            return true;
+        if(m_indraw) {
+            core::logger::logm("Can't change the render thread state while drawing.", core::logger::WARNING);
+            return false;
+        }
+
+        if(!enable) {
+            stopThread();
+            m_threaded = false;
+            return true;
+        }
+
+        if(m_win && !startThread())
+            return false;
+        m_threaded = true;
+        return true;
+    }
+
+    bool Graphics::renderThread() const
+    {
+        return m_threaded;
+    }
+
+    unsigned int Graphics::renderSyncs() const
+    {
+        return m_lastSyncs;
+    }
+
+    bool Graphics::startThread()
+    {
+        m_submitted = NULL;
+        m_quit = false;
+        m_mutex = SDL_CreateMutex();
+        m_cond = SDL_CreateCond();
+        if(m_mutex != NULL && m_cond != NULL)
+            m_thread = SDL_CreateThread(&Graphics::render, "render", this);
+
+        if(m_thread == NULL) {
+            std::ostringstream oss;
+            oss << "Couldn't create the render thread, drawing in the main thread : " << SDL_GetError();
+            core::logger::logm(oss.str(), core::logger::WARNING);
+            if(m_cond != NULL)
+                SDL_DestroyCond(m_cond);
+            if(m_mutex != NULL)
+                SDL_DestroyMutex(m_mutex);
+            m_cond = NULL;
+            m_mutex = NULL;
+            return false;
+        }
+
+        core::logger::logm("Drawing in the render thread.", core::logger::MSG);
+        return true;
+    }
+
+    void Graphics::stopThread()
+    {
+        if(m_thread == NULL)
+            return;
+
+        waitIdle();
+        SDL_LockMutex(m_mutex);
+        m_quit = true;
+        SDL_CondBroadcast(m_cond);
+        SDL_UnlockMutex(m_mutex);
+        SDL_WaitThread(m_thread, NULL);
+        SDL_DestroyCond(m_cond);
+        SDL_DestroyMutex(m_mutex);
+        m_thread = NULL;
+        m_cond = NULL;
+        m_mutex = NULL;
+
+        /* The main thread takes back the context, with an up to date repere. */
+        if(!m_owner) {
+            SDL_GL_MakeCurrent(m_win, m_ctx);
+            m_owner = true;
+        }
+        loadRepere();
+    }
+
+    void Graphics::acquire()
+    {
+        if(!m_threaded)
+            return;
+
+        if(m_thread != NULL && !m_owner) {
+            waitIdle();
+            SDL_GL_MakeCurrent(m_win, m_ctx);
+            m_owner = true;
+        }
+
+        /* The commands already recorded must be drawn before any direct call. */
+        if(m_indraw) {
+            ++m_syncs;
+            m_lists[m_list].execute(&m_shads);
+            m_lists[m_list].reset();
+            /* The rest of the list starts with the default width, which execute restores after the primitives. */
+            m_lists[m_list].width(m_lineWidth);
+            loadRepere();
+        }
+    }
+
+    void Graphics::waitIdle()
+    {
+        SDL_LockMutex(m_mutex);
+        while(m_submitted != NULL)
+            SDL_CondWait(m_cond, m_mutex);
+        SDL_UnlockMutex(m_mutex);
+    }
+
+    void Graphics::submit()
+    {
+        if(m_thread == NULL) {
+            /* The render thread couldn't be started : drawing here. */
+            m_lists[m_list].execute(&m_shads);
+            m_lists[m_list].reset();
+            m_rec.capture();
+            glFlush();
+            SDL_GL_SwapWindow(m_win);
+            return;
+        }
+
+        if(m_owner) {
+            SDL_GL_MakeCurrent(m_win, NULL);
+            m_owner = false;
+        }
+
+        /* Only one frame is submitted at a time. */
+        waitIdle();
+        SDL_LockMutex(m_mutex);
+        m_submitted = &m_lists[m_list];
+        SDL_CondBroadcast(m_cond);
+        SDL_UnlockMutex(m_mutex);
+
+        m_list = 1 - m_list;
+        m_lists[m_list].reset();
+    }
+
+    int Graphics::render(void* data)
+    {
+        Graphics* gfx = static_cast<Graphics*>(data);
+
+        SDL_LockMutex(gfx->m_mutex);
+        while(true) {
+            while(gfx->m_submitted == NULL && !gfx->m_quit)
+                SDL_CondWait(gfx->m_cond, gfx->m_mutex);
+            if(gfx->m_submitted == NULL)
+                break;
+            internal::CommandList* list = gfx->m_submitted;
+            SDL_UnlockMutex(gfx->m_mutex);
+
+            SDL_GL_MakeCurrent(gfx->m_win, gfx->m_ctx);
+            list->execute(&gfx->m_shads);
+            gfx->m_rec.capture();
+            glFlush();
+            SDL_GL_SwapWindow(gfx->m_win);
+            SDL_GL_MakeCurrent(gfx->m_win, NULL);
+
+            SDL_LockMutex(gfx->m_mutex);
+            gfx->m_submitted = NULL;
+            SDL_CondBroadcast(gfx->m_cond);
+        }
+        SDL_UnlockMutex(gfx->m_mutex);
+
+        return 0;
+    }
+
+    void Graphics::record(GLuint texture, float x, float y, float w, float h,
+            float u0, float v0, float u1, float v1, const Color& col)
+    {
+        const float m[] = {m_repere.a, m_repere.b, m_repere.c, m_repere.d, m_repere.x0, m_repere.y0};
+        const GLubyte rgba[] = {col.r, col.g, col.b, col.a};
+        m_lists[m_list].quad(m, texture, x, y, w, h, u0, v0, u1, v1, rgba);
+    }
+
+    void Graphics::drawArray(GLenum mode, const std::vector<Vertex>& vertices, float width)
+    {
+        m_prim.clear();
+        for(const Vertex& v : vertices)
+            vertex(v.x, v.y, 0.0f, 0.0f, v.col);
+        primitive(mode, 0, width);
+    }
+
+    void Graphics::vertex(float x, float y, float u, float v, const Color& col)
+    {
+        internal::CommandList::Vertex vert = {x, y, u, v, col.r, col.g, col.b, col.a};
+        m_prim.push_back(vert);
+    }
+
+    void Graphics::primitive(GLenum mode, GLuint texture, float width)
+    {
+        if(m_prim.empty())
+            return;
+
+        if(m_threaded && m_indraw) {
+            const float m[] = {m_repere.a, m_repere.b, m_repere.c, m_repere.d, m_repere.x0, m_repere.y0};
+            m_lists[m_list].primitive(m, mode, texture, &m_prim[0], m_prim.size(), width);
+            return;
+        }
+
+        acquire();
+        m_shads.text(texture != 0);
+        if(texture != 0)
+            glBindTexture(GL_TEXTURE_2D, texture);
+        if(width >= 0.0f) {
+            glPointSize(width);
+            glLineWidth(width);
+        }
+        internal::CommandList::draw(mode, &m_prim[0], m_prim.size());
+        if(width >= 0.0f) {
+            glPointSize(m_lineWidth);
+            glLineWidth(m_lineWidth);
+        }
+    }
+
+    void Graphics::drawTiled(internal::TiledTexture* tiled, const geometry::Point& ori, float w, float h, bool flip,
+            float repeatX, float repeatY)
+    {
+        if(tiled->width() == 0 || tiled->height() == 0 || repeatX <= 0.0f || repeatY <= 0.0f)
+            return;
+        float tw = (float)tiled->width();
+        float th = (float)tiled->height();
+        /* The picture is copied repeatX*repeatY times in the rect, the last copies being cut as with GL_REPEAT. */
+        float cw = w / repeatX;
+        float ch = h / repeatY;
+        float sx = cw / tw;
+        float sy = ch / th;
+        int nx = (int)std::ceil(repeatX);
+        int ny = (int)std::ceil(repeatY);
+
+        /* The part of the picture visible in any copy, in pixels of the picture. */
+        std::pair<geometry::AABB,geometry::Point> vis = visibleRect();
+        float px0 = tw, py0 = th, px1 = 0.0f, py1 = 0.0f;
+        for(int j = 0; j < ny; ++j) {
+            for(int i = 0; i < nx; ++i) {
+                float lx0, ly0, lx1, ly1;
+                geometry::Point co = tiledCopy(ori, w, h, cw, ch, i, j, &lx0, &ly0, &lx1, &ly1);
+                if(m_indraw && !isVisible(geometry::Point(co.x + lx0, co.y + ly0), geometry::AABB(lx1 - lx0, ly1 - ly0)))
+                    continue;
+                float x0 = std::max(lx0, vis.second.x - co.x) / sx;
+                float x1 = std::min(lx1, vis.second.x + vis.first.width - co.x) / sx;
+                float y0 = std::max(ly0, vis.second.y - co.y) / sy;
+                float y1 = std::min(ly1, vis.second.y + vis.first.height - co.y) / sy;
+                if(flip) {
+                    std::swap(x0, x1);
+                    x0 = tw - x0;
+                    x1 = tw - x1;
+                }
+                if(m_yinvert) {
+                    std::swap(y0, y1);
+                    y0 = th - y0;
+                    y1 = th - y1;
+                }
+                px0 = std::min(px0, x0);
+                py0 = std::min(py0, y0);
+                px1 = std::max(px1, x1);
+                py1 = std::max(py1, y1);
+            }
+        }
+        if(px1 <= px0 || py1 <= py0)
+            return;
+
+        /* Choosing the tiles doesn't need the context : the textures are updated before the quads are drawn.
+         * The render thread syncs a copy of the tiles chosen, as the next stream may change them while it draws. */
+        tiled->stream(px0, py0, px1 - px0, py1 - py0, m_frames);
+        if(m_threaded && m_indraw) {
+            TiledSync* sync = new TiledSync;
+            sync->tiled = tiled;
+            tiled->snapshot(&sync->wanted);
+            m_lists[m_list].call(&Graphics::tiledSync, sync);
+        }
+        else {
+            acquire();
+            tiled->sync();
+        }
+
+        const float m[] = {m_repere.a, m_repere.b, m_repere.c, m_repere.d, m_repere.x0, m_repere.y0};
+        const GLubyte white[] = {255, 255, 255, 255};
+        const std::vector<internal::TiledTexture::Tile>& tiles = tiled->tiles();
+        float u0 = (flip ? 1.0f : 0.0f);
+        float v0 = (m_yinvert ? 1.0f : 0.0f);
+        float du = 1.0f - 2.0f * u0;
+        float dv = 1.0f - 2.0f * v0;
+        for(int j = 0; j < ny; ++j) {
+            for(int i = 0; i < nx; ++i) {
+                float lx0, ly0, lx1, ly1;
+                geometry::Point co = tiledCopy(ori, w, h, cw, ch, i, j, &lx0, &ly0, &lx1, &ly1);
+                if(cull(geometry::Point(co.x + lx0, co.y + ly0), lx1 - lx0, ly1 - ly0))
+                    continue;
+
+                for(const internal::TiledTexture::Tile& t : tiles) {
+                    if(t.used != m_frames)
+                        continue;
+                    float x = (flip ? tw - (float)(t.x + t.w) : (float)t.x);
+                    float y = (m_yinvert ? th - (float)(t.y + t.h) : (float)t.y);
+                    float qx = x * sx;
+                    float qy = y * sy;
+                    float qw = (float)t.w * sx;
+                    float qh = (float)t.h * sy;
+
+                    /* Cutting the quad to the part of the copy inside the rect. */
+                    float cx0 = std::max(qx, lx0);
+                    float cy0 = std::max(qy, ly0);
+                    float cx1 = std::min(qx + qw, lx1);
+                    float cy1 = std::min(qy + qh, ly1);
+                    if(cx1 <= cx0 || cy1 <= cy0)
+                        continue;
+                    float tu0 = u0 + du * (cx0 - qx) / qw;
+                    float tu1 = u0 + du * (cx1 - qx) / qw;
+                    float tv0 = v0 + dv * (cy0 - qy) / qh;
+                    float tv1 = v0 + dv * (cy1 - qy) / qh;
+
+                    if(m_threaded && m_indraw) {
+                        m_lists[m_list].quad(m, &t.id, co.x + cx0, co.y + cy0, cx1 - cx0, cy1 - cy0, tu0, tv0, tu1, tv1, white);
+                        continue;
+                    }
+                    m_shads.text(true);
+                    glBindTexture(GL_TEXTURE_2D, t.id);
+                    glColor4ub(255, 255, 255, 255);
+                    glBegin(GL_QUADS);
+                    glTexCoord2f(tu0, tv0); glVertex2f(co.x + cx0, co.y + cy0);
+                    glTexCoord2f(tu1, tv0); glVertex2f(co.x + cx1, co.y + cy0);
+                    glTexCoord2f(tu1, tv1); glVertex2f(co.x + cx1, co.y + cy1);
+                    glTexCoord2f(tu0, tv1); glVertex2f(co.x + cx0, co.y + cy1);
+                    glEnd();
+                }
+            }
+        }
+    }
+
+    geometry::Point Graphics::tiledCopy(const geometry::Point& ori, float w, float h, float cw, float ch, int i, int j,
+            float* x0, float* y0, float* x1, float* y1) const
+    {
+        /* As the texture coordinates, the copies start at the bottom when the y axis goes up. */
+        geometry::Point co(ori.x + (float)i * cw, ori.y + (float)j * ch);
+        if(m_yinvert)
+            co.y = ori.y + h - (float)(j + 1) * ch;
+        *x0 = std::max(0.0f, ori.x - co.x);
+        *y0 = std::max(0.0f, ori.y - co.y);
+        *x1 = std::min(cw, ori.x + w - co.x);
+        *y1 = std::min(ch, ori.y + h - co.y);
+        return co;
+    }
+
+    void Graphics::tiledSync(void* data)
+    {
+        TiledSync* sync = static_cast<TiledSync*>(data);
+        sync->tiled->sync(sync->wanted);
+        delete sync;
+    }
+
+    void Graphics::loadRepere()
+    {
+        const GLfloat m[] = {
+            m_repere.a,  m_repere.b,  0.0f, 0.0f,
+            m_repere.c,  m_repere.d,  0.0f, 0.0f,
+            0.0f,        0.0f,        1.0f, 0.0f,
+            m_repere.x0, m_repere.y0, 0.0f, 1.0f
+        };
+        glMatrixMode(GL_MODELVIEW);
+        glLoadMatrixf(m);
     }
 
 }
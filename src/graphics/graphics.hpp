@@ -14,6 +14,12 @@
 #include "graphics/texture.hpp"
 #include "graphics/movie.hpp"
 #include "graphics/font.hpp"
+#include "graphics/particles.hpp"
+#include "graphics/recorder.hpp"
+#include "graphics/commands.hpp"
+#include "graphics/scaler.hpp"
+#include "graphics/tiled.hpp"
+#include "graphics/vertex.hpp"
 #include "graphics/exts.hpp"
 #include "graphics/color.hpp"
 
@@ -122,6 +128,8 @@ namespace graphics
                 TEXT,  /**< @brief The ressource is a texture. */
                 MOVIE, /**< @brief The ressource is a movie. */
                 FONT,  /**< @brief The ressource is a font. */
+                PARTS, /**< @brief The ressource is a particle system. */
+                TILED, /**< @brief The ressource is a texture split in tiles, used as a texture. */
                 NONE   /**< @brief The ressource doesn't exists or is invalid. */
             };
 
@@ -129,10 +137,14 @@ namespace graphics
              * @brief All ressources are renferenced by a name, used to acces them.
              * @{
              */
-            /** @brief Load a texture from a file. */
+            /** @brief Load a texture from a file. If the picture is bigger than the maximum texture size, it is tiled. */
             bool loadTexture(const std::string& name, const std::string& path);
+            /** @brief Load a texture from a file, split in tiles of size tile*tile uploaded only when visible.
+             * It can be used as any texture, except that it can't be repeated, and hides huge pictures memory usage to the GPU.
+             */
+            bool loadTiledTexture(const std::string& name, const std::string& path, int tile = 512);
             /** @brief Load a movie from a file. */
-            bool loadMovie(const std::string& name, const std::string& path);
+            bool loadMovie(const std::string& name, const std::string& path, bool cache = false);
             /** @brief Load a font from a file. */
             bool loadFont(const std::string& name, const std::string& path);
             /** @brief Load a texture from a rendered text.
@@ -166,6 +178,8 @@ namespace graphics
             bool setTextureHotpoint(const std::string& name, int x, int y);
             /** @brief Get the hotpoint of a texture. */
             geometry::Point getTextureHotPoint(const std::string& name) const;
+            /** @brief Returns the number of tiles uploaded of a tiled texture. */
+            size_t residentTiles(const std::string& name) const;
             /** @} */
 
             /*************************
@@ -194,6 +208,40 @@ namespace graphics
             void rewindMovie(const std::string& name);
             /** @} */
 
+            /*************************
+             * Particles management  *
+             *************************/
+            /** @name Particles management.
+             * @brief A particle system is a ressource emitting many short-lived copies of a texture.
+             * See internal::Particles for the units used.
+             * @{
+             */
+            /** @brief Creates a particle system able to hold max particles, drawn with texture. */
+            bool createParticles(const std::string& name, const std::string& texture, size_t max);
+            /** @brief Change the texture used by a particle system. */
+            void particlesTexture(const std::string& name, const std::string& texture);
+            /** @brief Sets the position of the emitter, relative to the repere used when drawing. */
+            void particlesPosition(const std::string& name, const geometry::Point& pos);
+            /** @brief Sets the number of particles continuously emitted each second, 0 to disable it. */
+            void particlesRate(const std::string& name, float rate);
+            /** @brief Sets the bounds of the life duration of the particles, in milliseconds. */
+            void particlesLife(const std::string& name, float minl, float maxl);
+            /** @brief Sets the direction (in degres), the cone width (in degres) and the speed bounds of the emission. */
+            void particlesVelocity(const std::string& name, float angle, float spread, float mins, float maxs);
+            /** @brief Sets the acceleration applied to the particles. */
+            void particlesGravity(const std::string& name, float x, float y);
+            /** @brief Sets the color the texture of the particles is modulated with. */
+            void particlesTint(const std::string& name, const Color& col);
+            /** @brief Sets the size factor of the particles over their life. */
+            void particlesSizeCurve(const std::string& name, const std::vector<float>& keys);
+            /** @brief Sets the alpha of the particles over their life. */
+            void particlesAlphaCurve(const std::string& name, const std::vector<float>& keys);
+            /** @brief Spawns count particles at once, returns the number really spawned. */
+            size_t burstParticles(const std::string& name, size_t count);
+            /** @brief Returns the number of living particles of a system. */
+            size_t particlesCount(const std::string& name) const;
+            /** @} */
+
             /*************************
              *    Transformations    *
              *************************/
@@ -216,6 +264,25 @@ namespace graphics
             bool pop();
             /** @} */
 
+            /*************************
+             *        Culling        *
+             *************************/
+            /** @name Culling.
+             * @brief Textured quads (blitTexture and draw(AABB)) completely out of the view are not sent to openGL.
+             * @{
+             */
+            /** @brief Returns the bounding box of the part of the view visible in the actual repere.
+             * @return The size of the box and its minimal corner.
+             */
+            std::pair<geometry::AABB,geometry::Point> visibleRect() const;
+            /** @brief Indicates if a rectangle of the actual repere, with its minimal corner at pos, is at least partially visible. */
+            bool isVisible(const geometry::Point& pos, const geometry::AABB& rect) const;
+            /** @brief Returns the number of draws tested during the last frame. */
+            unsigned int cullTested() const;
+            /** @brief Returns the number of draws culled during the last frame. */
+            unsigned int cullCulled() const;
+            /** @} */
+
             /*************************
              *       Drawing         *
              *************************/
@@ -244,10 +311,18 @@ namespace graphics
             void draw(const geometry::Polygon& poly, const Color& col);
             /** @brief Draw a text width the specified font and size. */
             void draw(const std::string& str, const std::string& font, float pts = -1.0f);
+            /** @brief Draw a list of colored triangles, three vertices per triangle, in one call. */
+            void drawTriangles(const std::vector<Vertex>& vertices);
+            /** @brief Draw a list of colored lines, two vertices per line, in one call. */
+            void drawLines(const std::vector<Vertex>& vertices, float width = -1.0f);
             /** @brief Display a playing movie, or start it playing.
              * @return False when the end of the movie was reached : to continue playing, you must call rewindMovie.
              */
             bool play(const std::string& movie, const geometry::AABB& rect, bool ratio = true);
+            /** @brief Update a particle system with the time elapsed since its last drawing, and draw it in one call.
+             * @return The number of particles drawn.
+             */
+            size_t drawParticles(const std::string& name);
             /** @brief Set the default width used when drawing points and lines. */
             float defaultWidth(float nval);
             /** @brief Get the default width. */
@@ -256,6 +331,76 @@ namespace graphics
             void beginDraw();
             /** @brief Send the drawn to the screen : must be called once at the end of the drawing. */
             void endDraw();
+            /** @brief Returns the number of frames sent to the screen since the creation of the instance. */
+            unsigned int frames() const;
+            /** @} */
+
+            /*************************
+             *       Recording       *
+             *************************/
+            /** @name Frames recording.
+             * @brief The frames sent to the screen are written as a sequence of PNG files, without stalling the drawing.
+             * @{
+             */
+            /** @brief Starts recording.
+             * @param prefix The prefix of the path of the files written : it must be in an existing directory.
+             */
+            bool startRecording(const std::string& prefix);
+            /** @brief Stops recording, and logs the number of frames written and dropped. */
+            void stopRecording();
+            /** @brief Indicates if the frames are being recorded. */
+            bool isRecording() const;
+            /** @brief Returns the number of frames dropped since the beggining of the last recording. */
+            unsigned int droppedFrames() const;
+            /** @} */
+
+            /*************************
+             *     Render thread     *
+             *************************/
+            /** @name Render thread.
+             * @brief When enabled, the drawing functions and the transformations are only recorded, and a dedicated
+             * thread owning the openGL context draws the frame after endDraw. The next frame can then be computed while
+             * the last one is drawn.
+             *
+             * The methods needing the context right away take it back in the calling thread, waiting for the last frame
+             * and drawing the commands already recorded first : the loading and freeing of ressources, the recording
+             * and dynamic resolution switches, and play, since the frames of the movies are uploaded when decoded.
+             * A frame playing a movie thus waits for the last one to be drawn : renderSyncs counts these synchronisations.
+             * @{
+             */
+            /** @brief Enables or disables the render thread, can't be called while drawing. */
+            bool renderThread(bool enable);
+            /** @brief Indicates if the render thread is enabled. */
+            bool renderThread() const;
+            /** @brief Returns the number of times the last frame took the context back from the render thread. */
+            unsigned int renderSyncs() const;
+            /** @} */
+
+            /*************************
+             *  Dynamic resolution   *
+             *************************/
+            /** @name Dynamic resolution.
+             * @brief When enabled, what is drawn between beginScene and endScene is rendered at a lower resolution and upscaled
+             * to the window. The scale adapts to the time the GPU takes to draw the scene. What is drawn outside, like the HUD,
+             * keeps the resolution of the window.
+             * @{
+             */
+            /** @brief Enables or disables the dynamic resolution.
+             * @return False if the hardware doesn't support it.
+             */
+            bool dynamicResolution(bool enable);
+            /** @brief Indicates if the dynamic resolution is enabled. */
+            bool dynamicResolution() const;
+            /** @brief Sets the bounds of the scale of the resolution, at most 1. */
+            void resolutionBounds(float min, float max);
+            /** @brief Sets the GPU time targeted to draw the scene, in milliseconds. */
+            void resolutionTarget(float ms);
+            /** @brief Returns the actual scale of the resolution. */
+            float resolutionScale() const;
+            /** @brief Begins drawing the scene, must be called between beginDraw and endDraw. */
+            void beginScene();
+            /** @brief Ends drawing the scene and upscales it to the window. Automatically called by endDraw if needed. */
+            void endScene();
             /** @} */
 
         private:
@@ -275,6 +420,36 @@ namespace graphics
             bool m_indraw;               /**< @brief Indicates if the class is in drawong mode. */
             /* Drawing */
             float m_lineWidth;           /**< @brief The width of lines used when drawing. */
+            unsigned int m_frames;       /**< @brief The number of frames drawn. */
+            internal::Recorder m_rec;    /**< @brief Used to record the frames drawn. */
+            /* Culling */
+            /** @brief The modelview matrix, mirrored on the CPU : x' = a*x + c*y + x0, y' = b*x + d*y + y0. */
+            struct Repere {
+                float a, b, c, d, x0, y0;
+            };
+            Repere m_repere;                /**< @brief The actual repere. */
+            std::vector<Repere> m_reperes;  /**< @brief The reperes stored by push. */
+            unsigned int m_tested;          /**< @brief The number of draws tested in the actual frame. */
+            unsigned int m_culled;          /**< @brief The number of draws culled in the actual frame. */
+            unsigned int m_lastTested;      /**< @brief The number of draws tested in the last frame. */
+            unsigned int m_lastCulled;      /**< @brief The number of draws culled in the last frame. */
+            /* Render thread */
+            bool m_threaded;                    /**< @brief Is the render thread enabled. */
+            internal::CommandList m_lists[2];   /**< @brief The commands of the frame being recorded and of the frame being drawn. */
+            unsigned int m_list;                /**< @brief The index of the list being recorded. */
+            bool m_owner;                       /**< @brief Is the openGL context current in the main thread. */
+            SDL_Thread* m_thread;               /**< @brief The render thread. */
+            SDL_mutex* m_mutex;                 /**< @brief Protects m_submitted and m_quit. */
+            SDL_cond* m_cond;                   /**< @brief Signals a change of m_submitted or m_quit. */
+            internal::CommandList* m_submitted; /**< @brief The list the render thread must draw, NULL when it's idle. */
+            bool m_quit;                        /**< @brief Must the render thread stop. */
+            unsigned int m_syncs;               /**< @brief The number of synchronisations in the actual frame. */
+            unsigned int m_lastSyncs;           /**< @brief The number of synchronisations in the last frame. */
+            std::vector<internal::CommandList::Vertex> m_prim; /**< @brief The vertices of the primitive being drawn. */
+            /* Dynamic resolution */
+            internal::Scaler m_scaler;   /**< @brief Manages the offscreen target of the scene. */
+            bool m_dynres;               /**< @brief Is the dynamic resolution enabled. */
+            bool m_inscene;              /**< @brief Is the scene being drawn. */
 
             /**************************
              *   Fake-FS structure    *
@@ -291,6 +466,8 @@ namespace graphics
                     internal::Texture* text; /**< @brief Used if the ressource is a texture. */
                     internal::Movie* movie;  /**< @brief Used if the ressource is a movie. */
                     internal::Font* font;    /**< @brief Used if the ressource is a font. */
+                    internal::Particles* parts; /**< @brief Used if the ressource is a particle system. */
+                    internal::TiledTexture* tiled; /**< @brief Used if the ressource is a tiled texture. */
                 };
                 Stored stored; /**< @brief The value stored of the ressource. */
                 RcType type;   /**< @brief The type of the value stored. */
@@ -322,6 +499,62 @@ namespace graphics
             void computeBands();
             /** @brief Log the actual virtual size state. */
             void logVirtual();
+            /** @brief Returns the particle system name, or NULL (with a warning) if it doesn't exists. */
+            internal::Particles* getParticles(const std::string& name) const;
+            /** @brief Tests a textured quad against the view and updates the culling statistics.
+             * @return True if the quad must not be drawn.
+             */
+            bool cull(const geometry::Point& pos, float w, float h);
+            /** @brief Starts the render thread. */
+            bool startThread();
+            /** @brief Stops the render thread, giving the openGL context back to the main thread. */
+            void stopThread();
+            /** @brief Makes the openGL context current in the main thread and draws the recorded commands.
+             * Must be called before any direct openGL call.
+             */
+            void acquire();
+            /** @brief Waits for the render thread to finish drawing the last frame. */
+            void waitIdle();
+            /** @brief Sends the recorded frame to the render thread. */
+            void submit();
+            /** @brief The function executed by the render thread. */
+            static int render(void* data);
+            /** @brief Records a quad with the actual repere. */
+            void record(GLuint texture, float x, float y, float w, float h,
+                    float u0, float v0, float u1, float v1, const Color& col);
+            /** @brief Loads a picture as a texture, or as a tiled texture with tiles of size tile if tile is not 0. */
+            bool loadPicture(const std::string& name, const std::string& path, int tile);
+            /** @brief Draws an array of vertices in one call, width being the size of the points and lines or negative. */
+            void drawArray(GLenum mode, const std::vector<Vertex>& vertices, float width);
+            /** @brief Appends a vertex to the primitive being drawn. */
+            void vertex(float x, float y, float u, float v, const Color& col);
+            /** @brief Draws the primitive built with vertex, or records it when the render thread is used.
+             * @param mode The openGL primitive.
+             * @param texture The openGL texture used, 0 for none.
+             * @param width The size of the points and lines, negative to keep the default one.
+             */
+            void primitive(GLenum mode, GLuint texture, float width = -1.0f);
+            /** @brief Draws a tiled texture repeated repeatX*repeatY times in the rect of size w*h at ori, streaming its tiles. */
+            void drawTiled(internal::TiledTexture* tiled, const geometry::Point& ori, float w, float h, bool flip,
+                    float repeatX = 1.0f, float repeatY = 1.0f);
+            /** @brief Returns the position of the copy (i,j) of size cw*ch of a tiled texture drawn in the rect of size w*h at ori.
+             * The part of the copy inside the rect, relative to its position, is stored in x0, y0, x1 and y1.
+             */
+            geometry::Point tiledCopy(const geometry::Point& ori, float w, float h, float cw, float ch, int i, int j,
+                    float* x0, float* y0, float* x1, float* y1) const;
+            /** @brief The tiles of a tiled texture to sync, recorded for the render thread. */
+            struct TiledSync {
+                internal::TiledTexture* tiled;      /**< @brief The tiled texture. */
+                std::vector<unsigned char> wanted;  /**< @brief The snapshot of the tiles wanted. */
+            };
+            /** @brief Uploads the tiles chosen for a tiled texture : data is a TiledSync, deleted once done. */
+            static void tiledSync(void* data);
+            /** @brief Loads the actual repere in the openGL modelview matrix. */
+            void loadRepere();
+            /** @brief Redirects the drawing to the offscreen target : data is the Graphics instance. */
+            static void sceneBegin(void* data);
+            /** @brief Upscales the offscreen target to the window : data is the Graphics instance. */
+            static void sceneEnd(void* data);
     };
 }
 
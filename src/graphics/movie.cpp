@@ -16,12 +16,15 @@ namespace graphics
         const int movieWidth = 512;
         /** @brief The internally used height of the movie. */
         const int movieHeight = 256;
+        /** @brief The maximum number of frames cached : about 50MB of textures. */
+        const size_t maxCached = 128;
 
         Movie::Movie(Shaders* s)
             : m_playing(false), m_speed(1.0f), m_ltime(0), m_stime(0), m_s(s),
             m_begin(true), m_sbytes(0),
             m_ctx(NULL), m_codecCtx(NULL), m_codec(NULL), m_frame(NULL), m_video(-1),
-            m_text(s->exts()), m_swsCtx(NULL), m_first(true)
+            m_text(s->exts()), m_swsCtx(NULL), m_first(true),
+            m_cache(false), m_cached(false), m_current(0)
         {
             m_rgb.data[0] = NULL;
             m_packet.data = NULL;
@@ -40,6 +43,7 @@ namespace graphics
             if(m_swsCtx != NULL)
                 sws_freeContext(m_swsCtx);
             clean();
+            uncache();
         }
                 
         void Movie::clean()
@@ -49,7 +53,38 @@ namespace graphics
             m_packet.data = NULL;
         }
 
-        bool Movie::load(const std::string& path)
+        void Movie::uncache()
+        {
+            if(!m_frames.empty())
+                glDeleteTextures((GLsizei)m_frames.size(), &m_frames[0]);
+            m_frames.clear();
+            m_cache = m_cached = false;
+            m_current = 0;
+        }
+
+        GLuint Movie::target()
+        {
+            if(!m_cache)
+                return m_text.glID();
+
+            if(m_frames.size() >= maxCached) {
+                core::logger::logm("Movie too long to be cached, it will be decoded at each playing.", core::logger::MSG);
+                uncache();
+                return m_text.glID();
+            }
+
+            GLuint text;
+            glGenTextures(1, &text);
+            glBindTexture(GL_TEXTURE_2D, text);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, movieWidth, movieHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+            m_frames.push_back(text);
+            m_current = m_frames.size() - 1;
+            return text;
+        }
+
+        bool Movie::load(const std::string& path, bool cache)
         {
             /* Load the file */
             if(avformat_open_input(&m_ctx, path.c_str(), NULL, NULL) != 0) {
@@ -117,9 +152,21 @@ namespace graphics
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
+            /* Short movies are cached automatically */
+            AVStream* stream = m_ctx->streams[m_video];
+            int64_t nb = stream->nb_frames;
+            if(nb <= 0 && stream->duration != (int64_t)AV_NOPTS_VALUE && stream->avg_frame_rate.den != 0)
+                nb = (int64_t)(av_q2d(stream->time_base) * (double)stream->duration * av_q2d(stream->avg_frame_rate));
+            m_cache = cache || (nb > 0 && nb <= (int64_t)maxCached);
+
             return true;
         }
 
+        bool Movie::cached() const
+        {
+            return m_cached;
+        }
+
         void Movie::displayFrame(const geometry::AABB& rect, bool r, bool invert) const
         {
             /* Compute the size */
@@ -146,7 +193,10 @@ namespace graphics
 
             /* Draw the frame */
             m_s->text(true);
-            glBindTexture(GL_TEXTURE_2D, m_text.glID());
+            if(m_cache && !m_frames.empty())
+                glBindTexture(GL_TEXTURE_2D, m_frames[m_current]);
+            else
+                glBindTexture(GL_TEXTURE_2D, m_text.glID());
             glTranslatef(dec.x, dec.y, 0.0f);
             glBegin(GL_QUADS);
             if(invert) {
@@ -170,6 +220,19 @@ namespace graphics
             int bytesDecoded;
             int frameFinished;
 
+            /* All the frames are already in textures */
+            if(m_cached) {
+                if(m_begin) {
+                    m_begin = false;
+                    m_current = 0;
+                    return true;
+                }
+                if(m_current + 1 >= m_frames.size())
+                    return false;
+                ++m_current;
+                return true;
+            }
+
             if(m_begin) {
                 clean();
                 m_begin = false;
@@ -214,6 +277,8 @@ loop_exit:
 
             if(frameFinished == 0) {
                 core::logger::logm("Couldn't decode the next video frame, may be the end of the video.", core::logger::MSG);
+                if(m_cache && !m_frames.empty())
+                    m_cached = true;
                 return false;
             }
 
@@ -232,9 +297,10 @@ to_rgb:
 
             /* Sending it to openGL texture */
             glEnable(GL_TEXTURE_2D);
-            glBindTexture(GL_TEXTURE_2D, m_text.glID());
+            GLuint text = target();
+            glBindTexture(GL_TEXTURE_2D, text);
 
-            if(m_first) {
+            if(m_first && text == m_text.glID()) {
                 glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, movieWidth, movieHeight, 0,
                         GL_RGB, GL_UNSIGNED_BYTE, m_frame->data[0]);
                 m_first = false;
@@ -273,6 +339,13 @@ to_rgb:
         void Movie::replay()
         {
             m_begin = true;
+            if(m_cached)
+                return;
+            /* The partial cache is restarted, or the frames would be cached twice */
+            if(m_cache) {
+                uncache();
+                m_cache = true;
+            }
             av_seek_frame(m_ctx, m_video, 0, AVSEEK_FLAG_ANY);
         }
 
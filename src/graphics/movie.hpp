@@ -3,6 +3,7 @@
 #define DEF_GRAPHICS_MOVIE
 
 #include <string>
+#include <vector>
 #include <SDL.h>
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -25,8 +26,13 @@ namespace graphics
                 Movie() = delete;
                 Movie(const Movie&) = delete;
                 ~Movie();
-                /** @brief Loads the movie from a file. */
-                bool load(const std::string& path);
+                /** @brief Loads the movie from a file.
+                 * @param cache If true, the frames are kept in textures during the first playing, so the next ones
+                 * don't decode anything. Short movies are cached even if false.
+                 */
+                bool load(const std::string& path, bool cache = false);
+                /** @brief Indicates if all the frames are cached. */
+                bool cached() const;
 
                 /** @brief Init libavcodec. */
                 static void init();
@@ -75,8 +81,17 @@ namespace graphics
                 SwsContext* m_swsCtx; /**< @brief Used for the convertion from the frame to the picture. */
                 bool m_first;         /**< @brief Indicates if the openGL texture must be created. */
 
+                /* Frames cache */
+                bool m_cache;                /**< @brief Are the frames being cached. */
+                bool m_cached;               /**< @brief Are all the frames cached. */
+                std::vector<GLuint> m_frames;/**< @brief The textures of the cached frames. */
+                size_t m_current;            /**< @brief The index of the actual cached frame. */
+
                 /* Internal methods */
                 void clean(); /**< @brief Cleans the packet, freing its contents. */
+                void uncache(); /**< @brief Frees the cached frames, and stops caching. */
+                /** @brief Returns the texture to upload a decoded frame to. */
+                GLuint target();
         };
     }
 }
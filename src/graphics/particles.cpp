@@ -0,0 +1,283 @@
+
+#include "graphics/particles.hpp"
+#include <SDL.h>
+#include <cmath>
+
+namespace graphics
+{
+    namespace internal
+    {
+        /** @brief Used to convert degres in radians. */
+        const float pdeg2rad = 0.0174532925199433f;
+
+        Particles::Particles(size_t max)
+            : m_max(max), m_count(0), m_built(0), m_pos(0.0f, 0.0f),
+            m_rate(0.0f), m_accum(0.0f), m_minLife(1000.0f), m_maxLife(1000.0f),
+            m_angle(0.0f), m_spread(2.0f * 3.14159265f), m_minSpeed(0.0f), m_maxSpeed(0.0f),
+            m_gx(0.0f), m_gy(0.0f), m_tint(255, 255, 255), m_seed(0x9E3779B9), m_ltime(0)
+        {
+            m_x.resize(m_max);
+            m_y.resize(m_max);
+            m_vx.resize(m_max);
+            m_vy.resize(m_max);
+            m_age.resize(m_max);
+            m_inv.resize(m_max);
+            m_vertices.reserve(m_max * 4);
+        }
+
+        Particles::~Particles()
+        {}
+
+        /*************************
+         *  Emission parameters  *
+         *************************/
+        void Particles::position(const geometry::Point& pos)
+        {
+            m_pos = pos;
+        }
+
+        geometry::Point Particles::position() const
+        {
+            return m_pos;
+        }
+
+        void Particles::rate(float r)
+        {
+            m_rate = (r > 0.0f ? r : 0.0f);
+            if(m_rate == 0.0f)
+                m_accum = 0.0f;
+        }
+
+        float Particles::rate() const
+        {
+            return m_rate;
+        }
+
+        void Particles::life(float minl, float maxl)
+        {
+            if(minl < 1.0f)
+                minl = 1.0f;
+            if(maxl < minl)
+                maxl = minl;
+            m_minLife = minl;
+            m_maxLife = maxl;
+        }
+
+        void Particles::velocity(float angle, float spread, float mins, float maxs)
+        {
+            m_angle = angle * pdeg2rad;
+            m_spread = spread * pdeg2rad;
+            m_minSpeed = mins;
+            m_maxSpeed = (maxs < mins ? mins : maxs);
+        }
+
+        void Particles::gravity(float x, float y)
+        {
+            m_gx = x;
+            m_gy = y;
+        }
+
+        void Particles::texture(const std::string& name)
+        {
+            m_texture = name;
+        }
+
+        std::string Particles::texture() const
+        {
+            return m_texture;
+        }
+
+        void Particles::tint(const Color& col)
+        {
+            m_tint = col;
+        }
+
+        void Particles::sizeCurve(const std::vector<float>& keys)
+        {
+            m_size = keys;
+        }
+
+        void Particles::alphaCurve(const std::vector<float>& keys)
+        {
+            m_alpha = keys;
+        }
+
+        /*************************
+         *       Simulation      *
+         *************************/
+        size_t Particles::burst(size_t count)
+        {
+            if(count > m_max - m_count)
+                count = m_max - m_count;
+
+            for(size_t i = m_count; i < m_count + count; ++i) {
+                float angle = m_angle + (random() - 0.5f) * m_spread;
+                float speed = m_minSpeed + random() * (m_maxSpeed - m_minSpeed);
+                m_x[i]   = m_pos.x;
+                m_y[i]   = m_pos.y;
+                m_vx[i]  = std::cos(angle) * speed;
+                m_vy[i]  = std::sin(angle) * speed;
+                m_age[i] = 0.0f;
+                m_inv[i] = 1.0f / (m_minLife + random() * (m_maxLife - m_minLife));
+            }
+
+            m_count += count;
+            return count;
+        }
+
+        void Particles::update(float ms)
+        {
+            if(ms <= 0.0f)
+                return;
+            float dt = ms / 1000.0f;
+            float gx = m_gx * dt;
+            float gy = m_gy * dt;
+
+            /* Each loop only touches contiguous arrays, so it can be vectorized. */
+            float* __restrict__ vx = m_vx.data();
+            float* __restrict__ vy = m_vy.data();
+            float* __restrict__ x  = m_x.data();
+            float* __restrict__ y  = m_y.data();
+            float* __restrict__ age = m_age.data();
+            const float* __restrict__ inv = m_inv.data();
+            const size_t n = m_count;
+            for(size_t i = 0; i < n; ++i) {
+                vx[i] += gx;
+                vy[i] += gy;
+            }
+            for(size_t i = 0; i < n; ++i) {
+                x[i] += vx[i] * dt;
+                y[i] += vy[i] * dt;
+            }
+            for(size_t i = 0; i < n; ++i)
+                age[i] += inv[i] * ms;
+
+            /* Removing dead particles by moving the last ones in their place. */
+            size_t i = 0;
+            while(i < m_count) {
+                if(age[i] >= 1.0f) {
+                    --m_count;
+                    x[i]   = x[m_count];
+                    y[i]   = y[m_count];
+                    vx[i]  = vx[m_count];
+                    vy[i]  = vy[m_count];
+                    age[i] = age[m_count];
+                    m_inv[i] = m_inv[m_count];
+                }
+                else
+                    ++i;
+            }
+
+            /* Continuous emission. */
+            if(m_rate > 0.0f) {
+                m_accum += m_rate * dt;
+                size_t nb = static_cast<size_t>(m_accum);
+                m_accum -= static_cast<float>(nb);
+                burst(nb);
+            }
+        }
+
+        void Particles::updateTime()
+        {
+            Uint32 now = SDL_GetTicks();
+            if(m_ltime != 0)
+                update(static_cast<float>(now - m_ltime));
+            m_ltime = now;
+        }
+
+        void Particles::clear()
+        {
+            m_count = 0;
+            m_accum = 0.0f;
+            m_built = 0;
+        }
+
+        size_t Particles::count() const
+        {
+            return m_count;
+        }
+
+        size_t Particles::max() const
+        {
+            return m_max;
+        }
+
+        geometry::Point Particles::particle(size_t i) const
+        {
+            return geometry::Point(m_x[i], m_y[i]);
+        }
+
+        /*************************
+         *        Drawing        *
+         *************************/
+        void Particles::build(float w, float h, bool invert)
+        {
+            m_vertices.resize(m_count * 4);
+            float vt = invert ? 1.0f : 0.0f;
+            float vb = invert ? 0.0f : 1.0f;
+
+            for(size_t i = 0; i < m_count; ++i) {
+                float s  = eval(m_size, m_age[i]);
+                float hw = w * s / 2.0f;
+                float hh = h * s / 2.0f;
+                float a  = eval(m_alpha, m_age[i]);
+                GLubyte alpha = static_cast<GLubyte>(static_cast<float>(m_tint.a) * (a < 0.0f ? 0.0f : (a > 1.0f ? 1.0f : a)));
+
+                Vertex* v = &m_vertices[i * 4];
+                v[0].x = m_x[i] - hw; v[0].y = m_y[i] - hh; v[0].u = 0.0f; v[0].v = vt;
+                v[1].x = m_x[i] + hw; v[1].y = m_y[i] - hh; v[1].u = 1.0f; v[1].v = vt;
+                v[2].x = m_x[i] + hw; v[2].y = m_y[i] + hh; v[2].u = 1.0f; v[2].v = vb;
+                v[3].x = m_x[i] - hw; v[3].y = m_y[i] + hh; v[3].u = 0.0f; v[3].v = vb;
+                for(int j = 0; j < 4; ++j) {
+                    v[j].r = m_tint.r;
+                    v[j].g = m_tint.g;
+                    v[j].b = m_tint.b;
+                    v[j].a = alpha;
+                }
+            }
+            m_built = m_count;
+        }
+
+        void Particles::submit() const
+        {
+            if(m_built == 0)
+                return;
+            CommandList::draw(GL_QUADS, &m_vertices[0], m_built * 4);
+        }
+
+        void Particles::record(CommandList* list, const float* m, GLuint texture) const
+        {
+            if(m_built == 0)
+                return;
+            list->primitive(m, GL_QUADS, texture, &m_vertices[0], m_built * 4);
+        }
+
+        /*************************
+         *   Internal methods    *
+         *************************/
+        float Particles::random()
+        {
+            /* Xorshift : cheap, and each system has its own sequence. */
+            m_seed ^= m_seed << 13;
+            m_seed ^= m_seed >> 17;
+            m_seed ^= m_seed << 5;
+            return static_cast<float>(m_seed >> 8) / 16777216.0f;
+        }
+
+        float Particles::eval(const std::vector<float>& curve, float t)
+        {
+            if(curve.empty())
+                return 1.0f;
+            else if(curve.size() == 1 || t <= 0.0f)
+                return curve.front();
+            else if(t >= 1.0f)
+                return curve.back();
+
+            float pos = t * static_cast<float>(curve.size() - 1);
+            size_t id = static_cast<size_t>(pos);
+            float f = pos - static_cast<float>(id);
+            return curve[id] + (curve[id + 1] - curve[id]) * f;
+        }
+    }
+}
+
@@ -0,0 +1,152 @@
+
+#ifndef DEF_GRAPHICS_PARTICLES
+#define DEF_GRAPHICS_PARTICLES
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <GL/gl.h>
+#include "geometry/point.hpp"
+#include "graphics/color.hpp"
+#include "graphics/commands.hpp"
+
+namespace graphics
+{
+    namespace internal
+    {
+        /** @brief Manages a set of short-lived textured particles, emitted from a single point.
+         *
+         * The state of the particles is stored as a structure of arrays, so the update loops
+         * only work on contiguous floats and can be vectorized by the compiler. All the
+         * particles are sent to openGL in one vertex array submission.
+         * Times are in milliseconds, speeds in units per second and accelerations in units per second squared.
+         */
+        class Particles
+        {
+            public:
+                /** @brief Creates a particle system able to hold at most max particles. */
+                Particles(size_t max);
+                Particles() = delete;
+                Particles(const Particles&) = delete;
+                ~Particles();
+
+                /** @name Emission parameters.
+                 * @{
+                 */
+                /** @brief Sets the position of the emitter. */
+                void position(const geometry::Point& pos);
+                /** @brief Returns the position of the emitter. */
+                geometry::Point position() const;
+                /** @brief Sets the number of particles continuously emitted each second, 0 to disable. */
+                void rate(float r);
+                /** @brief Returns the continuous emission rate. */
+                float rate() const;
+                /** @brief Sets the bounds of the life duration of a particle. */
+                void life(float minl, float maxl);
+                /** @brief Sets the velocity of the emitted particles.
+                 * @param angle The direction of the emission, in degres.
+                 * @param spread The emission cone width, in degres.
+                 * @param mins The minimum speed.
+                 * @param maxs The maximum speed.
+                 */
+                void velocity(float angle, float spread, float mins, float maxs);
+                /** @brief Sets the acceleration applied to all the particles. */
+                void gravity(float x, float y);
+                /** @brief Sets the name of the texture used to draw the particles. */
+                void texture(const std::string& name);
+                /** @brief Returns the name of the texture used to draw the particles. */
+                std::string texture() const;
+                /** @brief Sets the color the texture is modulated with. */
+                void tint(const Color& col);
+                /** @brief Sets the size curve : keys are evenly spread over the life of a particle and linearly interpolated.
+                 * The size is a factor of the size of the texture. An empty curve is the same as {1}.
+                 */
+                void sizeCurve(const std::vector<float>& keys);
+                /** @brief Sets the alpha curve, with keys between 0 and 1. Works as sizeCurve. */
+                void alphaCurve(const std::vector<float>& keys);
+                /** @} */
+
+                /** @name Simulation.
+                 * @{
+                 */
+                /** @brief Spawns count particles at the emitter position.
+                 * @return The number of particles really spawned (limited by the maximum size).
+                 */
+                size_t burst(size_t count);
+                /** @brief Update all the particles and emit continuously.
+                 * @param ms The time elapsed since the last update.
+                 */
+                void update(float ms);
+                /** @brief Updates using the time elapsed since the last call to this method. */
+                void updateTime();
+                /** @brief Kills all the particles. */
+                void clear();
+                /** @brief Returns the number of living particles. */
+                size_t count() const;
+                /** @brief Returns the maximum number of particles. */
+                size_t max() const;
+                /** @brief Returns the position of the living particle i, which must be lower than count(). */
+                geometry::Point particle(size_t i) const;
+                /** @} */
+
+                /** @name Drawing.
+                 * @{
+                 */
+                /** @brief Fills the vertex array with a quad for each particle.
+                 * @param w The width of the texture used.
+                 * @param h The height of the texture used.
+                 * @param invert If true, the texture is flipped vertically.
+                 */
+                void build(float w, float h, bool invert);
+                /** @brief Draws the vertex array built with the actually bound texture. */
+                void submit() const;
+                /** @brief Records the vertex array built in list, with the transformation m and the texture. */
+                void record(CommandList* list, const float* m, GLuint texture) const;
+                /** @} */
+
+            private:
+                /** @brief A vertex of the array sent to openGL. */
+                typedef CommandList::Vertex Vertex;
+
+                /* Particles data */
+                size_t m_max;             /**< @brief The maximum number of particles. */
+                size_t m_count;           /**< @brief The number of living particles. */
+                std::vector<float> m_x;   /**< @brief The x positions. */
+                std::vector<float> m_y;   /**< @brief The y positions. */
+                std::vector<float> m_vx;  /**< @brief The x velocities. */
+                std::vector<float> m_vy;  /**< @brief The y velocities. */
+                std::vector<float> m_age; /**< @brief The age of the particles, normalized between 0 and 1. */
+                std::vector<float> m_inv; /**< @brief The inverse of the life duration of the particles. */
+                std::vector<Vertex> m_vertices; /**< @brief The vertex array, four vertices per particle. */
+                size_t m_built;           /**< @brief The number of particles in the vertex array. */
+
+                /* Emitter */
+                geometry::Point m_pos;    /**< @brief The position of the emitter. */
+                float m_rate;             /**< @brief The emission rate. */
+                float m_accum;            /**< @brief The fraction of particle not yet emitted. */
+                float m_minLife;          /**< @brief The minimum life. */
+                float m_maxLife;          /**< @brief The maximum life. */
+                float m_angle;            /**< @brief The direction of emission, in radians. */
+                float m_spread;           /**< @brief The width of the emission cone, in radians. */
+                float m_minSpeed;         /**< @brief The minimum speed. */
+                float m_maxSpeed;         /**< @brief The maximum speed. */
+                float m_gx;               /**< @brief The x acceleration. */
+                float m_gy;               /**< @brief The y acceleration. */
+                std::string m_texture;    /**< @brief The name of the texture. */
+                Color m_tint;             /**< @brief The color modulation. */
+                std::vector<float> m_size;  /**< @brief The size curve. */
+                std::vector<float> m_alpha; /**< @brief The alpha curve. */
+                uint32_t m_seed;          /**< @brief The state of the random generator. */
+                uint32_t m_ltime;         /**< @brief The timestamp of the last call to updateTime. */
+
+                /* Internal methods */
+                /** @brief Returns a random number in [0,1). */
+                float random();
+                /** @brief Evaluates a curve at t in [0,1]. */
+                static float eval(const std::vector<float>& curve, float t);
+        };
+    }
+}
+
+#endif
+
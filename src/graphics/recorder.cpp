@@ -0,0 +1,264 @@
+
+#include "graphics/recorder.hpp"
+#include "core/logger.hpp"
+#include <SDL_image.h>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+
+namespace graphics
+{
+    namespace internal
+    {
+        Recorder::Recorder(Extensions* exts)
+            : m_exts(exts), m_rec(false), m_w(0), m_h(0), m_captured(0), m_dropped(0),
+            m_thread(NULL), m_mutex(NULL), m_cond(NULL), m_end(false), m_failed(false)
+        {
+            for(unsigned int i = 0; i < m_nbPbos; ++i)
+                m_pbos[i] = 0;
+        }
+
+        Recorder::~Recorder()
+        {
+            stop();
+            for(size_t i = 0; i < m_pool.size(); ++i)
+                delete m_pool[i];
+        }
+
+        /*************************
+         *   Recording control   *
+         *************************/
+        bool Recorder::start(const std::string& prefix, int w, int h)
+        {
+            if(m_rec)
+                return true;
+            if(w <= 0 || h <= 0)
+                return false;
+            if(!m_exts->has("GL_ARB_pixel_buffer_object")) {
+                core::logger::logm("Hardware does not support GL_ARB_pixel_buffer_object, needed for recording.", core::logger::WARNING);
+                return false;
+            }
+
+            m_prefix = prefix;
+            m_w = w;
+            m_h = h;
+            m_captured = 0;
+            m_dropped = 0;
+            m_end = false;
+            m_failed = false;
+
+            /* The pixel buffer objects, read back by the GPU without blocking the CPU. */
+            glGenBuffers(m_nbPbos, m_pbos);
+            for(unsigned int i = 0; i < m_nbPbos; ++i) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbos[i]);
+                glBufferData(GL_PIXEL_PACK_BUFFER, m_w * m_h * 4, NULL, GL_STREAM_READ);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            /* The frames pool : its size is the maximum length of the queue. */
+            size_t size = static_cast<size_t>(m_w) * static_cast<size_t>(m_h) * 4;
+            while(m_pool.size() < m_maxQueue)
+                m_pool.push_back(new Frame);
+            for(size_t i = 0; i < m_pool.size(); ++i)
+                m_pool[i]->pixels.resize(size);
+
+            /* The worker. */
+            m_mutex = SDL_CreateMutex();
+            m_cond = SDL_CreateCond();
+            if(m_mutex != NULL && m_cond != NULL)
+                m_thread = SDL_CreateThread(&Recorder::work, "recorder", this);
+            if(m_thread == NULL) {
+                std::ostringstream oss;
+                oss << "Couldn't create the recording thread : " << SDL_GetError();
+                core::logger::logm(oss.str(), core::logger::WARNING);
+                if(m_cond != NULL)
+                    SDL_DestroyCond(m_cond);
+                if(m_mutex != NULL)
+                    SDL_DestroyMutex(m_mutex);
+                m_cond = NULL;
+                m_mutex = NULL;
+                glDeleteBuffers(m_nbPbos, m_pbos);
+                return false;
+            }
+
+            m_rec = true;
+            std::ostringstream oss;
+            oss << "Recording frames of size " << m_w << "x" << m_h << " to \"" << m_prefix << "*.png\".";
+            core::logger::logm(oss.str(), core::logger::MSG);
+            return true;
+        }
+
+        void Recorder::stop()
+        {
+            if(!m_rec)
+                return;
+
+            /* Flushing the pixel buffer objects still in use, from the oldest one. */
+            unsigned int pending = (m_captured < m_nbPbos - 1 ? m_captured : m_nbPbos - 1);
+            for(unsigned int id = m_captured - pending; id < m_captured; ++id)
+                readPbo(id % m_nbPbos, id);
+            glDeleteBuffers(m_nbPbos, m_pbos);
+            for(unsigned int i = 0; i < m_nbPbos; ++i)
+                m_pbos[i] = 0;
+
+            /* Waiting for the worker to write the queued frames. */
+            SDL_LockMutex(m_mutex);
+            m_end = true;
+            SDL_CondSignal(m_cond);
+            SDL_UnlockMutex(m_mutex);
+            SDL_WaitThread(m_thread, NULL);
+            SDL_DestroyCond(m_cond);
+            SDL_DestroyMutex(m_mutex);
+            m_thread = NULL;
+            m_cond = NULL;
+            m_mutex = NULL;
+            m_rec = false;
+
+            if(m_failed)
+                core::logger::logm(m_error, core::logger::WARNING);
+            std::ostringstream oss;
+            oss << "Recording stopped : " << m_captured - m_dropped << " frames written, " << m_dropped << " frames dropped.";
+            core::logger::logm(oss.str(), m_dropped == 0 ? core::logger::MSG : core::logger::WARNING);
+        }
+
+        bool Recorder::recording() const
+        {
+            return m_rec;
+        }
+
+        void Recorder::capture()
+        {
+            if(!m_rec)
+                return;
+
+            /* Asynchronous read back of the actual frame. */
+            unsigned int idx = m_captured % m_nbPbos;
+            glReadBuffer(GL_BACK);
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbos[idx]);
+            glReadPixels(0, 0, m_w, m_h, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            ++m_captured;
+
+            /* The next pbo of the ring has been filled m_nbPbos - 1 frames ago, it should be ready. */
+            if(m_captured >= m_nbPbos) {
+                unsigned int id = m_captured - m_nbPbos;
+                readPbo(id % m_nbPbos, id);
+            }
+        }
+
+        unsigned int Recorder::captured() const
+        {
+            return m_captured;
+        }
+
+        unsigned int Recorder::dropped() const
+        {
+            return m_dropped;
+        }
+
+        /*************************
+         *   Internal methods    *
+         *************************/
+        void Recorder::readPbo(unsigned int idx, unsigned int id)
+        {
+            SDL_LockMutex(m_mutex);
+            Frame* fr = NULL;
+            if(!m_pool.empty()) {
+                fr = m_pool.back();
+                m_pool.pop_back();
+            }
+            SDL_UnlockMutex(m_mutex);
+
+            /* The worker is late, the frame is dropped rather than stalling the drawing. */
+            if(fr == NULL) {
+                ++m_dropped;
+                return;
+            }
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbos[idx]);
+            void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+            if(data != NULL) {
+                std::memcpy(&fr->pixels[0], data, fr->pixels.size());
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            fr->id = id;
+
+            SDL_LockMutex(m_mutex);
+            if(data != NULL)
+                m_queue.push_back(fr);
+            else {
+                m_pool.push_back(fr);
+                ++m_dropped;
+            }
+            SDL_CondSignal(m_cond);
+            SDL_UnlockMutex(m_mutex);
+        }
+
+        int Recorder::work(void* data)
+        {
+            Recorder* rec = static_cast<Recorder*>(data);
+
+            while(true) {
+                SDL_LockMutex(rec->m_mutex);
+                while(rec->m_queue.empty() && !rec->m_end)
+                    SDL_CondWait(rec->m_cond, rec->m_mutex);
+                if(rec->m_queue.empty()) {
+                    SDL_UnlockMutex(rec->m_mutex);
+                    break;
+                }
+                Frame* fr = rec->m_queue.front();
+                rec->m_queue.pop_front();
+                SDL_UnlockMutex(rec->m_mutex);
+
+                bool ok = rec->write(fr);
+
+                SDL_LockMutex(rec->m_mutex);
+                rec->m_pool.push_back(fr);
+                if(!ok && !rec->m_failed) {
+                    /* Only the first error is kept, it is logged by the main thread. */
+                    rec->m_failed = true;
+                    std::ostringstream oss;
+                    oss << "Couldn't write the frame " << fr->id << " of the recording : " << IMG_GetError();
+                    rec->m_error = oss.str();
+                }
+                SDL_UnlockMutex(rec->m_mutex);
+            }
+
+            return 0;
+        }
+
+        bool Recorder::write(Frame* fr) const
+        {
+            /* OpenGL gives the bottom line first : flipping the lines. */
+            size_t line = static_cast<size_t>(m_w) * 4;
+            std::vector<unsigned char> tmp(line);
+            for(int y = 0; y < m_h / 2; ++y) {
+                unsigned char* top = &fr->pixels[y * line];
+                unsigned char* bottom = &fr->pixels[(m_h - 1 - y) * line];
+                std::memcpy(&tmp[0], top, line);
+                std::memcpy(top, bottom, line);
+                std::memcpy(bottom, &tmp[0], line);
+            }
+
+            /* The alpha of the framebuffer is meaningless, it is ignored. */
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+            SDL_Surface* surf = SDL_CreateRGBSurfaceFrom(&fr->pixels[0], m_w, m_h, 32, static_cast<int>(line),
+                    0xFF000000, 0x00FF0000, 0x0000FF00, 0);
+#else
+            SDL_Surface* surf = SDL_CreateRGBSurfaceFrom(&fr->pixels[0], m_w, m_h, 32, static_cast<int>(line),
+                    0x000000FF, 0x0000FF00, 0x00FF0000, 0);
+#endif
+            if(surf == NULL)
+                return false;
+
+            std::ostringstream path;
+            path << m_prefix << std::setw(6) << std::setfill('0') << fr->id << ".png";
+            bool ok = (IMG_SavePNG(surf, path.str().c_str()) == 0);
+            SDL_FreeSurface(surf);
+            return ok;
+        }
+    }
+}
+
@@ -0,0 +1,89 @@
+
+#ifndef DEF_GRAPHICS_RECORDER
+#define DEF_GRAPHICS_RECORDER
+
+#include "graphics/exts.hpp"
+#include <string>
+#include <vector>
+#include <deque>
+#include <SDL.h>
+
+namespace graphics
+{
+    namespace internal
+    {
+        /** @brief Records the frames drawn to a sequence of PNG files.
+         *
+         * The frames are read back asynchronously through a ring of pixel buffer objects, so
+         * the pixels of a frame are only accessed a few frames later, when the GPU is done with them.
+         * They are then written to disk by a worker thread. If the worker is too slow, frames are dropped
+         * instead of slowing down the rendering.
+         */
+        class Recorder
+        {
+            public:
+                Recorder(Extensions* exts);
+                Recorder() = delete;
+                Recorder(const Recorder&) = delete;
+                ~Recorder();
+
+                /** @brief Starts recording the frames of size w*h.
+                 * @param prefix The prefix of the path of the files : the number of the frame and ".png" will be appended.
+                 */
+                bool start(const std::string& prefix, int w, int h);
+                /** @brief Stops recording, waiting for all the pending frames to be written. */
+                void stop();
+                /** @brief Indicates if the recording is running. */
+                bool recording() const;
+                /** @brief Reads back the actual frame : must be called after drawing, before swapping the buffers. */
+                void capture();
+
+                /** @brief Returns the number of frames captured since the beggining of the recording. */
+                unsigned int captured() const;
+                /** @brief Returns the number of frames dropped since the beggining of the recording. */
+                unsigned int dropped() const;
+
+            private:
+                /** @brief A frame waiting to be written. */
+                struct Frame {
+                    unsigned int id;                  /**< @brief The number of the frame. */
+                    std::vector<unsigned char> pixels; /**< @brief The RGBA pixels, bottom line first. */
+                };
+
+                /** @brief Number of pixel buffer objects in the ring. */
+                static const unsigned int m_nbPbos = 3;
+                /** @brief Maximum number of frames waiting to be written. */
+                static const unsigned int m_maxQueue = 8;
+
+                Extensions* m_exts;            /**< @brief The GL extensions loader. */
+                bool m_rec;                    /**< @brief Is the recording running. */
+                std::string m_prefix;          /**< @brief The prefix of the files written. */
+                int m_w;                       /**< @brief The width of the frames. */
+                int m_h;                       /**< @brief The height of the frames. */
+                GLuint m_pbos[m_nbPbos];       /**< @brief The ring of pixel buffer objects. */
+                unsigned int m_captured;       /**< @brief The number of frames captured. */
+                unsigned int m_dropped;        /**< @brief The number of frames dropped. */
+
+                /* Worker thread */
+                SDL_Thread* m_thread;          /**< @brief The thread writing the frames. */
+                SDL_mutex* m_mutex;            /**< @brief Protects the members shared with the worker. */
+                SDL_cond* m_cond;              /**< @brief Signals a new frame or the end of the recording to the worker. */
+                bool m_end;                    /**< @brief Must the worker stop when the queue is empty. */
+                std::deque<Frame*> m_queue;    /**< @brief The frames waiting to be written. */
+                std::vector<Frame*> m_pool;    /**< @brief The frames which can be reused. */
+                bool m_failed;                 /**< @brief Did the worker fail to write a file. */
+                std::string m_error;           /**< @brief The first error of the worker. */
+
+                /* Internal methods */
+                /** @brief Copies the content of the pbo of index idx, filled by the capture of frame id, to the queue. */
+                void readPbo(unsigned int idx, unsigned int id);
+                /** @brief The function executed by the worker thread. */
+                static int work(void* data);
+                /** @brief Writes a frame to a PNG file. */
+                bool write(Frame* fr) const;
+        };
+    }
+}
+
+#endif
+
@@ -0,0 +1,236 @@
+
+#include "graphics/scaler.hpp"
+#include "core/logger.hpp"
+
+namespace graphics
+{
+    namespace internal
+    {
+        Scaler::Scaler(Extensions* exts)
+            : m_exts(exts), m_ready(false), m_fbo(0), m_tex(0), m_fullW(0), m_fullH(0), m_w(0), m_h(0),
+            m_scale(1.0f), m_min(0.5f), m_max(1.0f), m_target(12.0f), m_time(-1.0f),
+            m_timer(false), m_query(0), m_last(0)
+        {
+            for(unsigned int i = 0; i < m_nbQueries; ++i) {
+                m_queries[i] = 0;
+                m_issued[i] = false;
+            }
+        }
+
+        Scaler::~Scaler()
+        {
+            /* The openGL context is already destroyed when the destructor is called. */
+        }
+
+        /*************************
+         *    Offscreen target   *
+         *************************/
+        bool Scaler::init(int w, int h)
+        {
+            free();
+            if(w <= 0 || h <= 0)
+                return false;
+            if(!m_exts->has("GL_ARB_framebuffer_object")) {
+                core::logger::logm("Hardware does not support GL_ARB_framebuffer_object, needed for dynamic resolution.", core::logger::WARNING);
+                return false;
+            }
+
+            m_fullW = w;
+            m_fullH = h;
+            glGenTextures(1, &m_tex);
+            glBindTexture(GL_TEXTURE_2D, m_tex);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_fullW, m_fullH, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+            glGenFramebuffers(1, &m_fbo);
+            glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_tex, 0);
+            GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            if(status != GL_FRAMEBUFFER_COMPLETE) {
+                core::logger::logm("Couldn't create the offscreen target for dynamic resolution.", core::logger::WARNING);
+                glDeleteFramebuffers(1, &m_fbo);
+                glDeleteTextures(1, &m_tex);
+                m_fbo = 0;
+                m_tex = 0;
+                return false;
+            }
+
+            m_timer = m_exts->has("GL_ARB_timer_query");
+            if(m_timer)
+                glGenQueries(m_nbQueries, m_queries);
+            else
+                core::logger::logm("Hardware does not support GL_ARB_timer_query : the dynamic resolution will use the frame time.", core::logger::WARNING);
+            for(unsigned int i = 0; i < m_nbQueries; ++i)
+                m_issued[i] = false;
+            m_query = 0;
+            m_last = 0;
+            m_time = -1.0f;
+
+            m_ready = true;
+            return true;
+        }
+
+        void Scaler::free()
+        {
+            if(!m_ready)
+                return;
+            glDeleteFramebuffers(1, &m_fbo);
+            glDeleteTextures(1, &m_tex);
+            if(m_timer)
+                glDeleteQueries(m_nbQueries, m_queries);
+            m_fbo = 0;
+            m_tex = 0;
+            m_ready = false;
+        }
+
+        bool Scaler::ready() const
+        {
+            return m_ready;
+        }
+
+        /*************************
+         *     Scale control     *
+         *************************/
+        void Scaler::bounds(float min, float max)
+        {
+            if(max > 1.0f)
+                max = 1.0f;
+            if(min < 0.1f)
+                min = 0.1f;
+            if(min > max)
+                min = max;
+            m_min = min;
+            m_max = max;
+
+            if(m_scale < m_min)
+                m_scale = m_min;
+            else if(m_scale > m_max)
+                m_scale = m_max;
+        }
+
+        void Scaler::target(float ms)
+        {
+            if(ms > 0.0f)
+                m_target = ms;
+        }
+
+        float Scaler::scale() const
+        {
+            return m_scale;
+        }
+
+        float Scaler::time() const
+        {
+            return m_time;
+        }
+
+        void Scaler::update(float ms)
+        {
+            /* Smoothing the measures, one slow frame musn't change the scale much. */
+            if(m_time < 0.0f)
+                m_time = ms;
+            else
+                m_time = m_time * 0.9f + ms * 0.1f;
+
+            /* Going down quickly, going up slowly to avoid oscillations. */
+            if(m_time > m_target)
+                m_scale *= 0.97f;
+            else if(m_time < m_target * 0.8f)
+                m_scale *= 1.01f;
+
+            if(m_scale < m_min)
+                m_scale = m_min;
+            else if(m_scale > m_max)
+                m_scale = m_max;
+        }
+
+        /*************************
+         *        Drawing        *
+         *************************/
+        void Scaler::begin()
+        {
+            if(!m_ready)
+                return;
+
+            m_w = static_cast<int>(static_cast<float>(m_fullW) * m_scale);
+            m_h = static_cast<int>(static_cast<float>(m_fullH) * m_scale);
+            if(m_w < 1)
+                m_w = 1;
+            if(m_h < 1)
+                m_h = 1;
+
+            glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+            glViewport(0, 0, m_w, m_h);
+            glClearColor(0, 0, 0, 0);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            if(m_timer)
+                glBeginQuery(GL_TIME_ELAPSED, m_queries[m_query]);
+        }
+
+        void Scaler::end(Shaders* shads)
+        {
+            if(!m_ready)
+                return;
+
+            /* Measuring : the result of the oldest query should be available. */
+            if(m_timer) {
+                glEndQuery(GL_TIME_ELAPSED);
+                m_issued[m_query] = true;
+                m_query = (m_query + 1) % m_nbQueries;
+                if(m_issued[m_query]) {
+                    GLint available = 0;
+                    glGetQueryObjectiv(m_queries[m_query], GL_QUERY_RESULT_AVAILABLE, &available);
+                    if(available) {
+                        GLuint64 ns = 0;
+                        glGetQueryObjectui64v(m_queries[m_query], GL_QUERY_RESULT, &ns);
+                        update(static_cast<float>(ns) / 1000000.0f);
+                    }
+                    m_issued[m_query] = false;
+                }
+            }
+            else {
+                Uint32 now = SDL_GetTicks();
+                if(m_last != 0)
+                    update(static_cast<float>(now - m_last));
+                m_last = now;
+            }
+
+            /* Upscaling the used part of the texture to the whole window. */
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, m_fullW, m_fullH);
+
+            glMatrixMode(GL_PROJECTION);
+            glPushMatrix();
+            glLoadIdentity();
+            glOrtho(0, 1, 0, 1, 1, -1);
+            glMatrixMode(GL_MODELVIEW);
+            glPushMatrix();
+            glLoadIdentity();
+
+            glDisable(GL_BLEND);
+            shads->text(true);
+            glBindTexture(GL_TEXTURE_2D, m_tex);
+            float u = static_cast<float>(m_w) / static_cast<float>(m_fullW);
+            float v = static_cast<float>(m_h) / static_cast<float>(m_fullH);
+            glColor4ub(255, 255, 255, 255);
+            glBegin(GL_QUADS);
+            glTexCoord2f(0.0f, 0.0f); glVertex2f(0.0f, 0.0f);
+            glTexCoord2f(u,    0.0f); glVertex2f(1.0f, 0.0f);
+            glTexCoord2f(u,    v);    glVertex2f(1.0f, 1.0f);
+            glTexCoord2f(0.0f, v);    glVertex2f(0.0f, 1.0f);
+            glEnd();
+            glEnable(GL_BLEND);
+
+            glMatrixMode(GL_PROJECTION);
+            glPopMatrix();
+            glMatrixMode(GL_MODELVIEW);
+            glPopMatrix();
+        }
+    }
+}
+
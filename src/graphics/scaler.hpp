@@ -0,0 +1,85 @@
+
+#ifndef DEF_GRAPHICS_SCALER
+#define DEF_GRAPHICS_SCALER
+
+#include "graphics/exts.hpp"
+#include "graphics/shaders.hpp"
+#include <SDL.h>
+
+namespace graphics
+{
+    namespace internal
+    {
+        /** @brief Renders a scene in an offscreen target, which size adapts to the time the GPU takes to draw it.
+         *
+         * The target is allocated at the size of the window, and only a part of it, depending on the scale, is used :
+         * changing the scale never reallocates anything. The GPU time is measured with timer queries read a few frames later,
+         * so the CPU never waits for them. If timer queries are not supported, the time between two frames is used.
+         */
+        class Scaler
+        {
+            public:
+                Scaler(Extensions* exts);
+                Scaler() = delete;
+                Scaler(const Scaler&) = delete;
+                ~Scaler();
+
+                /** @brief Allocates the offscreen target for a window of size w*h.
+                 * @return False if the hardware doesn't support it.
+                 */
+                bool init(int w, int h);
+                /** @brief Frees the offscreen target. */
+                void free();
+                /** @brief Indicates if the offscreen target is allocated. */
+                bool ready() const;
+
+                /** @brief Sets the bounds of the scale, which is at most 1. */
+                void bounds(float min, float max);
+                /** @brief Sets the GPU time per scene targeted, in milliseconds. */
+                void target(float ms);
+                /** @brief Returns the actual scale. */
+                float scale() const;
+                /** @brief Returns the smoothed GPU time of the last scenes, in milliseconds. */
+                float time() const;
+
+                /** @brief Redirects the drawing to the offscreen target. */
+                void begin();
+                /** @brief Draws back to the window, upscaling the scene to the whole window, and updates the scale. */
+                void end(Shaders* shads);
+
+            private:
+                /** @brief The number of timer queries in the ring. */
+                static const unsigned int m_nbQueries = 3;
+
+                Extensions* m_exts;           /**< @brief The GL extensions loader. */
+                bool m_ready;                 /**< @brief Is the target allocated. */
+                GLuint m_fbo;                 /**< @brief The framebuffer object. */
+                GLuint m_tex;                 /**< @brief The texture the scene is drawn to. */
+                int m_fullW;                  /**< @brief The width of the window and of the texture. */
+                int m_fullH;                  /**< @brief The height of the window and of the texture. */
+                int m_w;                      /**< @brief The width of the part of the texture used by the actual scene. */
+                int m_h;                      /**< @brief The height of the part of the texture used by the actual scene. */
+
+                /* Scale control */
+                float m_scale;                /**< @brief The actual scale. */
+                float m_min;                  /**< @brief The minimum scale. */
+                float m_max;                  /**< @brief The maximum scale. */
+                float m_target;               /**< @brief The targeted GPU time. */
+                float m_time;                 /**< @brief The smoothed GPU time, negative before the first measure. */
+
+                /* Timing */
+                bool m_timer;                 /**< @brief Are the timer queries supported. */
+                GLuint m_queries[m_nbQueries];/**< @brief The ring of timer queries. */
+                bool m_issued[m_nbQueries];   /**< @brief Which queries wait for their result. */
+                unsigned int m_query;         /**< @brief The index of the next query used. */
+                Uint32 m_last;                /**< @brief The timestamp of the last scene, when timer queries aren't supported. */
+
+                /* Internal methods */
+                /** @brief Updates the scale with a new measure of the GPU time. */
+                void update(float ms);
+        };
+    }
+}
+
+#endif
+
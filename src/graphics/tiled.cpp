@@ -0,0 +1,231 @@
+
+#include "graphics/tiled.hpp"
+#include "graphics/texture.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace graphics
+{
+    namespace internal
+    {
+        TiledTexture::TiledTexture(Extensions* exts)
+            : m_exts(exts), m_surf(NULL), m_tile(0), m_nx(0), m_ny(0), m_resident(0),
+            m_hp(0.0f, 0.0f), m_lastX(0.0f), m_lastY(0.0f), m_hasLast(false)
+        {}
+
+        TiledTexture::~TiledTexture()
+        {
+            for(Tile& t : m_tiles)
+                evict(t);
+            if(m_surf)
+                SDL_FreeSurface(m_surf);
+        }
+
+        /*************************
+         *        Loading        *
+         *************************/
+        bool TiledTexture::load(const std::string& path, int tile)
+        {
+            Texture text(m_exts);
+            SDL_Surface* surf = text.preload(path);
+            if(surf == NULL)
+                return false;
+            return loadsdl(surf, tile);
+        }
+
+        bool TiledTexture::loadsdl(SDL_Surface* src, int tile)
+        {
+            if(src == NULL || tile <= 0)
+                return false;
+            for(Tile& t : m_tiles)
+                evict(t);
+            if(m_surf)
+                SDL_FreeSurface(m_surf);
+
+            m_surf = src;
+            m_tile = tile;
+            m_nx = (m_surf->w + m_tile - 1) / m_tile;
+            m_ny = (m_surf->h + m_tile - 1) / m_tile;
+            m_tiles.resize(m_nx * m_ny);
+            m_resident = 0;
+            for(int j = 0; j < m_ny; ++j) {
+                for(int i = 0; i < m_nx; ++i) {
+                    Tile& t = m_tiles[j * m_nx + i];
+                    t.id = 0;
+                    t.wanted = false;
+                    t.x = i * m_tile;
+                    t.y = j * m_tile;
+                    t.w = std::min(m_tile, m_surf->w - t.x);
+                    t.h = std::min(m_tile, m_surf->h - t.y);
+                    t.used = 0;
+                }
+            }
+            m_hasLast = false;
+            return true;
+        }
+
+        int TiledTexture::width() const
+        {
+            return m_surf ? m_surf->w : 0;
+        }
+
+        int TiledTexture::height() const
+        {
+            return m_surf ? m_surf->h : 0;
+        }
+
+        void TiledTexture::hotpoint(const geometry::Point& hp)
+        {
+            m_hp = hp;
+        }
+
+        geometry::Point TiledTexture::hotpoint() const
+        {
+            return m_hp;
+        }
+
+        /*************************
+         *       Streaming       *
+         *************************/
+        void TiledTexture::stream(float x, float y, float w, float h, unsigned int frame)
+        {
+            if(m_surf == NULL)
+                return;
+
+            /* The visible tiles are needed now. */
+            int x0, y0, x1, y1;
+            if(range(x, y, w, h, &x0, &y0, &x1, &y1)) {
+                for(int j = y0; j <= y1; ++j) {
+                    for(int i = x0; i <= x1; ++i) {
+                        Tile& t = m_tiles[j * m_nx + i];
+                        if(!t.wanted) {
+                            t.wanted = true;
+                            ++m_resident;
+                        }
+                        t.used = frame;
+                    }
+                }
+            }
+
+            /* The predicted ones are uploaded a few at a time, a tile around the movement is kept. */
+            float dx = (m_hasLast ? x - m_lastX : 0.0f) * (float)m_predict;
+            float dy = (m_hasLast ? y - m_lastY : 0.0f) * (float)m_predict;
+            float px = std::min(x, x + dx) - (float)m_tile;
+            float py = std::min(y, y + dy) - (float)m_tile;
+            float pw = w + std::abs(dx) + 2.0f * (float)m_tile;
+            float ph = h + std::abs(dy) + 2.0f * (float)m_tile;
+            int budget = m_budget;
+            if(range(px, py, pw, ph, &x0, &y0, &x1, &y1)) {
+                for(int j = y0; j <= y1; ++j) {
+                    for(int i = x0; i <= x1; ++i) {
+                        Tile& t = m_tiles[j * m_nx + i];
+                        if(!t.wanted && budget > 0) {
+                            t.wanted = true;
+                            ++m_resident;
+                            --budget;
+                        }
+                        if(t.wanted && t.used != frame)
+                            t.used = frame - 1;
+                    }
+                }
+            }
+            m_lastX = x;
+            m_lastY = y;
+            m_hasLast = true;
+
+            /* Evicting the tiles unused for a while. */
+            for(Tile& t : m_tiles) {
+                if(t.wanted && frame - t.used > m_keep) {
+                    t.wanted = false;
+                    --m_resident;
+                }
+            }
+        }
+
+        void TiledTexture::sync()
+        {
+            for(Tile& t : m_tiles) {
+                if(t.wanted && t.id == 0)
+                    upload(t);
+                else if(!t.wanted && t.id != 0)
+                    evict(t);
+            }
+        }
+
+        void TiledTexture::snapshot(std::vector<unsigned char>* wanted) const
+        {
+            wanted->resize(m_tiles.size());
+            for(size_t i = 0; i < m_tiles.size(); ++i)
+                (*wanted)[i] = m_tiles[i].wanted ? 1 : 0;
+        }
+
+        void TiledTexture::sync(const std::vector<unsigned char>& wanted)
+        {
+            /* The texture may have been reloaded since the snapshot. */
+            if(wanted.size() != m_tiles.size())
+                return;
+            for(size_t i = 0; i < m_tiles.size(); ++i) {
+                Tile& t = m_tiles[i];
+                if(wanted[i] && t.id == 0)
+                    upload(t);
+                else if(!wanted[i] && t.id != 0)
+                    evict(t);
+            }
+        }
+
+        const std::vector<TiledTexture::Tile>& TiledTexture::tiles() const
+        {
+            return m_tiles;
+        }
+
+        size_t TiledTexture::resident() const
+        {
+            return m_resident;
+        }
+
+        /*************************
+         *   Internal methods    *
+         *************************/
+        void TiledTexture::upload(Tile& t)
+        {
+            /* Uploading a part of the picture, without copying it. */
+            glGenTextures(1, &t.id);
+            glBindTexture(GL_TEXTURE_2D, t.id);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, m_surf->pitch / 4);
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, t.x);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, t.y);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, t.w, t.h, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_surf->pixels);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            /* Prevents seams between the tiles. */
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+
+        void TiledTexture::evict(Tile& t)
+        {
+            if(t.id == 0)
+                return;
+            glDeleteTextures(1, &t.id);
+            t.id = 0;
+        }
+
+        bool TiledTexture::range(float x, float y, float w, float h, int* x0, int* y0, int* x1, int* y1) const
+        {
+            if(w <= 0.0f || h <= 0.0f
+                    || x + w < 0.0f || y + h < 0.0f
+                    || x >= (float)m_surf->w || y >= (float)m_surf->h)
+                return false;
+
+            *x0 = std::max(0, (int)std::floor(x / (float)m_tile));
+            *y0 = std::max(0, (int)std::floor(y / (float)m_tile));
+            *x1 = std::min(m_nx - 1, (int)std::floor((x + w) / (float)m_tile));
+            *y1 = std::min(m_ny - 1, (int)std::floor((y + h) / (float)m_tile));
+            return true;
+        }
+    }
+}
+
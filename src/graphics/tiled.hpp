@@ -0,0 +1,111 @@
+
+#ifndef DEF_GRAPHICS_TILED
+#define DEF_GRAPHICS_TILED
+
+#include "graphics/exts.hpp"
+#include "geometry/point.hpp"
+#include <string>
+#include <vector>
+#include <SDL.h>
+
+namespace graphics
+{
+    namespace internal
+    {
+        /** @brief A texture too big to be uploaded at once, split in square tiles.
+         *
+         * The decoded picture is kept in memory, and only the tiles needed are uploaded : the ones
+         * intersecting the visible part, and a few more in the direction the visible part is moving to.
+         * The tiles unused for a while are evicted.
+         * Choosing the tiles (stream) and updating their textures (sync) are separated, so that only the latter
+         * needs the openGL context and can be run by the render thread : it then works on a copy of the
+         * tiles wanted, taken by snapshot when recording, so that the next stream can't change them while
+         * it uploads. The textures of the tiles are only touched by sync and the drawing.
+         * Coordinates are in pixels, from the top left corner of the picture.
+         */
+        class TiledTexture
+        {
+            public:
+                /** @brief A tile of the texture. */
+                struct Tile {
+                    GLuint id;         /**< @brief The openGL texture, 0 if not uploaded : only used by sync and the drawing. */
+                    bool wanted;       /**< @brief Must the tile be uploaded : only used by stream, snapshot and sync. */
+                    int x;             /**< @brief The x of the left column of the tile in the picture. */
+                    int y;             /**< @brief The y of the top line of the tile in the picture. */
+                    int w;             /**< @brief The width of the tile. */
+                    int h;             /**< @brief The height of the tile. */
+                    unsigned int used; /**< @brief The last frame the tile was needed. */
+                };
+
+                TiledTexture(Extensions* exts);
+                TiledTexture() = delete;
+                TiledTexture(const TiledTexture&) = delete;
+                ~TiledTexture();
+
+                /** @brief Loads the picture from a file, cutting it in tiles of size tile*tile. No tile is uploaded. */
+                bool load(const std::string& path, int tile);
+                /** @brief Loads the picture from an SDL_Surface in 32 bits RGBA, which will be free'd by the texture. */
+                bool loadsdl(SDL_Surface* src, int tile);
+
+                /** @brief Returns the width in pixels of the whole texture. */
+                int width() const;
+                /** @brief Returns the height in pixels of the whole texture. */
+                int height() const;
+                /** @brief Sets the hotpoint of the texture. */
+                void hotpoint(const geometry::Point& hp);
+                /** @brief Get the hotpoint of the texture. */
+                geometry::Point hotpoint() const;
+
+                /** @brief Chooses the tiles to upload, the ones intersecting the visible rect and the predicted one, and the ones to evict.
+                 * The openGL context is not needed : the textures are updated by sync.
+                 * @param x The minimum x of the visible rect.
+                 * @param y The minimum y of the visible rect.
+                 * @param w The width of the visible rect.
+                 * @param h The height of the visible rect.
+                 * @param frame The number of the actual frame.
+                 */
+                void stream(float x, float y, float w, float h, unsigned int frame);
+                /** @brief Uploads and evicts the tiles chosen by the last stream : the openGL context must be current. */
+                void sync();
+                /** @brief Copies in wanted which tiles are chosen by the last stream, one byte per tile. */
+                void snapshot(std::vector<unsigned char>* wanted) const;
+                /** @brief Uploads and evicts the tiles as chosen in a snapshot : the openGL context must be current. */
+                void sync(const std::vector<unsigned char>& wanted);
+                /** @brief Returns all the tiles : the ones needed for the frame have their used member equal to it. */
+                const std::vector<Tile>& tiles() const;
+                /** @brief Returns the number of tiles uploaded after the next sync. */
+                size_t resident() const;
+
+            private:
+                /** @brief The maximum number of predicted tiles uploaded per frame. */
+                static const int m_budget = 2;
+                /** @brief The number of frames the movement of the visible rect is extrapolated on. */
+                static const int m_predict = 10;
+                /** @brief The number of frames an unused tile is kept. */
+                static const unsigned int m_keep = 120;
+
+                Extensions* m_exts;       /**< @brief The GL extensions loader. */
+                SDL_Surface* m_surf;      /**< @brief The decoded picture. */
+                int m_tile;               /**< @brief The size of the tiles. */
+                int m_nx;                 /**< @brief The number of columns of tiles. */
+                int m_ny;                 /**< @brief The number of lines of tiles. */
+                std::vector<Tile> m_tiles;/**< @brief The tiles, line by line. */
+                size_t m_resident;        /**< @brief The number of tiles wanted. */
+                geometry::Point m_hp;     /**< @brief The hotpoint. */
+                float m_lastX;            /**< @brief The x of the last visible rect. */
+                float m_lastY;            /**< @brief The y of the last visible rect. */
+                bool m_hasLast;           /**< @brief Is there a last visible rect. */
+
+                /* Internal methods */
+                /** @brief Uploads a tile. */
+                void upload(Tile& t);
+                /** @brief Frees the texture of a tile. */
+                void evict(Tile& t);
+                /** @brief Computes the range of tiles intersecting a rect, returns false if empty. */
+                bool range(float x, float y, float w, float h, int* x0, int* y0, int* x1, int* y1) const;
+        };
+    }
+}
+
+#endif
+
@@ -0,0 +1,18 @@
+
+#ifndef DEF_GRAPHICS_VERTEX
+#define DEF_GRAPHICS_VERTEX
+
+#include "graphics/color.hpp"
+
+namespace graphics
+{
+    /** @brief A colored vertex, used to draw many primitives in one call. */
+    struct Vertex {
+        float x;   /**< @brief The x coordinate. */
+        float y;   /**< @brief The y coordinate. */
+        Color col; /**< @brief The color of the vertex. */
+    };
+}
+
+#endif
+
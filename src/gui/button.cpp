@@ -1,10 +1,11 @@
 
 #include "button.hpp"
+#include <cmath>
 
 namespace gui
 {
     Button::Button(graphics::Graphics* gfx)
-        : Widget(gfx), m_it(gfx), m_last(0), m_focus(false), m_msize(-1.0f, -1.0f), m_clicked(false)
+        : Widget(gfx), m_it(gfx), m_last(0), m_focus(false), m_msize(-1.0f, -1.0f), m_clicked(false), m_drawnSel(false)
     {
         m_it.resize(false);
     }
@@ -15,6 +16,7 @@ namespace gui
     void Button::text(const std::string& t)
     {
         m_it.text(t);
+        damage();
     }
 
     std::string Button::text() const
@@ -29,6 +31,8 @@ namespace gui
             
     void Button::maxFontSize(float fms)
     {
+        if(std::abs(fms - m_it.fontMaxSize()) > 0.001f)
+            damage();
         m_it.fontMaxSize(fms);
     }
 
@@ -67,7 +71,8 @@ namespace gui
 
     void Button::draw()
     {
-        if(SDL_GetTicks() - m_last < 1000)
+        m_drawnSel = (SDL_GetTicks() - m_last < 1000);
+        if(m_drawnSel)
             m_it.select();
         else if(m_focus)
             m_it.focus();
@@ -80,9 +85,17 @@ namespace gui
         m_gfx->pop();
     }
 
+    bool Button::dirty() const
+    {
+        /* The clicked state is shown for one second. */
+        bool sel = (SDL_GetTicks() - m_last < 1000);
+        return Widget::dirty() || sel != m_drawnSel || m_it.animated();
+    }
+
     void Button::focus(bool f)
     {
         m_focus = f;
+        damage();
     }
 
     bool Button::action(Widget::Action a)
@@ -91,6 +104,7 @@ namespace gui
             select();
             m_clicked = true;
             m_last = SDL_GetTicks();
+            damage();
             return true;
         }
         else
@@ -52,6 +52,7 @@ namespace gui
             /** @brief Set a texture to use when not clicked. */
             void setTexture(Texture p, State st, const std::string& name);
             virtual void draw();
+            virtual bool dirty() const;
 
             /* Action */
             virtual void focus(bool f);
@@ -68,6 +69,7 @@ namespace gui
             bool m_focus;           /**< @brief Is the button focused. */
             geometry::AABB m_msize; /**< @brief The maximum size to use. */
             mutable bool m_clicked;         /**< @brief Has the button been clicked in last gui update. */
+            bool m_drawnSel;        /**< @brief Was the button drawn as clicked the last time. */
     };
 }
 
@@ -43,6 +43,7 @@ namespace gui
 
     bool CheckBox::set(bool s)
     {
+        damage();
         return (m_state = (s ? 1 : 0));
     }
 
@@ -92,6 +93,7 @@ namespace gui
     {
         m_focus = (f ? 1 : 0);
         updateSizes();
+        damage();
     }
 
     bool CheckBox::action(Widget::Action a)
@@ -108,6 +110,7 @@ namespace gui
     {
         m_label = lab;
         updateSizes();
+        damage();
     }
 
     std::string CheckBox::label() const
@@ -23,6 +23,7 @@ namespace gui
 
     float FillBar::set(float f)
     {
+        damage();
         return (m_filled = f);
     }
 
@@ -125,6 +126,7 @@ namespace gui
     void FillBar::focus(bool f)
     {
         m_focus = (f ? 1 : 0);
+        damage();
     }
 
     bool FillBar::action(Widget::Action a)
@@ -45,6 +45,7 @@ namespace gui
     float Frame::border(float size)
     {
         m_border = size;
+        damage();
         return m_border;
     }
 
@@ -61,12 +62,14 @@ namespace gui
     void Frame::set(Widget* in)
     {
         m_in = in;
+        damage();
     }
             
     void Frame::setBg(const std::string& value, bool strict)
     {
         m_bg = value;
         m_strict = strict;
+        damage();
     }
             
     bool Frame::strictBg() const
@@ -148,6 +151,18 @@ namespace gui
         m_gfx->pop();
     }
 
+    bool Frame::dirty() const
+    {
+        return Widget::dirty() || (m_in && m_in->dirty());
+    }
+
+    void Frame::clean()
+    {
+        Widget::clean();
+        if(m_in)
+            m_in->clean();
+    }
+
     void Frame::focus(bool f)
     {
         if(m_in)
@@ -59,6 +59,8 @@ namespace gui
             Widget* getWidget() const;
 
             virtual void draw();
+            virtual bool dirty() const;
+            virtual void clean();
 
             /* Events */
             virtual void focus(bool f);
@@ -103,6 +103,7 @@ namespace gui
         }
 
         updateSizes();
+        damage();
         return true;
     }
 
@@ -130,6 +131,7 @@ namespace gui
             }
         }
         m_focused = sw;
+        damage();
     }
 
     bool GridLayout::removeWidget(unsigned int x, unsigned int y)
@@ -151,6 +153,7 @@ namespace gui
             }
         }
 
+        damage();
         return true;
     }
 
@@ -173,8 +176,33 @@ namespace gui
         m_gfx->pop();
     }
 
+    bool GridLayout::dirty() const
+    {
+        if(Widget::dirty())
+            return true;
+        for(size_t x = 0; x < m_columns; ++x) {
+            for(size_t y = 0; y < m_rows; ++y) {
+                if(m_map[x][y].widget && m_map[x][y].widget->dirty())
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    void GridLayout::clean()
+    {
+        Widget::clean();
+        for(size_t x = 0; x < m_columns; ++x) {
+            for(size_t y = 0; y < m_rows; ++y) {
+                if(m_map[x][y].widget)
+                    m_map[x][y].widget->clean();
+            }
+        }
+    }
+
     void GridLayout::focus(bool f)
     {
+        damage();
         /* Unfocus all */
         for(size_t x = 0; x < m_columns; ++x) {
             for(size_t y = 0; y < m_rows; ++y) {
@@ -55,6 +55,8 @@ namespace gui
             bool removeWidget(unsigned int x, unsigned int y);
 
             virtual void draw();
+            virtual bool dirty() const;
+            virtual void clean();
 
             virtual void focus(bool f);
             virtual void inputText(const std::string& str);
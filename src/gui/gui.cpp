@@ -5,7 +5,7 @@
 namespace gui
 {
     Gui::Gui(graphics::Graphics* gfx)
-        : m_tofree(false), m_focus(false), m_main(NULL), m_gfx(gfx)
+        : m_tofree(false), m_focus(false), m_dirty(true), m_main(NULL), m_gfx(gfx)
     {}
 
     Gui::~Gui()
@@ -24,6 +24,7 @@ namespace gui
         m_main->width(width);
         m_main->height(height);
         m_main->focus(m_focus);
+        m_dirty  = true;
         return m_main;
     }
 
@@ -37,6 +38,7 @@ namespace gui
         m_pos = p;
         m_main->width(width);
         m_main->height(height);
+        m_dirty = true;
     }
 
     void Gui::draw()
@@ -48,10 +50,20 @@ namespace gui
         m_gfx->move(m_pos.x,m_pos.y);
         m_main->draw();
         m_gfx->pop();
+
+        m_main->clean();
+        m_dirty = false;
+    }
+
+    bool Gui::dirty() const
+    {
+        return m_dirty || (m_main && m_main->dirty());
     }
 
     void Gui::focus(bool f)
     {
+        if(f != m_focus)
+            m_dirty = true;
         m_focus = f;
         if(!m_main)
             return;
@@ -69,15 +81,25 @@ namespace gui
 
     void Gui::update(const events::Events& ev)
     {
+        /* The content of the window may have been lost. */
+        if(ev.earnedState(events::WindowState::Exposed)
+                || ev.earnedState(events::WindowState::Resized)
+                || ev.lostState(events::WindowState::Minimized))
+            m_dirty = true;
+
         if(!m_main || !m_focus)
             return;
 
         /* Input */
         std::string input = ev.lastInput();
-        if(!input.empty())
+        if(!input.empty()) {
             m_main->inputText(input);
-        if(ev.keyJustPressed(events::KeyMap::Enter))
+            m_dirty = true;
+        }
+        if(ev.keyJustPressed(events::KeyMap::Enter)) {
             m_main->inputText("\n");
+            m_dirty = true;
+        }
 
         /* Actions */
         /* Directions */
@@ -136,30 +158,30 @@ namespace gui
 
         /* LEFT */
         if(left || ev.keyJustPressed(events::KeyMap::Left))
-            m_main->action(Widget::ScrollLeft);
+            m_dirty = m_main->action(Widget::ScrollLeft) || m_dirty;
         /* RIGHT */
         if(right || ev.keyJustPressed(events::KeyMap::Right))
-            m_main->action(Widget::ScrollRight);
+            m_dirty = m_main->action(Widget::ScrollRight) || m_dirty;
         /* UP */
         if(up || ev.keyJustPressed(events::KeyMap::Up))
-            m_main->action(Widget::ScrollUp);
+            m_dirty = m_main->action(Widget::ScrollUp) || m_dirty;
         /* DOWN */
         if(down || ev.keyJustPressed(events::KeyMap::Down))
-            m_main->action(Widget::ScrollDown);
+            m_dirty = m_main->action(Widget::ScrollDown) || m_dirty;
 
         /* SELECT */
         if(ev.keyJustPressed(events::KeyMap::Return)
                 || !ev.lastJoyButtonsPressed().empty())
-            m_main->action(Widget::Select);
+            m_dirty = m_main->action(Widget::Select) || m_dirty;
         /* FIRST */
         if(ev.keyJustPressed(events::KeyMap::Begin))
-            m_main->action(Widget::First);
+            m_dirty = m_main->action(Widget::First) || m_dirty;
         /* END */
         if(ev.keyJustPressed(events::KeyMap::End))
-            m_main->action(Widget::Last);
+            m_dirty = m_main->action(Widget::Last) || m_dirty;
         /* REMOVE */
         if(ev.keyJustPressed(events::KeyMap::Backspace))
-            m_main->action(Widget::Remove);
+            m_dirty = m_main->action(Widget::Remove) || m_dirty;
     }
 
 }
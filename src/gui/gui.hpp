@@ -40,6 +40,11 @@ namespace gui
 
             /** @brief Will draw everything. It must be called between Graphics::beginDraw and endDraw. */
             void draw();
+            /** @brief Indicates if something changed since the last call to draw.
+             *
+             * Menus with a static content can skip drawing (and swapping buffers) when it returns false.
+             */
+            bool dirty() const;
 
             /** @brief Will update the gui with the events and send the right action (gui::Widget::Action) to the main widget. */
             void update(const events::Events& ev);
@@ -51,6 +56,7 @@ namespace gui
         private:
             bool m_tofree;             /**< @brief Indicates if the main widget must be free'd. */
             bool m_focus;              /**< @brief Indicates if the gui has focus. */
+            bool m_dirty;              /**< @brief Indicates if the gui must be drawn again, regardless of the widgets state. */
             Widget* m_main;            /**< @brief The main widget. */
             geometry::Point m_pos;     /**< @brief The ppos of the gui part. */
             graphics::Graphics* m_gfx; /**< @brief The graphics instance used. */
@@ -84,6 +84,7 @@ namespace gui
 
     void Image::updatePosRect()
     {
+        damage();
         if(m_name.empty())
             return;
 
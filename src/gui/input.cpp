@@ -55,6 +55,17 @@ namespace gui
         m_txt.draw();
     }
 
+    bool Input::dirty() const
+    {
+        return Widget::dirty() || m_txt.dirty();
+    }
+
+    void Input::clean()
+    {
+        Widget::clean();
+        m_txt.clean();
+    }
+
     void Input::focus(bool f)
     {
         m_txt.focus(f);
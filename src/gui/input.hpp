@@ -29,6 +29,8 @@ namespace gui
 
             void setFont(const std::string& font, float size = -1.0f);
             virtual void draw();
+            virtual bool dirty() const;
+            virtual void clean();
 
             virtual void focus(bool f);
             virtual void inputText(const std::string& in);
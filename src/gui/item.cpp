@@ -187,6 +187,22 @@ namespace gui
             m_gfx->pop();
         }
 
+        bool Item::animated() const
+        {
+            if(m_state != Focused)
+                return false;
+
+            /* Same computation as in draw. */
+            Uint32 t = SDL_GetTicks();
+            if(m_rext && t - m_lastSel > 2000) {
+                size_t b = (t - m_lastSel - 2000) / 250;
+                b %= std::max(m_text.size(), (size_t)1);
+                return b != m_lbound;
+            }
+            else
+                return !m_rext && m_lbound != 0;
+        }
+
         void Item::setPart(Part p, State state, const std::string& path)
         {
             m_texts[(unsigned short)state][(unsigned short)p] = path;
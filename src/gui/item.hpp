@@ -64,6 +64,8 @@ namespace gui
 
                 /** @brief Draw the item around the actual origin. */
                 void draw();
+                /** @brief Indicates if the automatic scrolling of the text would change what is drawn. */
+                bool animated() const;
 
                 /** @brief The textures used. */
                 enum Part : unsigned short {
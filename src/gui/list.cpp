@@ -56,6 +56,7 @@ namespace gui
     void List::setItem(List::ItemID id, const std::string& text)
     {
         m_items[posFromID(id)].it->text(text);
+        damage();
     }
 
     void List::setData(ItemID id, void* data)
@@ -143,6 +144,17 @@ namespace gui
         m_gfx->pop();
     }
 
+    bool List::dirty() const
+    {
+        /* Only the selected item can be automatically scrolled. */
+        if(Widget::dirty())
+            return true;
+        else if(m_selected < m_items.size())
+            return m_items[m_selected].it->animated();
+        else
+            return false;
+    }
+
     bool List::action(Widget::Action a)
     {
         switch(a) {
@@ -209,6 +221,7 @@ namespace gui
 
     void List::updateState()
     {
+        damage();
         if(m_items.empty())
             return;
         size_t nb = (unsigned int)(height() / (m_itemSize.height * 1.2f));
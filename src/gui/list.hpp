@@ -87,6 +87,7 @@ namespace gui
 
             /* Drawing */
             virtual void draw();
+            virtual bool dirty() const;
 
             /* Events */
             virtual bool action(Widget::Action a);
@@ -136,6 +136,17 @@ namespace gui
         m_box.draw();
     }
 
+    bool Radio::dirty() const
+    {
+        return Widget::dirty() || m_box.dirty();
+    }
+
+    void Radio::clean()
+    {
+        Widget::clean();
+        m_box.clean();
+    }
+
     void Radio::focus(bool f)
     {
         m_box.focus(f);
@@ -66,6 +66,8 @@ namespace gui
             /** @brief Disable the use of a max size. */
             void disableMaxSize();
             virtual void draw();
+            virtual bool dirty() const;
+            virtual void clean();
 
             /* Actions */
             virtual void focus(bool f);
@@ -28,6 +28,7 @@ namespace gui
             return;
         m_selSize = s;
         m_selPos  = p;
+        damage();
     }
 
     void ScrollBar::moveTo(float p)
@@ -35,6 +36,7 @@ namespace gui
         if(p <= 0.0f)
             return;
         m_selPos = p;
+        damage();
     }
 
     float ScrollBar::selPos() const
@@ -143,6 +145,7 @@ namespace gui
     void ScrollBar::focus(bool f)
     {
         m_focus = (f ? 1 : 0);
+        damage();
     }
 
     bool ScrollBar::action(Widget::Action a)
@@ -16,12 +16,14 @@ namespace gui
         m_txt = txt;
         m_lines = cutToReturn(m_txt);
         shrinkLines();
+        damage();
     }
 
     void Text::addText(const std::string& txt)
     {
         size_t idx = m_lines.size();
         m_txt += txt;
+        damage();
         std::vector<std::string> nlines = cutToReturn(txt);
         if(!nlines.empty()) {
             if(!m_lines.empty()) {
@@ -44,6 +46,7 @@ namespace gui
     {
         m_oneline = en;
         shrinkLines();
+        damage();
         return m_oneline;
     }
 
@@ -97,6 +100,7 @@ namespace gui
         m_pts = size;
         shrinkLines();
         computeSize();
+        damage();
     }
 
     void Text::draw()
@@ -4,7 +4,7 @@
 namespace gui
 {
     Widget::Widget(graphics::Graphics* gfx)
-        : m_gfx(gfx), m_width(0), m_height(0)
+        : m_gfx(gfx), m_width(0), m_height(0), m_dirty(true)
     {}
 
     Widget::~Widget()
@@ -13,12 +13,14 @@ namespace gui
     float Widget::width(float w)
     {
         m_width = w;
+        damage();
         return m_width;
     }
 
     float Widget::height(float h)
     {
         m_height = h;
+        damage();
         return m_height;
     }
 
@@ -45,6 +47,21 @@ namespace gui
         return false;
     }
 
+    bool Widget::dirty() const
+    {
+        return m_dirty;
+    }
+
+    void Widget::damage()
+    {
+        m_dirty = true;
+    }
+
+    void Widget::clean()
+    {
+        m_dirty = false;
+    }
+
 }
 
 
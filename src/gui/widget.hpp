@@ -54,6 +54,19 @@ namespace gui
              * @return True if the action was handled. */
             virtual bool action(Action);
 
+            /** @brief Indicates if the widget changed since it was last drawn, and must be drawn again.
+             *
+             * Widgets containing other widgets or animated ones must override it.
+             */
+            virtual bool dirty() const;
+            /** @brief Marks the widget as needing to be drawn again. */
+            void damage();
+            /** @brief Marks the widget as drawn : called by gui::Gui after drawing.
+             *
+             * Widgets containing other widgets must override it to clean them too.
+             */
+            virtual void clean();
+
         protected:
             /** @brief The graphics::Graphics instance used by the widget. */
             graphics::Graphics* m_gfx;
@@ -61,6 +74,7 @@ namespace gui
         private:
             /* PRIVATE use accessors to access */
             float m_width, m_height;
+            bool m_dirty; /**< @brief Has the widget changed since last drawn. */
 
     };
 }
@@ -1,12 +1,11 @@
 
 #include "charaExposure.hpp"
+#include "physics/unit_conversions.hpp"
 
 namespace lua
 {
     namespace exposure
     {
-        gameplay::Character* characters[4];
-
         const char* Character::className = "Character";
         const Script::Methods<Character> Character::methods[] = {
             {"current",     &Character::setUsed},
@@ -24,15 +23,24 @@ namespace lua
             {"damage",      &Character::damage},
             {"stun",        &Character::stun},
             {"impact",      &Character::impact},
+            {"query",       &Character::query},
+            {"overlap",     &Character::overlap},
+            {"raycast",     &Character::raycast},
             {NULL, NULL}
         };
         const Script::Properties<Character> Character::properties[] = {
             {NULL, NULL, NULL}
         };
 
-        void Character::expose(Script* scr)
+        void Character::expose(Script* scr, gameplay::Character* chars[4])
         {
             scr->registerClass<Character>();
+            scr->setContext(chars);
+            /* The types of entities filtering the spatial queries, which can be added. */
+            scr->setVariable("typeCharacter", physics::Entity::Type::Character);
+            scr->setVariable("typeAttack",    physics::Entity::Type::Attack);
+            scr->setVariable("typePlatform",  physics::Entity::Type::Platform);
+            scr->setVariable("typeObstacle",  physics::Entity::Type::Obstacle);
         }
 
         int Character::size(lua_State* st)
@@ -42,7 +50,7 @@ namespace lua
                     || args[0] != Script::NUMBER
                     || args[1] != Script::NUMBER)
                 return 0;
-            characters[m_char]->phSize(geometry::AABB((float)lua_tonumber(st, 1), (float)lua_tonumber(st, 2)));
+            m_chars[m_char]->phSize(geometry::AABB((float)lua_tonumber(st, 1), (float)lua_tonumber(st, 2)));
             return 0;
         }
 
@@ -52,7 +60,7 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::NUMBER)
                 return 0;
-            characters[m_char]->phWeight((float)lua_tonumber(st, 1));
+            m_chars[m_char]->phWeight((float)lua_tonumber(st, 1));
             return 0;
         }
 
@@ -62,13 +70,13 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::NUMBER)
                 return 0;
-            characters[m_char]->setManaMax((unsigned int)lua_tonumber(st, 1));
+            m_chars[m_char]->setManaMax((unsigned int)lua_tonumber(st, 1));
             return 0;
         }
 
         int Character::onGround(lua_State* st)
         {
-            return helper::returnBoolean(st, characters[m_char]->onGround());
+            return helper::returnBoolean(st, m_chars[m_char]->onGround());
         }
 
         int Character::requireMana(lua_State* st)
@@ -77,7 +85,7 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::NUMBER)
                 return 0;
-            return helper::returnBoolean(st, characters[m_char]->requireMana((unsigned int)lua_tonumber(st, 1)));
+            return helper::returnBoolean(st, m_chars[m_char]->requireMana((unsigned int)lua_tonumber(st, 1)));
         }
 
         int Character::flip(lua_State* st)
@@ -86,7 +94,7 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::BOOL)
                 return 0;
-            characters[m_char]->setFlip(lua_toboolean(st, 1));
+            m_chars[m_char]->setFlip(lua_toboolean(st, 1));
             return 0;
         }
                 
@@ -112,7 +120,7 @@ namespace lua
                     || args[0] != Script::NUMBER
                     || args[1] != Script::NUMBER)
                 return 0;
-            physics::Entity* ent = characters[m_char]->entity();
+            physics::Entity* ent = m_chars[m_char]->entity();
             ent->applyForce((float)lua_tonumber(st, 1), (float)lua_tonumber(st, 2));
             return 0;
         }
@@ -124,7 +132,7 @@ namespace lua
                     || args[0] != Script::NUMBER
                     || args[1] != Script::NUMBER)
                 return 0;
-            physics::Entity* ent = characters[m_char]->entity();
+            physics::Entity* ent = m_chars[m_char]->entity();
             ent->applyLinearImpulse((float)lua_tonumber(st, 1), (float)lua_tonumber(st, 2));
             return 0;
         }
@@ -136,7 +144,7 @@ namespace lua
                     || args[0] != Script::NUMBER
                     || args[1] != Script::NUMBER)
                 return 0;
-            physics::Entity* ent = characters[m_char]->entity();
+            physics::Entity* ent = m_chars[m_char]->entity();
             ent->setLinearVelocity((float)lua_tonumber(st, 1), (float)lua_tonumber(st, 2));
             return 0;
         }
@@ -147,7 +155,7 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::NUMBER)
                 return 0;
-            characters[m_char]->stun((unsigned int)lua_tointeger(st, 1), currentChar(st));
+            m_chars[m_char]->stun((unsigned int)lua_tointeger(st, 1), currentChar(st));
             return 0;
         }
 
@@ -167,7 +175,7 @@ namespace lua
             gameplay::Character* act = currentChar(st);
             if(act && act->flipped())
                 x *= -1.0f;
-            characters[m_char]->impact(x, y, act, fixe);
+            m_chars[m_char]->impact(x, y, act, fixe);
             return 0;
         }
                 
@@ -177,7 +185,7 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::NUMBER)
                 return 0;
-            characters[m_char]->inflictDamages((int)lua_tointeger(st, 1), currentChar(st));
+            m_chars[m_char]->inflictDamages((int)lua_tointeger(st, 1), currentChar(st));
             return 0;
         }
 
@@ -197,7 +205,7 @@ namespace lua
             bool grav = false;
             if(args.size() == 8)
                 grav = lua_toboolean(st, 8);
-            bool ret = characters[m_char]->createAttack(geometry::AABB((float)lua_tonumber(st, 1), (float)lua_tonumber(st, 2)),
+            bool ret = m_chars[m_char]->createAttack(geometry::AABB((float)lua_tonumber(st, 1), (float)lua_tonumber(st, 2)),
                     lua_toboolean(st, 3), lua_tostring(st, 4), lua_tostring(st, 5),
                     lua_tostring(st, 6), lua_tostring(st, 7), grav);
             return helper::returnBoolean(st, ret);
@@ -209,18 +217,112 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::NUMBER)
                 return 0;
-            characters[m_char]->setManaRecov((float)lua_tonumber(st,1));
+            m_chars[m_char]->setManaRecov((float)lua_tonumber(st,1));
             return 0;
         }
                 
+        int Character::query(lua_State* st)
+        {
+            return area(st, false);
+        }
+
+        int Character::overlap(lua_State* st)
+        {
+            return area(st, true);
+        }
+
+        int Character::raycast(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(!(args.size() == 2
+                        || (args.size() == 3 && args[2] == Script::NUMBER))
+                    || args[0] != Script::NUMBER
+                    || args[1] != Script::NUMBER)
+                return helper::returnBoolean(st, false);
+            uint16 types = physics::Entity::Type::All;
+            if(args.size() == 3)
+                types = (uint16)lua_tointeger(st, 3);
+
+            physics::Entity* ent = m_chars[m_char]->entity();
+            geometry::Point pos = ent->getPosition();
+            geometry::Point to(pos.x + (float)lua_tonumber(st, 1), pos.y + (float)lua_tonumber(st, 2));
+            physics::World::RayHit hit;
+            if(!m_chars[m_char]->world()->raycast(pos, to, &hit, types, ent))
+                return helper::returnBoolean(st, false);
+
+            lua_pushinteger(st, hit.entity->getType());
+            lua_pushnumber(st, hit.point.x - pos.x);
+            lua_pushnumber(st, hit.point.y - pos.y);
+            lua_pushinteger(st, entityID(hit.entity));
+            lua_pushnumber(st, hit.fraction);
+            return 5;
+        }
+
+        int Character::area(lua_State* st, bool shapes)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(!(args.size() == 4
+                        || (args.size() == 5 && args[4] == Script::NUMBER))
+                    || args[0] != Script::NUMBER
+                    || args[1] != Script::NUMBER
+                    || args[2] != Script::NUMBER
+                    || args[3] != Script::NUMBER)
+                return helper::returnBoolean(st, false);
+            uint16 types = physics::Entity::Type::All;
+            if(args.size() == 5)
+                types = (uint16)lua_tointeger(st, 5);
+
+            physics::Entity* ent = m_chars[m_char]->entity();
+            physics::World* world = m_chars[m_char]->world();
+            geometry::Point pos = ent->getPosition();
+            geometry::Point center(pos.x + (float)lua_tonumber(st, 1), pos.y + (float)lua_tonumber(st, 2));
+            geometry::AABB rect((float)lua_tonumber(st, 3), (float)lua_tonumber(st, 4));
+            m_found.clear();
+            m_foundFixtures.clear();
+            if(shapes)
+                world->overlap(center, rect, m_found, types, ent, &m_foundFixtures);
+            else
+                world->queryAABB(center, rect, m_found, types, ent, &m_foundFixtures);
+
+            /* A flat array of numbers : no table nor string per entity. */
+            lua_createtable(st, (int)m_found.size() * 4, 0);
+            int idx = 1;
+            for(size_t i = 0; i < m_found.size(); ++i) {
+                physics::Entity* found = m_found[i];
+                geometry::Point fpos = found->getPosition();
+                /* A baked entity is at the origin : each of its fixtures is a shape, reported at its center. */
+                if(found->baked()) {
+                    b2AABB box;
+                    m_foundFixtures[i]->GetShape()->ComputeAABB(&box, found->getBody()->GetTransform(), 0);
+                    fpos = geometry::Point(physics::toPixels(box.GetCenter().x), physics::toPixels(box.GetCenter().y));
+                }
+                lua_pushinteger(st, found->getType());
+                lua_rawseti(st, -2, idx++);
+                lua_pushnumber(st, fpos.x - pos.x);
+                lua_rawseti(st, -2, idx++);
+                lua_pushnumber(st, fpos.y - pos.y);
+                lua_rawseti(st, -2, idx++);
+                lua_pushinteger(st, entityID(found));
+                lua_rawseti(st, -2, idx++);
+            }
+            return 1;
+        }
+
+        int Character::entityID(physics::Entity* ent)
+        {
+            if(ent->getType() != physics::Entity::Type::Character)
+                return -1;
+            return static_cast<physics::Character*>(ent)->getID();
+        }
+
         gameplay::Character* Character::currentChar(lua_State* st) const
         {
             gameplay::Character* ret = NULL;
             lua_getglobal(st, "characterID");
             if(lua_isnumber(st, -1)) {
                 int id = (int)lua_tointeger(st, -1);
-                if(id >= 0 && id < 4)
-                    ret = characters[id];
+                if(m_chars && id >= 0 && id < 4)
+                    ret = m_chars[id];
             }
             lua_pop(st, 1);
             return ret;
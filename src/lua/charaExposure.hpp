@@ -10,16 +10,13 @@ namespace lua
 {
     namespace exposure
     {
-        /** @brief The characters exposed to lua. */
-        extern gameplay::Character* characters[4];
-
         /** @brief The exposition of the gameplay::Character class to lua. */
         class Character
         {
             public:
-                Character() : isPrecious(false)
+                Character() : isPrecious(false), m_char(0), m_chars(NULL)
             {}
-                Character(lua_State*) : isPrecious(false)
+                Character(lua_State* st) : isPrecious(false), m_char(0), m_chars(Script::context<gameplay::Character*>(st))
             {}
 
                 /* Lua exposure. */
@@ -28,7 +25,8 @@ namespace lua
                 static const Script::Properties<Character> properties[];
                 bool isExisting;
                 bool isPrecious;
-                static void expose(Script* scr);
+                /** @brief Exposes the class to a script, whose objects will act on the 4 characters of chars, which must outlive it. */
+                static void expose(Script* scr, gameplay::Character* chars[4]);
 
                 /* Methods to expose. */
                 int setUsed(lua_State* st); /**< @brief Set the character to use (c in [0-3]). */
@@ -46,6 +44,20 @@ namespace lua
                 int velocity(lua_State* st);
                 int attack(lua_State* st);
 
+                /* Spatial queries, around the character used : the coordinates are relative to its center. */
+                /** @brief query(x, y, w, h [, types]) : the entities whose bounding box overlaps the rectangle.
+                 * Returns a flat array with 4 numbers per entity : its type, x, y and the character id (-1 if not a character).
+                 * The baked platforms and obstacles are reported once per fixture, at its center.
+                 * Returns false if the arguments are invalid, as raycast.
+                 */
+                int query(lua_State* st);
+                /** @brief overlap(x, y, w, h [, types]) : like query, with the entities really overlapping the rectangle. */
+                int overlap(lua_State* st);
+                /** @brief raycast(x, y [, types]) : casts a ray from the center to (x, y).
+                 * Returns false if nothing is hit or the arguments are invalid, else the type, x, y, character id and fraction of the first hit.
+                 */
+                int raycast(lua_State* st);
+
                 /* CCs */
                 int damage(lua_State* st);
                 int stun(lua_State* st);
@@ -53,8 +65,17 @@ namespace lua
 
             private:
                 int m_char; /**< @brief The character to use [0-3]. */
+                gameplay::Character** m_chars; /**< @brief The characters of the match of the script. */
                 /** @brief Get the current character from characterID value (NULL if none). */
                 gameplay::Character* currentChar(lua_State* st) const;
+                /** @brief The entities found by the last query, kept to avoid allocations. */
+                std::vector<physics::Entity*> m_found;
+                /** @brief The fixture found of each entity of m_found. */
+                std::vector<b2Fixture*> m_foundFixtures;
+                /** @brief Shared by query and overlap : reads the arguments and returns the flat array of the entities found. */
+                int area(lua_State* st, bool shapes);
+                /** @brief Returns the character id of an entity, -1 if it is not a character. */
+                static int entityID(physics::Entity* ent);
         };
     }
 }
@@ -15,6 +15,7 @@ namespace lua
             {"delete",      &Graphics::deleteNamespace},
             {"enter",       &Graphics::enterNamespace},
             {"loadTexture", &Graphics::loadTexture},
+            {"loadTiled",   &Graphics::loadTiledTexture},
             {"loadMovie",   &Graphics::loadMovie},
             {"loadFont",    &Graphics::loadFont},
             {"exists",      &Graphics::existsEntity},
@@ -22,37 +23,61 @@ namespace lua
             {"link",        &Graphics::link},
             {"hotpoint",    &Graphics::setTextureHotPoint},
             {"rewind",      &Graphics::rewindMovie},
+            {"particles",   &Graphics::createParticles},
+            {"partTexture", &Graphics::particlesTexture},
+            {"emitter",     &Graphics::particlesPosition},
+            {"partRate",    &Graphics::particlesRate},
+            {"partLife",    &Graphics::particlesLife},
+            {"partVelocity",&Graphics::particlesVelocity},
+            {"partGravity", &Graphics::particlesGravity},
+            {"partTint",    &Graphics::particlesTint},
+            {"partSize",    &Graphics::particlesSizeCurve},
+            {"partAlpha",   &Graphics::particlesAlphaCurve},
+            {"burst",       &Graphics::burstParticles},
             {"rotate",      &Graphics::rotate},
             {"scale",       &Graphics::scale},
             {"move",        &Graphics::move},
             {"identity",    &Graphics::identity},
             {"push",        &Graphics::push},
             {"pop",         &Graphics::pop},
+            {"visible",     &Graphics::visibleRect},
+            {"isVisible",   &Graphics::isVisible},
+            {"cullStats",   &Graphics::cullStats},
             {"blit",        &Graphics::blitTexture},
             {"drawRect",    &Graphics::drawAABB},
             {"drawText",    &Graphics::drawText},
             {"play",        &Graphics::play},
+            {"drawParticles", &Graphics::drawParticles},
             {NULL, NULL}
         };
         const Script::Properties<Graphics> Graphics::properties[] = {
             {NULL, NULL, NULL}
         };
                 
-        void Graphics::expose(Script* scr)
+        void Graphics::expose(Script* scr, graphics::Graphics* gfx)
         {
             scr->registerClass<Graphics>();
+            scr->setContext(gfx);
         }
 
-        /* static members and methods */
-        graphics::Graphics* Graphics::m_gfx = NULL;
-        void Graphics::setGraphicsInstance(graphics::Graphics* gfx)
+        /** @brief Reads a lua array of numbers at index idx of the stack. */
+        static std::vector<float> readCurve(lua_State* st, int idx)
         {
-            m_gfx = gfx;
+            std::vector<float> keys;
+            size_t size = lua_rawlen(st, idx);
+            keys.reserve(size);
+            for(size_t i = 1; i <= size; ++i) {
+                lua_rawgeti(st, idx, (int)i);
+                if(lua_isnumber(st, -1))
+                    keys.push_back((float)lua_tonumber(st, -1));
+                lua_pop(st, 1);
+            }
+            return keys;
         }
 
         /* Methods */
-        Graphics::Graphics(lua_State*)
-            : isPrecious(false)
+        Graphics::Graphics(lua_State* st)
+            : isPrecious(false), m_gfx(Script::context<graphics::Graphics>(st))
         {}
 
         int Graphics::enterNamespace(lua_State* st)
@@ -61,6 +86,8 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::STRING)
                 return 0;
+            if(!m_gfx)
+                return helper::returnBoolean(st, true);
             bool ret = m_gfx->enterNamespace(lua_tostring(st, 1));
             return helper::returnBoolean(st, ret);
         }
@@ -71,6 +98,8 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::STRING)
                 return 0;
+            if(!m_gfx)
+                return helper::returnBoolean(st, true);
             bool ret = m_gfx->createNamespace(lua_tostring(st, 1));
             return helper::returnBoolean(st, ret);
         }
@@ -81,12 +110,16 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::STRING)
                 return 0;
+            if(!m_gfx)
+                return 0;
             m_gfx->deleteNamespace(lua_tostring(st, 1));
             return 0;
         }
 
         int Graphics::actualNamespace(lua_State* st)
         {
+            if(!m_gfx)
+                return helper::returnString(st, "/");
             return helper::returnString(st, m_gfx->actualNamespace());
         }
 
@@ -97,18 +130,43 @@ namespace lua
                     || args[0] != Script::STRING
                     || args[1] != Script::STRING)
                 return 0;
+            if(!m_gfx)
+                return helper::returnBoolean(st, true);
             bool ret = m_gfx->loadTexture(lua_tostring(st, 1), lua_tostring(st, 2));
             return helper::returnBoolean(st, ret);
         }
 
+        int Graphics::loadTiledTexture(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() < 2 || args.size() > 3
+                    || args[0] != Script::STRING
+                    || args[1] != Script::STRING
+                    || (args.size() == 3 && args[2] != Script::NUMBER))
+                return 0;
+            int tile = 512;
+            if(args.size() == 3)
+                tile = (int)lua_tonumber(st, 3);
+            if(!m_gfx)
+                return helper::returnBoolean(st, true);
+            bool ret = m_gfx->loadTiledTexture(lua_tostring(st, 1), lua_tostring(st, 2), tile);
+            return helper::returnBoolean(st, ret);
+        }
+
         int Graphics::loadMovie(lua_State* st)
         {
             std::vector<Script::VarType> args = helper::listArguments(st);
-            if(args.size() != 2
+            if(args.size() < 2 || args.size() > 3
                     || args[0] != Script::STRING
-                    || args[1] != Script::STRING)
+                    || args[1] != Script::STRING
+                    || (args.size() == 3 && args[2] != Script::BOOL))
                 return 0;
-            bool ret = m_gfx->loadMovie(lua_tostring(st, 1), lua_tostring(st, 2));
+            bool cache = false;
+            if(args.size() == 3)
+                cache = lua_toboolean(st, 3);
+            if(!m_gfx)
+                return helper::returnBoolean(st, true);
+            bool ret = m_gfx->loadMovie(lua_tostring(st, 1), lua_tostring(st, 2), cache);
             return helper::returnBoolean(st, ret);
         }
 
@@ -119,6 +177,8 @@ namespace lua
                     || args[0] != Script::STRING
                     || args[1] != Script::STRING)
                 return 0;
+            if(!m_gfx)
+                return helper::returnBoolean(st, true);
             bool ret = m_gfx->loadFont(lua_tostring(st, 1), lua_tostring(st, 2));
             return helper::returnBoolean(st, ret);
         }
@@ -129,6 +189,8 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::STRING)
                 return 0;
+            if(!m_gfx)
+                return helper::returnBoolean(st, false);
             graphics::Graphics::RcType rct = m_gfx->rctype(lua_tostring(st, 1));
             return helper::returnBoolean(st, (rct != graphics::Graphics::NONE));
         }
@@ -139,6 +201,8 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::STRING)
                 return 0;
+            if(!m_gfx)
+                return 0;
             m_gfx->free(lua_tostring(st, 1));
             return 0;
         }
@@ -150,6 +214,8 @@ namespace lua
                     || args[0] != Script::STRING
                     || args[1] != Script::STRING)
                 return 0;
+            if(!m_gfx)
+                return helper::returnBoolean(st, true);
             bool ret = m_gfx->link(lua_tostring(st, 1), lua_tostring(st, 2));
             return helper::returnBoolean(st, ret);
         }
@@ -162,6 +228,8 @@ namespace lua
                     || args[1] != Script::NUMBER
                     || args[2] != Script::NUMBER)
                 return 0;
+            if(!m_gfx)
+                return helper::returnBoolean(st, true);
             bool ret = m_gfx->setTextureHotpoint(lua_tostring(st, 1), (int)lua_tointeger(st, 2), (int)lua_tointeger(st, 3));
             return helper::returnBoolean(st, ret);
         }
@@ -172,16 +240,196 @@ namespace lua
             if(args.size() != 1
                     || args[0] != Script::STRING)
                 return 0;
+            if(!m_gfx)
+                return 0;
             m_gfx->rewindMovie(lua_tostring(st, 1));
             return 0;
         }
 
+        int Graphics::createParticles(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() != 3
+                    || args[0] != Script::STRING  /* name */
+                    || args[1] != Script::STRING  /* texture */
+                    || args[2] != Script::NUMBER  /* max */
+                    || lua_tointeger(st, 3) <= 0)
+                return 0;
+            if(!m_gfx)
+                return helper::returnBoolean(st, true);
+            bool ret = m_gfx->createParticles(lua_tostring(st, 1), lua_tostring(st, 2), (size_t)lua_tointeger(st, 3));
+            return helper::returnBoolean(st, ret);
+        }
+
+        int Graphics::particlesTexture(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() != 2
+                    || args[0] != Script::STRING
+                    || args[1] != Script::STRING)
+                return 0;
+            if(!m_gfx)
+                return 0;
+            m_gfx->particlesTexture(lua_tostring(st, 1), lua_tostring(st, 2));
+            return 0;
+        }
+
+        int Graphics::particlesPosition(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() != 3
+                    || args[0] != Script::STRING
+                    || args[1] != Script::NUMBER
+                    || args[2] != Script::NUMBER)
+                return 0;
+            if(!m_gfx)
+                return 0;
+            m_gfx->particlesPosition(lua_tostring(st, 1), geometry::Point((float)lua_tonumber(st, 2), (float)lua_tonumber(st, 3)));
+            return 0;
+        }
+
+        int Graphics::particlesRate(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() != 2
+                    || args[0] != Script::STRING
+                    || args[1] != Script::NUMBER)
+                return 0;
+            if(!m_gfx)
+                return 0;
+            m_gfx->particlesRate(lua_tostring(st, 1), (float)lua_tonumber(st, 2));
+            return 0;
+        }
+
+        int Graphics::particlesLife(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() < 2
+                    || args[0] != Script::STRING
+                    || args[1] != Script::NUMBER)
+                return 0;
+
+            float minl = (float)lua_tonumber(st, 2);
+            float maxl = minl;
+            if(args.size() >= 3 && args[2] == Script::NUMBER)
+                maxl = (float)lua_tonumber(st, 3);
+
+            if(!m_gfx)
+                return 0;
+            m_gfx->particlesLife(lua_tostring(st, 1), minl, maxl);
+            return 0;
+        }
+
+        int Graphics::particlesVelocity(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() < 4
+                    || args[0] != Script::STRING  /* name */
+                    || args[1] != Script::NUMBER  /* angle */
+                    || args[2] != Script::NUMBER  /* spread */
+                    || args[3] != Script::NUMBER) /* min speed */
+                return 0;
+
+            float mins = (float)lua_tonumber(st, 4);
+            float maxs = mins;
+            if(args.size() >= 5 && args[4] == Script::NUMBER)
+                maxs = (float)lua_tonumber(st, 5);
+
+            if(!m_gfx)
+                return 0;
+            m_gfx->particlesVelocity(lua_tostring(st, 1), (float)lua_tonumber(st, 2), (float)lua_tonumber(st, 3), mins, maxs);
+            return 0;
+        }
+
+        int Graphics::particlesGravity(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() != 3
+                    || args[0] != Script::STRING
+                    || args[1] != Script::NUMBER
+                    || args[2] != Script::NUMBER)
+                return 0;
+            if(!m_gfx)
+                return 0;
+            m_gfx->particlesGravity(lua_tostring(st, 1), (float)lua_tonumber(st, 2), (float)lua_tonumber(st, 3));
+            return 0;
+        }
+
+        int Graphics::particlesTint(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() < 4
+                    || args[0] != Script::STRING
+                    || args[1] != Script::NUMBER
+                    || args[2] != Script::NUMBER
+                    || args[3] != Script::NUMBER)
+                return 0;
+
+            graphics::Color col((Uint8)lua_tointeger(st, 2), (Uint8)lua_tointeger(st, 3), (Uint8)lua_tointeger(st, 4));
+            if(args.size() >= 5 && args[4] == Script::NUMBER)
+                col.a = (Uint8)lua_tointeger(st, 5);
+
+            if(!m_gfx)
+                return 0;
+            m_gfx->particlesTint(lua_tostring(st, 1), col);
+            return 0;
+        }
+
+        int Graphics::particlesSizeCurve(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() != 2
+                    || args[0] != Script::STRING
+                    || args[1] != Script::TABLE)
+                return 0;
+            if(!m_gfx)
+                return 0;
+            m_gfx->particlesSizeCurve(lua_tostring(st, 1), readCurve(st, 2));
+            return 0;
+        }
+
+        int Graphics::particlesAlphaCurve(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() != 2
+                    || args[0] != Script::STRING
+                    || args[1] != Script::TABLE)
+                return 0;
+            if(!m_gfx)
+                return 0;
+            m_gfx->particlesAlphaCurve(lua_tostring(st, 1), readCurve(st, 2));
+            return 0;
+        }
+
+        int Graphics::burstParticles(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() < 2
+                    || args[0] != Script::STRING
+                    || args[1] != Script::NUMBER
+                    || lua_tointeger(st, 2) <= 0)
+                return 0;
+            if(!m_gfx)
+                return helper::returnNumber(st, 0.0);
+
+            /* The position of the emitter can be given with the burst. */
+            if(args.size() >= 4
+                    && args[2] == Script::NUMBER
+                    && args[3] == Script::NUMBER)
+                m_gfx->particlesPosition(lua_tostring(st, 1), geometry::Point((float)lua_tonumber(st, 3), (float)lua_tonumber(st, 4)));
+
+            size_t ret = m_gfx->burstParticles(lua_tostring(st, 1), (size_t)lua_tointeger(st, 2));
+            return helper::returnNumber(st, (double)ret);
+        }
+
         int Graphics::rotate(lua_State* st)
         {
             std::vector<Script::VarType> args = helper::listArguments(st);
             if(args.size() != 1
                     || args[0] != Script::NUMBER)
                 return 0;
+            if(!m_gfx)
+                return 0;
             m_gfx->rotate((float)lua_tonumber(st, 1));
             return 0;
         }
@@ -193,6 +441,8 @@ namespace lua
                     || args[0] != Script::NUMBER
                     || args[1] != Script::NUMBER)
                 return 0;
+            if(!m_gfx)
+                return 0;
             m_gfx->scale((float)lua_tonumber(st, 1), (float)lua_tonumber(st, 2));
             return 0;
         }
@@ -204,34 +454,81 @@ namespace lua
                     || args[0] != Script::NUMBER
                     || args[1] != Script::NUMBER)
                 return 0;
+            if(!m_gfx)
+                return 0;
             m_gfx->move((float)lua_tonumber(st, 1), (float)lua_tonumber(st, 2));
             return 0;
         }
 
         int Graphics::identity(lua_State*)
         {
+            if(!m_gfx)
+                return 0;
             m_gfx->identity();
             return 0;
         }
 
         int Graphics::push(lua_State*)
         {
+            if(!m_gfx)
+                return 0;
             m_gfx->push();
             return 0;
         }
 
         int Graphics::pop(lua_State*)
         {
+            if(!m_gfx)
+                return 0;
             m_gfx->pop();
             return 0;
         }
 
+        int Graphics::visibleRect(lua_State* st)
+        {
+            if(!m_gfx)
+                return 0;
+            std::pair<geometry::AABB,geometry::Point> rect = m_gfx->visibleRect();
+            lua_pushnumber(st, rect.second.x);
+            lua_pushnumber(st, rect.second.y);
+            lua_pushnumber(st, rect.first.width);
+            lua_pushnumber(st, rect.first.height);
+            return 4;
+        }
+
+        int Graphics::isVisible(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() != 4
+                    || args[0] != Script::NUMBER
+                    || args[1] != Script::NUMBER
+                    || args[2] != Script::NUMBER
+                    || args[3] != Script::NUMBER)
+                return 0;
+            geometry::Point pos((float)lua_tonumber(st, 1), (float)lua_tonumber(st, 2));
+            geometry::AABB rect((float)lua_tonumber(st, 3), (float)lua_tonumber(st, 4));
+            if(!m_gfx)
+                return helper::returnBoolean(st, false);
+            return helper::returnBoolean(st, m_gfx->isVisible(pos, rect));
+        }
+
+        int Graphics::cullStats(lua_State* st)
+        {
+            if(!m_gfx)
+                return 0;
+            lua_pushnumber(st, m_gfx->cullTested());
+            lua_pushnumber(st, m_gfx->cullCulled());
+            return 2;
+        }
+
         int Graphics::blitTexture(lua_State* st)
         {
             std::vector<Script::VarType> args = helper::listArguments(st);
             if(args.size() != 1
                     || args[0] != Script::STRING)
                 return 0;
+            if(!m_gfx)
+                return 0;
             m_gfx->blitTexture(lua_tostring(st, 1), geometry::Point(0.0f, 0.0f));
             return 0;
         }
@@ -252,6 +549,8 @@ namespace lua
             if(args.size() >= 5 && args[4] == Script::NUMBER)
                 repeatY = (float)lua_tonumber(st, 5);
 
+            if(!m_gfx)
+                return 0;
             m_gfx->draw(geometry::AABB((float)lua_tonumber(st, 2), (float)lua_tonumber(st, 3)), lua_tostring(st, 1), repeatX, repeatY);
             return 0;
         }
@@ -268,6 +567,8 @@ namespace lua
             if(args.size() >= 3 && args[2] == Script::NUMBER)
                 pts = (float)lua_tonumber(st, 3);
 
+            if(!m_gfx)
+                return 0;
             m_gfx->draw(lua_tostring(st, 1), lua_tostring(st, 2), pts);
             return 0;
         }
@@ -285,10 +586,24 @@ namespace lua
             if(args.size() > 4 && args[3] == Script::BOOL)
                 ratio = lua_toboolean(st, 4);
 
+            if(!m_gfx)
+                return helper::returnBoolean(st, true);
             bool ret = m_gfx->play(lua_tostring(st, 1), geometry::AABB((float)lua_tonumber(st, 2), (float)lua_tonumber(st, 3)), ratio);
             return helper::returnBoolean(st, ret);
         }
 
+        int Graphics::drawParticles(lua_State* st)
+        {
+            std::vector<Script::VarType> args = helper::listArguments(st);
+            if(args.size() != 1
+                    || args[0] != Script::STRING)
+                return 0;
+            if(!m_gfx)
+                return helper::returnNumber(st, 0.0);
+            size_t ret = m_gfx->drawParticles(lua_tostring(st, 1));
+            return helper::returnNumber(st, (double)ret);
+        }
+
     }
 }
 
@@ -13,8 +13,7 @@ namespace lua
         class Graphics
         {
             public:
-                Graphics(lua_State*);
-                static void setGraphicsInstance(graphics::Graphics* gfx);
+                Graphics(lua_State* st);
 
                 /* Lua exposure */
                 static const char* className;
@@ -22,7 +21,9 @@ namespace lua
                 static const Script::Properties<Graphics> properties[];
                 bool isExisting;
                 bool isPrecious;
-                static void expose(Script* scr);
+                /** @brief Exposes the class to a script, whose objects will draw with gfx.
+                 * gfx can be NULL to run the script without graphics : the loadings then succeed and the drawings do nothing. */
+                static void expose(Script* scr, graphics::Graphics* gfx);
 
                 /* Window manipulation methods are not exposed */
                 /* Virtual size methods are not exposed */
@@ -35,6 +36,7 @@ namespace lua
 
                 /* Ressources loading */
                 int loadTexture(lua_State* st);
+                int loadTiledTexture(lua_State* st);
                 int loadMovie(lua_State* st);
                 int loadFont(lua_State* st);
                 int existsEntity(lua_State* st);
@@ -45,6 +47,19 @@ namespace lua
                 int setTextureHotPoint(lua_State* st);
                 int rewindMovie(lua_State* st);
 
+                /* Particles */
+                int createParticles(lua_State* st);
+                int particlesTexture(lua_State* st);
+                int particlesPosition(lua_State* st);
+                int particlesRate(lua_State* st);
+                int particlesLife(lua_State* st);
+                int particlesVelocity(lua_State* st);
+                int particlesGravity(lua_State* st);
+                int particlesTint(lua_State* st);
+                int particlesSizeCurve(lua_State* st);
+                int particlesAlphaCurve(lua_State* st);
+                int burstParticles(lua_State* st);
+
                 /* Transformations */
                 int rotate(lua_State* st);
                 int scale(lua_State* st);
@@ -53,15 +68,23 @@ namespace lua
                 int push(lua_State*);
                 int pop(lua_State*);
 
+                /* Culling */
+                /* visibleRect returns x, y, width and height of the visible part of the view */
+                int visibleRect(lua_State* st);
+                int isVisible(lua_State* st);
+                /* cullStats returns the number of draws tested and culled during the last frame */
+                int cullStats(lua_State* st);
+
                 /* Drawing */
                 int blitTexture(lua_State* st);
                 /* drawAABB is the textured version of the draw method */
                 int drawAABB(lua_State* st);
                 int drawText(lua_State* st);
                 int play(lua_State* st);
+                int drawParticles(lua_State* st);
 
             private:
-                static graphics::Graphics* m_gfx;
+                graphics::Graphics* m_gfx; /**< @brief The graphics instance of the script. */
         };
     }
 }
@@ -167,7 +167,7 @@ namespace lua
             
     void Script::setVariable(const std::string& name, const std::string& str)
     {
-        if(!loaded())
+        if(!m_state)
             throw lua::nonloaded_exception();
 
         lua_pushstring(m_state, str.c_str());
@@ -181,7 +181,7 @@ namespace lua
             
     void Script::setVariable(const std::string& name, double number)
     {
-        if(!loaded())
+        if(!m_state)
             throw lua::nonloaded_exception();
 
         lua_pushnumber(m_state, number);
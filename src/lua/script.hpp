@@ -100,19 +100,22 @@ namespace lua
             /** @brief Change the value of a lua variable to a string.
              * If the variable didn't existed before, it will create it.
              * 
-             * If the script isn't loaded, it will throw a lua::nonloaded_exception.
+             * It can be set before the script is loaded, so it can be read by the whole script.
+             * If the script isn't initialized, it will throw a lua::nonloaded_exception.
              */
             void setVariable(const std::string& name, const std::string& str);
             /** @brief Change the value of a lua variable to a string.
              * If the variable didn't existed before, it will create it.
              * 
-             * If the script isn't loaded, it will throw a lua::nonloaded_exception.
+             * It can be set before the script is loaded, so it can be read by the whole script.
+             * If the script isn't initialized, it will throw a lua::nonloaded_exception.
              */
             void setVariable(const std::string& name, const char* str);
             /** @brief Change the value of a lua variable to a number.
              * If the variable didn't existed before, it will create it.
              * 
-             * If the script isn't loaded, it will throw a lua::nonloaded_exception.
+             * It can be set before the script is loaded, so it can be read by the whole script.
+             * If the script isn't initialized, it will throw a lua::nonloaded_exception.
              */
             void setVariable(const std::string& name, double number);
 
@@ -147,6 +150,18 @@ namespace lua
              */
             template<typename T> void registerClass();
 
+            /*************************************************
+             *          Objects used by the exposures        *
+             *************************************************/
+
+            /** @brief Sets the object of type T the exposed classes of this script use, instead of a global one.
+             * Each script has its own objects, so independent scripts can run at once in different threads.
+             * It will throw a lua::nonloaded_exception if the script is not initialized.
+             */
+            template<typename T> void setContext(T* obj);
+            /** @brief Returns the object of type T set with setContext in the script of a lua state, NULL if none. */
+            template<typename T> static T* context(lua_State* st);
+
 
         private:
             lua_State* m_state; /**< @brief The lua state, representing and controlling the script and its execution. */
@@ -176,6 +191,9 @@ namespace lua
              */
             void gettop(const std::string& name);
 
+            /** @brief Returns the key of the objects of type T in the registry : the address of a constant, unique per type. */
+            template<typename T> static void* contextKey();
+
             /** @brief Return the name of a lua type. */
             const char* nameType(VarType t) const;
             /** @brief Return the type of the variable on the top of the stack. */
@@ -266,6 +284,28 @@ namespace lua
             throw lua::nonloaded_exception();
         internal::Luna<T>::Register(m_state, NULL);
     }
+
+    template<typename T> void Script::setContext(T* obj)
+    {
+        if(!m_state)
+            throw lua::nonloaded_exception();
+        lua_pushlightuserdata(m_state, static_cast<void*>(obj));
+        lua_rawsetp(m_state, LUA_REGISTRYINDEX, contextKey<T>());
+    }
+
+    template<typename T> T* Script::context(lua_State* st)
+    {
+        lua_rawgetp(st, LUA_REGISTRYINDEX, contextKey<T>());
+        T* obj = static_cast<T*>(lua_touserdata(st, -1));
+        lua_pop(st, 1);
+        return obj;
+    }
+
+    template<typename T> void* Script::contextKey()
+    {
+        static const char key = 0;
+        return const_cast<char*>(&key);
+    }
 }
 
 #endif
@@ -27,23 +27,18 @@ namespace lua
         const Script::Properties<Stage> Stage::properties[] = {
             {NULL, NULL, NULL},
         };
-        gameplay::Stage* Stage::m_used = NULL;
 
-        void Stage::expose(Script* scr)
+        void Stage::expose(Script* scr, gameplay::Stage* stage)
         {
             scr->registerClass<Stage>();
+            scr->setContext(stage);
         }
 
         /* Methods definition. */
-        Stage::Stage(lua_State*)
-            : isPrecious(false)
+        Stage::Stage(lua_State* st)
+            : isPrecious(false), m_used(Script::context<gameplay::Stage>(st))
         {}
 
-        void Stage::setUsedStage(gameplay::Stage* st)
-        {
-            m_used = st;
-        }
-
         int Stage::worldCenter(lua_State* st)
         {
             geometry::Point p;
@@ -18,8 +18,7 @@ namespace lua
         class Stage
         {
             public:
-                Stage(lua_State*);
-                static void setUsedStage(gameplay::Stage* st);
+                Stage(lua_State* st);
 
                 /* Lua exposure. */
                 static const char* className;
@@ -27,7 +26,8 @@ namespace lua
                 static const Script::Properties<Stage> properties[];
                 bool isExisting;
                 bool isPrecious;
-                static void expose(Script* scr);
+                /** @brief Exposes the class to the script of a stage. */
+                static void expose(Script* scr, gameplay::Stage* stage);
 
                 /* Exposed methods. */
                 int worldCenter(lua_State* st);
@@ -45,7 +45,7 @@ namespace lua
 
 
             private:
-                static gameplay::Stage* m_used; /**< @brief Stage actually used in this script. */
+                gameplay::Stage* m_used; /**< @brief Stage actually used in this script. */
                 /** @brief Indicates if the arguments are an AABB and get it. */
                 bool isAABB(lua_State* st, geometry::AABB& get);
                 /** @brief Indicates if the arguments are a Point and get it. */
@@ -2,10 +2,12 @@
 #include <iostream>
 #include <exception>
 #include <sstream>
+#include <memory>
 #include "global.hpp"
 #include "core/logger.hpp"
 #include "core/i18n.hpp"
 #include "menus/mainmenu.hpp"
+#include "events/evsave.hpp"
 
 
 /** @brief The entry point of the program. */
@@ -50,12 +52,30 @@ int main(int argc, char *argv[])
             global::evs->openJoysticks();
             global::evs->enableInput(false);
 
+            /* The event toggling the recording of the frames. */
+            std::unique_ptr<events::EvSave> recEvent(events::EvSave::parse(global::cfg->get<std::string>("reckey")));
+            if(!recEvent)
+                core::logger::logm("Couldn't parse the reckey event, the recording can't be toggled.", core::logger::WARNING);
+
+            /* When a menu has nothing to redraw, wait for the events instead of looping. */
+            const Uint32 idleWait = 50;
+            unsigned int frames = global::gfx->frames();
             while(menu.update())
             {
+                if(global::gfx->frames() == frames)
+                    global::evs->wait(idleWait);
+                frames = global::gfx->frames();
+
                 global::evs->update();
                 global::gui->update(*global::evs);
                 if(global::evs->quit() || global::evs->closed())
                     break;
+                if(recEvent && recEvent->valid(*global::evs)) {
+                    if(global::gfx->isRecording())
+                        global::gfx->stopRecording();
+                    else if(!global::gfx->startRecording(global::cfg->get<std::string>("recprefix")))
+                        core::logger::logm("Couldn't start recording the frames.", core::logger::WARNING);
+                }
                 if(global::evs->joysticksChanged()) {
                     std::vector<events::JoystickID> news = global::evs->lastJoysticksAdded();
                     for(events::JoystickID id : news)
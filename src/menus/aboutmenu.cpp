@@ -81,6 +81,10 @@ bool AboutMenu::update()
         return false;
     }
 
+    /* Nothing changed since the last frame : no need to redraw. */
+    if(!global::gui->dirty())
+        return true;
+
     /* Drawing, use the bg of the mainmenu */
     global::gfx->enterNamespace("/mainmenu");
     geometry::AABB rect(global::gfx->getVirtualWidth(), global::gfx->getVirtualHeight());
@@ -69,6 +69,10 @@ bool AddControlerMenu::update()
     if(m_actual)
         return m_actual->update();
 
+    /* Nothing changed since the last frame : no need to redraw. */
+    if(!global::gui->dirty())
+        return true;
+
     /* Drawing. */
     global::gfx->enterNamespace("/mainmenu");
     geometry::AABB rect(global::gfx->getVirtualWidth(), global::gfx->getVirtualHeight());
@@ -5,7 +5,6 @@
 #include "core/i18n.hpp"
 #include "core/pathParser.hpp"
 #include "core/logger.hpp"
-#include "lua/charaExposure.hpp"
 #include <sstream>
 
     CharaSelMenu::List::List()
@@ -239,8 +238,7 @@ bool CharaSelMenu::update()
             }
             ctrls[i] = new gameplay::Controler(m_ctrls[i]);
             ctrls[i]->attach(m_sels[i]);
-            lua::exposure::characters[i] = m_sels[i];
-            if(!m_sels[i]->load(gameplay::Character::Color::None, i)) {
+            if(!m_sels[i]->load(gameplay::Character::Color::None, i, m_sels)) {
                 core::logger::logm("Couldn't launch game because couldn't load a character.", core::logger::ERROR);
                 return false;
             }
@@ -294,7 +292,7 @@ void CharaSelMenu::loadCharas()
     for(std::string elem : elems) {
         std::string dir = path + elem;
         if(core::path::type(dir) == core::path::Type::Dir) {
-            gameplay::Character* chara = new gameplay::Character(dir);
+            gameplay::Character* chara = new gameplay::Character(dir, global::gfx);
             if(chara->preload())
                 m_avail.push_back(chara);
             else {
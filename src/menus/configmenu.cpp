@@ -100,6 +100,10 @@ bool ConfigMenu::update()
         return false;
     }
 
+    /* Nothing changed since the last frame : no need to redraw. */
+    if(!global::gui->dirty())
+        return true;
+
     /* Drawing */
     geometry::AABB rect(global::gfx->getVirtualWidth(), global::gfx->getVirtualHeight());
     global::gfx->enterNamespace("/mainmenu");
@@ -114,6 +114,12 @@ bool ControlerMenu::update()
         }
     }
 
+    /* Nothing changed since the last frame : no need to redraw. */
+    if(!global::gui->dirty()) {
+        m_last = m_getting;
+        return true;
+    }
+
     /* Drawing */
     global::gfx->enterNamespace("/mainmenu");
     geometry::AABB rect(global::gfx->getVirtualWidth(), global::gfx->getVirtualHeight());
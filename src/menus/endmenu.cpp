@@ -73,6 +73,10 @@ bool EndMenu::update()
             || m_end.clicked())
         return false;
 
+    /* Nothing changed since the last frame : no need to redraw. */
+    if(!global::gui->dirty())
+        return true;
+
     /* Drawing */
     global::gfx->enterNamespace("/mainmenu");
     geometry::AABB rect(global::gfx->getVirtualWidth(), global::gfx->getVirtualHeight());
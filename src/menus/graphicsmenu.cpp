@@ -111,6 +111,10 @@ bool GraphicsMenu::update()
         return false;
     }
 
+    /* Nothing changed since the last frame : no need to redraw. */
+    if(!global::gui->dirty())
+        return true;
+
     /* Drawing */
     global::gfx->enterNamespace("/mainmenu");
     geometry::AABB rect(global::gfx->getVirtualWidth(), global::gfx->getVirtualHeight());
@@ -115,6 +115,10 @@ bool MusicMenu::update()
     else
         global::audio->soundsVolume((unsigned char)m_sndVol->get());
 
+    /* Nothing changed since the last frame : no need to redraw. */
+    if(!global::gui->dirty())
+        return true;
+
     /* Drawing */
     global::gfx->enterNamespace("/mainmenu");
     geometry::AABB rect(global::gfx->getVirtualWidth(), global::gfx->getVirtualHeight());
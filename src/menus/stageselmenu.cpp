@@ -162,7 +162,7 @@ void StageSelMenu::populateList()
     for(std::string elem : contents) {
         std::string dir = path + elem;
         if(core::path::type(dir) == core::path::Type::Dir) {
-            gameplay::Stage* st = new gameplay::Stage(dir);
+            gameplay::Stage* st = new gameplay::Stage(dir, global::gfx, global::cfg);
             if(!st->preload()) {
                 std::ostringstream oss;
                 oss << "Couldn't load " << dir << " as a stage.";
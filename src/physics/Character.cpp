@@ -7,11 +7,12 @@ namespace physics
 {
     void Character::character_foot_callback(Entity* ch, Entity* ground, bool start, void*)
     {
+        /* An entity is kept once per fixture touched : the feet can be on two fixtures of the same entity. */
         Character* chara = dynamic_cast<Character*>(ch);
         auto it = std::find(chara->m_underfoot.begin(), chara->m_underfoot.end(), ground);
         if(!start && it != chara->m_underfoot.end())
             chara->m_underfoot.erase(it);
-        else if(start && it == chara->m_underfoot.end())
+        else if(start)
             chara->m_underfoot.push_back(ground);
     }
 
@@ -38,8 +39,10 @@ namespace physics
         float force = (vel/5.0f + 8.0f) * m_body->GetMass();
         setYLinearVelocity(0.0f);
         applyLinearImpulse(0.0f, force);
-        for(Entity* ent : m_underfoot)
-            ent->applyLinearImpulse(0.0f, -force);
+        for(size_t i = 0; i < m_underfoot.size(); ++i) {
+            if(std::find(m_underfoot.begin(), m_underfoot.begin() + i, m_underfoot[i]) == m_underfoot.begin() + i)
+                m_underfoot[i]->applyLinearImpulse(0.0f, -force);
+        }
     }
             
     bool Character::onGround() const
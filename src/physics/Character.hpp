@@ -36,7 +36,8 @@ namespace physics
             int getID() const;
 
         private:
-            std::vector<Entity*> m_underfoot; /**< @brief A list of all entities under the player foot. */
+            friend class World;
+            std::vector<Entity*> m_underfoot; /**< @brief A list of all entities under the player foot, once per fixture touched. */
             World* m_world;
             int m_id; /**< @brief The ID of the character. */
 
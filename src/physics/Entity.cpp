@@ -7,9 +7,12 @@
 namespace physics
 {
     Entity::Entity()
-    {}
+        : m_body(NULL), m_parent(NULL), m_prevPos(0.0f, 0.0f), m_queryStamp(0), m_baked(NULL)
+    {
+        m_glcallback.cb = NULL;
+    }
 
-    Entity::Entity(const std::string& name, World* world, const geometry::Point& position, const b2BodyType& bodyType, uint16 type, uint16 collideWith, float gravityScale, bool fixedRotation) : m_name(name), m_type(type), m_collideWith(collideWith)
+    Entity::Entity(const std::string& name, World* world, const geometry::Point& position, const b2BodyType& bodyType, uint16 type, uint16 collideWith, float gravityScale, bool fixedRotation) : m_name(name), m_type(type), m_collideWith(collideWith), m_parent(world), m_queryStamp(0), m_baked(NULL)
     {
         b2BodyDef bodyDef;
         bodyDef.type = bodyType;
@@ -19,10 +22,15 @@ namespace physics
         m_body = world->getWorld()->CreateBody(&bodyDef);
         m_body->SetFixedRotation(fixedRotation);
         m_body->SetUserData(this);
+        m_prevPos = m_body->GetPosition();
+        m_glcallback.cb = NULL;
     }
 
     Entity::~Entity()
-    {}
+    {
+        if(m_baked)
+            delete m_baked;
+    }
 
     b2Body* Entity::getBody() const
     {
@@ -31,13 +39,10 @@ namespace physics
 
     b2Fixture* Entity::getFixture(const std::string& name) const
     {
-        if(!m_fixtures.existsEntity(name))
-        {
+        b2Fixture* fixture = m_fixtures.find(name);
+        if(!fixture)
             core::logger::logm("Tried to get unexisting fixture \"" + name + "\" from entity \"" + m_name + "\" : returned nullptr.", core::logger::WARNING);
-            return nullptr;
-        }
-
-        return m_fixtures.getEntityValue(name);
+        return fixture;
     }
 
     std::string Entity::getName() const
@@ -50,11 +55,26 @@ namespace physics
         return m_type;
     }
 
+    bool Entity::baked() const
+    {
+        return m_baked != NULL;
+    }
+
     geometry::Point Entity::getPosition() const
     {
         return geometry::Point(m_body->GetPosition().x, m_body->GetPosition().y);
     }
 
+    geometry::Point Entity::getDrawPosition() const
+    {
+        if(!m_parent)
+            return getPosition();
+        float alpha = m_parent->interpolation();
+        b2Vec2 pos = m_body->GetPosition();
+        return geometry::Point(m_prevPos.x + (pos.x - m_prevPos.x) * alpha,
+                m_prevPos.y + (pos.y - m_prevPos.y) * alpha);
+    }
+
     float Entity::getXLinearVelocity()
     {
         return m_body->GetLinearVelocity().x;
@@ -105,9 +125,7 @@ namespace physics
         shape.Set(b2Vec2(toMeters(line.p1.x), toMeters(line.p1.y)), b2Vec2(toMeters(line.p2.x), toMeters(line.p2.y)));
         fixtureDef->shape = &shape;
 
-        m_fixtures.createEntity(name, m_body->CreateFixture(fixtureDef));
-
-        return m_fixtures.getEntityValue(name);
+        return addFixture(name, fixtureDef);
     }
 
     b2Fixture* Entity::createFixture(const std::string& name, const geometry::AABB& aabb, float density, float friction, uint16 type, uint16 collideWith, const geometry::Point& position, bool sensor)
@@ -120,9 +138,7 @@ namespace physics
         shape.SetAsBox(toMeters(aabb.width / 2), toMeters(aabb.height / 2), b2Vec2(toMeters(position.x), toMeters(position.y)), 0);
         fixtureDef->shape = &shape;
 
-        m_fixtures.createEntity(name, m_body->CreateFixture(fixtureDef));
-
-        return m_fixtures.getEntityValue(name);
+        return addFixture(name, fixtureDef);
     }
 
     b2Fixture* Entity::createFixture(const std::string& name, const geometry::Circle& circle, float density, float friction, uint16 type, uint16 collideWith, const geometry::Point& position, bool sensor)
@@ -136,9 +152,7 @@ namespace physics
         shape.m_radius = toMeters(circle.radius);
         fixtureDef->shape = &shape;
 
-        m_fixtures.createEntity(name, m_body->CreateFixture(fixtureDef));
-
-        return m_fixtures.getEntityValue(name);
+        return addFixture(name, fixtureDef);
     }
 
     b2Fixture* Entity::createFixture(const std::string& name, const geometry::Polygon& polygon, float density, float friction, uint16 type, uint16 collideWith, bool sensor)
@@ -155,14 +169,12 @@ namespace physics
         shape.Set(points, ptnb);
         fixtureDef->shape = &shape;
 
-        m_fixtures.createEntity(name, m_body->CreateFixture(fixtureDef));
-
-        return m_fixtures.getEntityValue(name);
+        return addFixture(name, fixtureDef);
     }
 
     b2FixtureDef* Entity::createBaseFixtureDef(const std::string& name, float density, float friction, uint16 type, uint16 collideWith, bool sensor) const
     {
-        if(m_fixtures.existsEntity(name))
+        if(m_fixtures.exists(name))
         {
             core::logger::logm("Tried to override existing fixture \"" + name + "\" in entity \"" + m_name + "\" : cancelled operation and returned nullptr.", core::logger::WARNING);
             return nullptr;
@@ -186,17 +198,59 @@ namespace physics
         return fixtureDef;
     }
 
+    b2Fixture* Entity::addFixture(const std::string& name, b2FixtureDef* fixtureDef)
+    {
+        b2Fixture* fixture = m_body->CreateFixture(fixtureDef);
+        delete fixtureDef;
+        m_fixtures.add(name, fixture);
+        return fixture;
+    }
+
     void Entity::destroyFixture(const std::string& name)
     {
-        if(m_fixtures.existsEntity(name)) {
-            m_body->DestroyFixture(m_fixtures.getEntityValue(name));
-            m_fixtures.deleteEntity(name);
+        b2Fixture* fixture = m_fixtures.find(name);
+        if(fixture) {
+            if(m_parent)
+                m_parent->forgetFixture(fixture);
+            /* Destroying the fixture ends its contacts : its callback must still be valid. */
+            m_body->DestroyFixture(fixture);
+            m_ftcallbacks.erase(fixture);
+            m_fixtures.remove(fixture);
             core::logger::logm("The fixture \"" + name + "\" has been destroyed in entity \"" + m_name + "\".", core::logger::MSG);
         }
         else
             core::logger::logm("Tried to destroy unexisting fixture \"" + name + "\" in entity \"" + m_name + "\" : cancelled operation.", core::logger::WARNING);
     }
 
+    bool Entity::resizeFixture(const std::string& name, const geometry::AABB& aabb, const geometry::Point& position)
+    {
+        b2Fixture* fixture = m_fixtures.find(name);
+        if(!fixture) {
+            core::logger::logm("Tried to resize unexisting fixture \"" + name + "\" in entity \"" + m_name + "\" : cancelled operation.", core::logger::WARNING);
+            return false;
+        }
+
+        if(fixture->GetType() != b2Shape::e_polygon) {
+            core::logger::logm("Tried to resize the non aabb-shaped fixture \"" + name + "\" in entity \"" + m_name + "\" : cancelled operation.", core::logger::WARNING);
+            return false;
+        }
+
+        b2PolygonShape* shape = static_cast<b2PolygonShape*>(fixture->GetShape());
+        shape->SetAsBox(toMeters(aabb.width / 2), toMeters(aabb.height / 2), b2Vec2(toMeters(position.x), toMeters(position.y)), 0);
+        m_body->ResetMassData();
+        return true;
+    }
+
+    void Entity::setActive(bool active)
+    {
+        m_body->SetActive(active);
+    }
+
+    bool Entity::isActive() const
+    {
+        return m_body->IsActive();
+    }
+
     void Entity::applyForce(float forceX, float forceY)
     {
         m_body->ApplyForce(b2Vec2(forceX, forceY), m_body->GetWorldCenter());
@@ -235,6 +289,8 @@ namespace physics
     void Entity::setPosition(const geometry::Point& p)
     {
         m_body->SetTransform(b2Vec2(p.x, p.y), m_body->GetAngle());
+        /* A warp musn't be interpolated. */
+        m_prevPos = m_body->GetPosition();
     }
             
     void Entity::setGravityScale(float sc)
@@ -3,17 +3,35 @@
 #define DEF_PHYSICS_ENTITY
 
 #include <map>
+#include <vector>
 #include "Box2D/Box2D.h"
 #include "geometry/point.hpp"
 #include "geometry/line.hpp"
 #include "geometry/aabb.hpp"
 #include "geometry/circle.hpp"
 #include "geometry/polygon.hpp"
-#include "core/fakefs.hpp"
+#include "FixtureTable.hpp"
 
 namespace physics
 {
     class World;
+    class Entity;
+    struct BakedRects;
+
+    /** @brief A collision callback, stored directly in the entities and in the user data of the fixtures,
+     * so finding the callbacks of a contact doesn't need any lookup.
+     */
+    struct CallbackRecord
+    {
+        /** @brief The function to call, NULL if there is no callback. */
+        void (*cb)(Entity*, Entity*, bool, void*);
+        /** @brief The data to pass to the called function. */
+        void* data;
+        /** @brief Indicates if collisions with sensors must be reported (fixtures callbacks only). */
+        bool sensors;
+        /** @brief The other entity of the collision (pair callbacks only). */
+        Entity* other;
+    };
 
     /** @brief The class representing the physical entities in the World. An entity is composed of one or many fixtures corresponding to geometric shapes with specific physical properties. */
     class Entity
@@ -60,8 +78,14 @@ namespace physics
             std::string getName() const;
             /** @brief Returns the type of the entity */
             uint16 getType() const;
+            /** @brief Indicates if the entity has been created by World::bakeStatic, each fixture being a shape of its own */
+            bool baked() const;
             /** @brief Returns the current position of the entity */
             geometry::Point getPosition() const;
+            /** @brief Returns the position the entity must be drawn at.
+             * With a fixed step, it is interpolated between the two last steps, so the movement stays smooth.
+             */
+            geometry::Point getDrawPosition() const;
             /** @brief Warp the entity to a position. */
             void setPosition(const geometry::Point& p);
 
@@ -101,6 +125,15 @@ namespace physics
 
             /** @brief Destroy the fixture named "name" in the map */
             void destroyFixture(const std::string& name);
+            /** @brief Changes the size of the fixture named "name", which must be aabb-shaped.
+             * Its bounding box in the broad-phase is updated on the next step, or when the entity is activated.
+             */
+            bool resizeFixture(const std::string& name, const geometry::AABB& aabb, const geometry::Point& position = geometry::Point(0, 0));
+
+            /** @brief Enable/disable the simulation of the entity : an inactive entity has no contact and isn't in the broad-phase, but keeps its fixtures. */
+            void setActive(bool active);
+            /** @brief Indicates if the entity is simulated. */
+            bool isActive() const;
 
             /** @brief Applies a force of coordinates (forceX ; forceY) to the entity's center */
             void applyForce(float forceX, float forceY);
@@ -119,6 +152,8 @@ namespace physics
         protected:
             /** @brief Creates a base b2FixtureDef based on density, friction and collision parameters, and return a pointer to it ; used in createFixture overloaded functions to avoid code repetitions */
             b2FixtureDef* createBaseFixtureDef(const std::string& name, float density, float friction, uint16 type, uint16 collideWith, bool sensor) const;
+            /** @brief Creates the fixture from its definition and stores it under name, returning a pointer to it */
+            b2Fixture* addFixture(const std::string& name, b2FixtureDef* fixtureDef);
 
         protected:
             /** @brief The entity name */
@@ -130,8 +165,22 @@ namespace physics
 
             /** @brief The b2Body of the entity, used in Box2D simulations */
             b2Body* m_body;
-            /** @brief A map containing all the fixtures of the body, allowing to access them with a specific name given by the user when created */
-            core::FakeFS<b2Fixture*> m_fixtures; 
+            /** @brief A table containing all the fixtures of the body, allowing to access them with a specific name given by the user when created */
+            FixtureTable m_fixtures; 
+            /** @brief The world the entity belongs to */
+            World* m_parent;
+            /** @brief The position of the body before the last step, used for interpolation */
+            b2Vec2 m_prevPos;
+            /** @brief The number of the last spatial query of the world which reported the entity, so it is reported once */
+            unsigned int m_queryStamp;
+            /** @brief The rectangles baked in the entity by World::bakeStatic, NULL if it isn't baked */
+            BakedRects* m_baked;
+            /** @brief The callback called for any collision of the entity */
+            CallbackRecord m_glcallback;
+            /** @brief The callbacks called for collisions with specific entities */
+            std::vector<CallbackRecord> m_callbacks;
+            /** @brief The fixtures callbacks, pointed to by the user data of the fixtures */
+            std::map<b2Fixture*, CallbackRecord> m_ftcallbacks;
     };
 }
 
@@ -0,0 +1,104 @@
+
+#include "FixtureTable.hpp"
+#include <functional>
+
+namespace physics
+{
+    FixtureTable::FixtureTable()
+        : m_size(0)
+    {}
+
+    b2Fixture* FixtureTable::find(const std::string& name) const
+    {
+        size_t i = index(name);
+        if(i == m_size)
+            return nullptr;
+        return at(i).fixture;
+    }
+
+    const std::string* FixtureTable::name(const b2Fixture* fixture) const
+    {
+        for(size_t i = 0; i < m_size; ++i) {
+            if(at(i).fixture == fixture)
+                return &at(i).name;
+        }
+        return nullptr;
+    }
+
+    bool FixtureTable::exists(const std::string& name) const
+    {
+        return index(name) != m_size;
+    }
+
+    bool FixtureTable::add(const std::string& name, b2Fixture* fixture)
+    {
+        if(exists(name))
+            return false;
+
+        Record rec;
+        rec.hash = std::hash<std::string>()(name);
+        rec.fixture = fixture;
+        rec.name = name;
+        if(m_size < inlineSize)
+            m_inline[m_size] = rec;
+        else
+            m_more.push_back(rec);
+        ++m_size;
+        return true;
+    }
+
+    bool FixtureTable::remove(const b2Fixture* fixture)
+    {
+        size_t i;
+        for(i = 0; i < m_size; ++i) {
+            if(at(i).fixture == fixture)
+                break;
+        }
+        if(i == m_size)
+            return false;
+
+        /* The last fixture takes the place of the removed one. */
+        if(i != m_size - 1)
+            at(i) = at(m_size - 1);
+        if(m_size > inlineSize)
+            m_more.pop_back();
+        else
+            m_inline[m_size - 1].name.clear();
+        --m_size;
+        return true;
+    }
+
+    size_t FixtureTable::size() const
+    {
+        return m_size;
+    }
+
+    /*************************
+     *   Internal methods    *
+     *************************/
+    FixtureTable::Record& FixtureTable::at(size_t i)
+    {
+        if(i < inlineSize)
+            return m_inline[i];
+        return m_more[i - inlineSize];
+    }
+
+    const FixtureTable::Record& FixtureTable::at(size_t i) const
+    {
+        if(i < inlineSize)
+            return m_inline[i];
+        return m_more[i - inlineSize];
+    }
+
+    size_t FixtureTable::index(const std::string& name) const
+    {
+        size_t hash = std::hash<std::string>()(name);
+        for(size_t i = 0; i < m_size; ++i) {
+            const Record& rec = at(i);
+            if(rec.hash == hash && rec.name == name)
+                return i;
+        }
+        return m_size;
+    }
+}
+
@@ -0,0 +1,60 @@
+#ifndef DEF_PHYSICS_FIXTURETABLE
+#define DEF_PHYSICS_FIXTURETABLE
+
+#include <string>
+#include <vector>
+#include "Box2D/Box2D.h"
+
+namespace physics
+{
+    /** @brief The named fixtures of an entity.
+     * An entity has only a few fixtures : they are stored inline with the hash of their name, the table only
+     * allocating memory beyond inlineSize fixtures. Lookups compare the hashes before the names.
+     */
+    class FixtureTable
+    {
+        public:
+            FixtureTable();
+            FixtureTable(const FixtureTable&) = delete;
+            ~FixtureTable() = default;
+
+            /** @brief Returns the fixture named name, or nullptr if there is none. */
+            b2Fixture* find(const std::string& name) const;
+            /** @brief Returns the name of a fixture, or nullptr if it isn't in the table. */
+            const std::string* name(const b2Fixture* fixture) const;
+            /** @brief Check if a fixture named name exists. */
+            bool exists(const std::string& name) const;
+            /** @brief Adds a fixture, returns false if the name is already used. */
+            bool add(const std::string& name, b2Fixture* fixture);
+            /** @brief Removes a fixture, returns false if it isn't in the table. */
+            bool remove(const b2Fixture* fixture);
+            /** @brief Returns the number of fixtures. */
+            size_t size() const;
+
+        private:
+            /** @brief The number of fixtures stored without allocation. */
+            static const size_t inlineSize = 4;
+
+            /** @brief A fixture of the table. */
+            struct Record {
+                size_t hash;        /**< @brief The hash of the name. */
+                b2Fixture* fixture; /**< @brief The fixture. */
+                std::string name;   /**< @brief The name of the fixture. */
+            };
+
+            Record m_inline[inlineSize]; /**< @brief The first fixtures. */
+            std::vector<Record> m_more;  /**< @brief The fixtures beyond inlineSize. */
+            size_t m_size;               /**< @brief The number of fixtures. */
+
+            /* Internal methods */
+            /** @brief Returns the record at index i. */
+            Record& at(size_t i);
+            /** @brief Returns the record at index i. */
+            const Record& at(size_t i) const;
+            /** @brief Returns the index of the fixture named name, or m_size if there is none. */
+            size_t index(const std::string& name) const;
+    };
+}
+
+#endif
+
@@ -1,12 +1,20 @@
 
 #include "World.hpp"
+#include "unit_conversions.hpp"
 #include "graphics/graphics.hpp"
 #include <iostream>
+#include <sstream>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
 
 namespace physics
 {
     World::World()
-        : m_world(NULL), m_dd(false), m_ddraw(NULL)
+        : m_world(NULL), m_ltime(0), m_fixed(false), m_dt(1.0f / 60.0f), m_accum(0.0f), m_maxSubsteps(5), m_velIt(10), m_posIt(8),
+        m_defer(false), m_evRecorded(0), m_evDispatched(0), m_alpha(1.0f),
+        m_dd(false), m_ddaabbs(false), m_ddcontacts(false), m_ddraw(NULL), m_queryStamp(0),
+        m_stepStats(60), m_statsHead(0), m_statsRecorded(0), m_statsSteps(0), m_statsPeriod(0), m_statsLevel(core::logger::MSG)
     {
         m_world = new b2World(b2Vec2(0.0f,-10.0f));
         m_world->SetContactListener(this);
@@ -14,7 +22,10 @@ namespace physics
     }
 
     World::World(float x, float y)
-        : m_world(NULL), m_dd(false), m_ddraw(NULL)
+        : m_world(NULL), m_ltime(0), m_fixed(false), m_dt(1.0f / 60.0f), m_accum(0.0f), m_maxSubsteps(5), m_velIt(10), m_posIt(8),
+        m_defer(false), m_evRecorded(0), m_evDispatched(0), m_alpha(1.0f),
+        m_dd(false), m_ddaabbs(false), m_ddcontacts(false), m_ddraw(NULL), m_queryStamp(0),
+        m_stepStats(60), m_statsHead(0), m_statsRecorded(0), m_statsSteps(0), m_statsPeriod(0), m_statsLevel(core::logger::MSG)
     {
         m_world = new b2World(b2Vec2(x,y));
         m_world->SetContactListener(this);
@@ -23,6 +34,7 @@ namespace physics
 
     World::World(b2World* world) : World()
     {
+        delete m_world;
         m_world = world;
         m_world->SetContactListener(this);
         m_world->SetDestructionListener(this);
@@ -32,6 +44,8 @@ namespace physics
     {
         if(m_ddraw != NULL)
             delete m_ddraw;
+        /* The bodies are freed with the world : the entities only keep pointers to them. */
+        delete m_world;
     }
 
     Entity* World::getEntity(const std::string& name) const
@@ -54,6 +68,20 @@ namespace physics
         return m_joints.getEntityValue(name);
     }
 
+    Entity* World::getEntity(const b2Body* body) const
+    {
+        /* The body user data already points to its entity. */
+        return static_cast<Entity*>(body->GetUserData());
+    }
+
+    std::string World::getJointName(b2Joint* joint) const
+    {
+        auto it = m_jointNames.find(joint);
+        if(it == m_jointNames.end())
+            return "";
+        return it->second;
+    }
+
     float World::getXGravity() const
     {
         return m_world->GetGravity().x;
@@ -185,6 +213,145 @@ namespace physics
         }
     }
 
+    /** @brief The bounds of a rectangle being baked. */
+    struct BakedBounds {
+        float x0, y0, x1, y1; /**< @brief The lower and upper bounds. */
+        float friction;       /**< @brief The friction of the rectangle. */
+    };
+
+    /** @brief Merges the rectangles touching along an axis, with the same extent on the other one and the same friction. */
+    static void mergeRuns(std::vector<BakedBounds>& rects, bool horizontal)
+    {
+        const float eps = 1e-4f;
+        /* Sorting by friction, by line along the axis, and by position along it. */
+        std::sort(rects.begin(), rects.end(), [horizontal](const BakedBounds& a, const BakedBounds& b) {
+                if(a.friction != b.friction)
+                    return a.friction < b.friction;
+                float la = horizontal ? a.y0 : a.x0, lb = horizontal ? b.y0 : b.x0;
+                if(la != lb)
+                    return la < lb;
+                float ha = horizontal ? a.y1 : a.x1, hb = horizontal ? b.y1 : b.x1;
+                if(ha != hb)
+                    return ha < hb;
+                return (horizontal ? a.x0 : a.y0) < (horizontal ? b.x0 : b.y0);
+                });
+
+        size_t last = 0;
+        for(size_t i = 1; i < rects.size(); ++i) {
+            BakedBounds& run = rects[last];
+            const BakedBounds& r = rects[i];
+            bool line = horizontal
+                ? std::abs(run.y0 - r.y0) < eps && std::abs(run.y1 - r.y1) < eps
+                : std::abs(run.x0 - r.x0) < eps && std::abs(run.x1 - r.x1) < eps;
+            bool touch = horizontal ? r.x0 <= run.x1 + eps : r.y0 <= run.y1 + eps;
+            if(run.friction == r.friction && line && touch) {
+                if(horizontal)
+                    run.x1 = std::max(run.x1, r.x1);
+                else
+                    run.y1 = std::max(run.y1, r.y1);
+            }
+            else
+                rects[++last] = r;
+        }
+        if(!rects.empty())
+            rects.resize(last + 1);
+    }
+
+    Entity* World::bakeStatic(const std::string& name, const std::vector<StaticRect>& rects, uint16 type)
+    {
+        Entity* ent;
+        if(type == Entity::Type::Platform)
+            ent = createPlatform(name, geometry::Point(0.0f, 0.0f));
+        else
+            ent = createObstacle(name, geometry::Point(0.0f, 0.0f));
+        if(!ent)
+            return nullptr;
+
+        ent->m_baked = new BakedRects;
+        ent->m_baked->rects = rects;
+        ent->m_baked->fixtures.assign(rects.size(), -1);
+        ent->m_baked->count = 0;
+        std::vector<size_t> ids(rects.size());
+        for(size_t i = 0; i < ids.size(); ++i)
+            ids[i] = i;
+        size_t count = bakeRuns(ent, ids);
+
+        std::ostringstream oss;
+        oss << "The static geometry \"" << name << "\" has been baked : " << rects.size() << " rectangles in " << count << " fixtures.";
+        core::logger::logm(oss.str(), core::logger::DEBUG);
+        return ent;
+    }
+
+    size_t World::bakeRuns(Entity* ent, const std::vector<size_t>& ids)
+    {
+        BakedRects& baked = *ent->m_baked;
+        std::vector<BakedBounds> bounds(ids.size());
+        for(size_t i = 0; i < ids.size(); ++i) {
+            const StaticRect& r = baked.rects[ids[i]];
+            bounds[i].x0 = r.center.x - r.rect.width / 2.0f;
+            bounds[i].x1 = r.center.x + r.rect.width / 2.0f;
+            bounds[i].y0 = r.center.y - r.rect.height / 2.0f;
+            bounds[i].y1 = r.center.y + r.rect.height / 2.0f;
+            bounds[i].friction = r.friction;
+        }
+
+        /* Merging the rows, then the columns, until nothing changes. */
+        size_t count;
+        do {
+            count = bounds.size();
+            mergeRuns(bounds, true);
+            mergeRuns(bounds, false);
+        } while(bounds.size() < count);
+
+        const float eps = 1e-4f;
+        for(const BakedBounds& b : bounds) {
+            int fixture = baked.count++;
+            std::ostringstream oss;
+            oss << fixture;
+            ent->createFixture(oss.str(), geometry::AABB(b.x1 - b.x0, b.y1 - b.y0), 1, b.friction, Entity::Type::ThisType,
+                    Entity::Type::ThisCollideWith, geometry::Point((b.x0 + b.x1) / 2.0f, (b.y0 + b.y1) / 2.0f));
+
+            /* The rectangles merged in this fixture are the ones it contains. */
+            for(size_t id : ids) {
+                const StaticRect& r = baked.rects[id];
+                if(baked.fixtures[id] < 0 && r.friction == b.friction
+                        && r.center.x - r.rect.width / 2.0f >= b.x0 - eps && r.center.x + r.rect.width / 2.0f <= b.x1 + eps
+                        && r.center.y - r.rect.height / 2.0f >= b.y0 - eps && r.center.y + r.rect.height / 2.0f <= b.y1 + eps)
+                    baked.fixtures[id] = fixture;
+            }
+        }
+        return bounds.size();
+    }
+
+    bool World::unbakeStatic(const std::string& name, size_t rect)
+    {
+        Entity* ent = existsEntity(name) ? m_entities.getEntityValue(name) : NULL;
+        if(!ent || !ent->m_baked || rect >= ent->m_baked->rects.size() || ent->m_baked->fixtures[rect] < 0) {
+            std::ostringstream oss;
+            oss << "Tried to unbake the unexisting rectangle " << rect << " of the static geometry \"" << name << "\" : cancelled operation.";
+            core::logger::logm(oss.str(), core::logger::WARNING);
+            return false;
+        }
+
+        /* The other rectangles of its fixture are merged again, without it. */
+        BakedRects& baked = *ent->m_baked;
+        int fixture = baked.fixtures[rect];
+        std::vector<size_t> ids;
+        for(size_t i = 0; i < baked.fixtures.size(); ++i) {
+            if(baked.fixtures[i] != fixture)
+                continue;
+            baked.fixtures[i] = -1;
+            if(i != rect)
+                ids.push_back(i);
+        }
+
+        std::ostringstream oss;
+        oss << fixture;
+        ent->destroyFixture(oss.str());
+        bakeRuns(ent, ids);
+        return true;
+    }
+
     b2RopeJoint* World::createRopeJoint(const std::string& name, Entity* entityA, Entity* entityB, float maxLength, const geometry::Point& localAnchorA, const geometry::Point& localAnchorB, bool collideConnected)
     {
         if(!existsJoint(name)) {
@@ -198,6 +365,7 @@ namespace physics
             b2RopeJoint* joint = (b2RopeJoint*)m_world->CreateJoint(&jointDef);
 
             m_joints.createEntity(name, joint);
+            m_jointNames[joint] = name;
             core::logger::logm("The rope joint \"" + name + "\" has been created.", core::logger::DEBUG);
             return joint;
         }
@@ -210,7 +378,14 @@ namespace physics
     void World::destroyEntity(const std::string& name)
     {
         if(existsEntity(name)) {
-            m_world->DestroyBody(m_entities.getEntityValue(name)->getBody());
+            /* The pair callbacks are symmetric : the other entities musn't keep callbacks to this one. */
+            Entity* ent = m_entities.getEntityValue(name);
+            /* Destroying the body ends its contacts : the callbacks must still be valid. */
+            m_world->DestroyBody(ent->getBody());
+            for(const CallbackRecord& rec : ent->m_callbacks)
+                removePairCallback(rec.other, ent);
+            ent->m_callbacks.clear();
+            ent->m_ftcallbacks.clear();
             m_entities.deleteEntity(name);
             core::logger::logm("The entity \"" + name + "\" has been destroyed.", core::logger::DEBUG);
         }
@@ -221,7 +396,9 @@ namespace physics
     void World::destroyJoint(const std::string& name)
     {
         if(existsJoint(name)) {
-            m_world->DestroyJoint(m_joints.getEntityValue(name));
+            b2Joint* joint = m_joints.getEntityValue(name);
+            m_world->DestroyJoint(joint);
+            m_jointNames.erase(joint);
             m_joints.deleteEntity(name);
             core::logger::logm("The joint \"" + name + "\" has been destroyed.", core::logger::DEBUG);
         }
@@ -236,10 +413,8 @@ namespace physics
 
         Entity* entA = m_entities.getEntityValue(nameA);
         Entity* entB = m_entities.getEntityValue(nameB);
-        m_callbacks[entA][entB].first  = callback;
-        m_callbacks[entA][entB].second = data;
-        m_callbacks[entB][entA].first  = callback;
-        m_callbacks[entB][entA].second = data;
+        setPairCallback(entA, entB, callback, data);
+        setPairCallback(entB, entA, callback, data);
     }
 
     void World::removeCallback(std::string nameA, std::string nameB)
@@ -248,19 +423,35 @@ namespace physics
             return;
         Entity* entA = m_entities.getEntityValue(nameA);
         Entity* entB = m_entities.getEntityValue(nameB);
+        removePairCallback(entA, entB);
+        removePairCallback(entB, entA);
+    }
 
-        if(m_callbacks.find(entA) != m_callbacks.end()
-                && m_callbacks[entA].find(entB) != m_callbacks[entA].end()) {
-            m_callbacks[entA].erase(entB);
-            if(m_callbacks[entA].begin() == m_callbacks[entA].end())
-                m_callbacks.erase(entA);
+    void World::setPairCallback(Entity* entA, Entity* entB, Callback callback, void* data)
+    {
+        for(CallbackRecord& rec : entA->m_callbacks) {
+            if(rec.other == entB) {
+                rec.cb   = callback;
+                rec.data = data;
+                return;
+            }
         }
 
-        if(m_callbacks.find(entB) != m_callbacks.end()
-                && m_callbacks[entB].find(entA) != m_callbacks[entB].end()) {
-            m_callbacks[entB].erase(entA);
-            if(m_callbacks[entB].begin() == m_callbacks[entB].end())
-                m_callbacks.erase(entB);
+        CallbackRecord rec;
+        rec.cb      = callback;
+        rec.data    = data;
+        rec.sensors = true;
+        rec.other   = entB;
+        entA->m_callbacks.push_back(rec);
+    }
+
+    void World::removePairCallback(Entity* entA, Entity* entB)
+    {
+        for(auto it = entA->m_callbacks.begin(); it != entA->m_callbacks.end(); ++it) {
+            if(it->other == entB) {
+                entA->m_callbacks.erase(it);
+                return;
+            }
         }
     }
 
@@ -269,8 +460,10 @@ namespace physics
         if(!m_entities.existsEntity(name))
             return;
         Entity* ent = m_entities.getEntityValue(name);
-        m_glcallbacks[ent].first  = callback;
-        m_glcallbacks[ent].second = data;
+        ent->m_glcallback.cb      = callback;
+        ent->m_glcallback.data    = data;
+        ent->m_glcallback.sensors = true;
+        ent->m_glcallback.other   = NULL;
     }
 
     void World::removeCallback(std::string name)
@@ -278,73 +471,70 @@ namespace physics
         if(!m_entities.existsEntity(name))
             return;
         Entity* ent = m_entities.getEntityValue(name);
-        if(m_glcallbacks.find(ent) != m_glcallbacks.end())
-            m_glcallbacks.erase(ent);
+        ent->m_glcallback.cb = NULL;
     }
 
     void World::setCallback(Entity* ent, b2Fixture* fixt, Callback callback, void* data, bool sensors)
     {
-        m_ftcallbacks[ent][fixt].cb      = callback;
-        m_ftcallbacks[ent][fixt].data    = data;
-        m_ftcallbacks[ent][fixt].sensors = sensors;;
+        CallbackRecord& rec = ent->m_ftcallbacks[fixt];
+        rec.cb      = callback;
+        rec.data    = data;
+        rec.sensors = sensors;
+        rec.other   = NULL;
+        fixt->SetUserData(&rec);
     }
 
     void World::removeCallback(Entity* ent, b2Fixture* fixt)
     {
-        if(m_ftcallbacks.find(ent) != m_ftcallbacks.end()
-                && m_ftcallbacks[ent].find(fixt) != m_ftcallbacks[ent].end()) {
-            m_ftcallbacks[ent].erase(fixt);
-            if(m_ftcallbacks[ent].begin() == m_ftcallbacks[ent].end())
-                m_ftcallbacks.erase(ent);
-        }
+        if(ent->m_ftcallbacks.erase(fixt) > 0)
+            fixt->SetUserData(NULL);
     }
 
     void World::collisionCallback(Entity* entityA, b2Fixture* fA, Entity* entityB, b2Fixture* fB, bool st)
     {
-        if(m_callbacks.find(entityA) != m_callbacks.end()
-                && m_callbacks[entityA].find(entityB) != m_callbacks[entityA].end())
-            (*m_callbacks[entityA][entityB].first)(entityA, entityB, st, m_callbacks[entityA][entityB].second);
-
-        if(m_glcallbacks.find(entityA) != m_glcallbacks.end())
-            (*m_glcallbacks[entityA].first)(entityA, entityB, st, m_glcallbacks[entityA].second);
-        if(m_glcallbacks.find(entityB) != m_glcallbacks.end())
-            (*m_glcallbacks[entityB].first)(entityB, entityA, st, m_glcallbacks[entityB].second);
+        /* The list of pair callbacks of an entity is short : usually empty or with one element. */
+        for(const CallbackRecord& rec : entityA->m_callbacks) {
+            if(rec.other == entityB) {
+                (*rec.cb)(entityA, entityB, st, rec.data);
+                break;
+            }
+        }
 
-        if(m_ftcallbacks.find(entityA) != m_ftcallbacks.end()
-                && m_ftcallbacks[entityA].find(fA) != m_ftcallbacks[entityA].end()
-                && (m_ftcallbacks[entityA][fA].sensors || !fB->IsSensor()))
-            (*m_ftcallbacks[entityA][fA].cb)(entityA, entityB, st, m_ftcallbacks[entityA][fA].data);
-        if(m_ftcallbacks.find(entityB) != m_ftcallbacks.end()
-                && m_ftcallbacks[entityB].find(fB) != m_ftcallbacks[entityB].end()
-                && (m_ftcallbacks[entityB][fB].sensors || !fA->IsSensor()))
-            (*m_ftcallbacks[entityB][fB].cb)(entityB, entityA, st, m_ftcallbacks[entityB][fB].data);
+        if(entityA->m_glcallback.cb)
+            (*entityA->m_glcallback.cb)(entityA, entityB, st, entityA->m_glcallback.data);
+        if(entityB->m_glcallback.cb)
+            (*entityB->m_glcallback.cb)(entityB, entityA, st, entityB->m_glcallback.data);
+
+        const CallbackRecord* rec = static_cast<const CallbackRecord*>(fA->GetUserData());
+        if(rec && (rec->sensors || !fB->IsSensor()))
+            (*rec->cb)(entityA, entityB, st, rec->data);
+        rec = static_cast<const CallbackRecord*>(fB->GetUserData());
+        if(rec && (rec->sensors || !fA->IsSensor()))
+            (*rec->cb)(entityB, entityA, st, rec->data);
     }
 
     void World::SayGoodbye(b2Joint* joint)
     {
-        std::vector<std::string> jointsNamesList = m_joints.listEntities();
-        std::vector<std::string>::iterator it;
-        for(it = jointsNamesList.begin() ; it != jointsNamesList.end() ; ++it) {
-            if(m_joints.getEntityValue(*it) == joint) {
-                m_joints.deleteEntity(*it);
-                core::logger::logm("The joint \"" + *it + "\" has been destroyed.", core::logger::DEBUG);
-                break;
-            }
-        }
+        auto it = m_jointNames.find(joint);
+        if(it == m_jointNames.end())
+            return;
+        m_joints.deleteEntity(it->second);
+        core::logger::logm("The joint \"" + it->second + "\" has been destroyed.", core::logger::DEBUG);
+        m_jointNames.erase(it);
     }
 
     void World::SayGoodbye(b2Fixture* fixture)
     {
         Entity* entity = getEntityFromFixture(fixture);
-        std::vector<std::string> fixturesNamesList = entity->m_fixtures.listEntities();
-        std::vector<std::string>::iterator it;
-        for(it = fixturesNamesList.begin() ; it != fixturesNamesList.end() ; ++it) {
-            if(entity->m_fixtures.getEntityValue(*it) == fixture) {
-                entity->m_fixtures.deleteEntity(*it);
-                core::logger::logm("The fixture \"" + *it + "\" in entity \"" + entity->m_name + "\" has been destroyed.", core::logger::DEBUG);
-                break;
-            }
-        }
+        if(entity == nullptr)
+            return;
+        const std::string* name = entity->m_fixtures.name(fixture);
+        if(!name)
+            return;
+        forgetFixture(fixture);
+        core::logger::logm("The fixture \"" + *name + "\" in entity \"" + entity->m_name + "\" has been destroyed.", core::logger::DEBUG);
+        entity->m_fixtures.remove(fixture);
+        entity->m_ftcallbacks.erase(fixture);
     }
 
     void World::BeginContact(b2Contact* contact)
@@ -361,7 +551,11 @@ namespace physics
             return;
         }
 
-        collisionCallback(entityA, fixtureA, entityB, fixtureB, true);
+        /* During a step, the callbacks are delayed if the events are deferred. */
+        if(m_defer && m_world->IsLocked())
+            recordEvent(fixtureA, fixtureB, true);
+        else
+            collisionCallback(entityA, fixtureA, entityB, fixtureB, true);
 
         // Platform collision management
 
@@ -402,7 +596,10 @@ namespace physics
         Entity* entityB = getEntityFromFixture(fixtureB);
         if(entityA == nullptr || entityB == nullptr)
             return; /* No need to log error : it has already been done when the contact started. */
-        collisionCallback(entityA, fixtureA, entityB, fixtureB, false);
+        if(m_defer && m_world->IsLocked())
+            recordEvent(fixtureA, fixtureB, false);
+        else
+            collisionCallback(entityA, fixtureA, entityB, fixtureB, false);
 
         // Platform collision management
 
@@ -412,26 +609,590 @@ namespace physics
 
     Entity* World::getEntityFromFixture(b2Fixture* fixture) const
     {
-        void* bodyUserData = fixture->GetBody()->GetUserData();
-        if(bodyUserData) {
-            return static_cast<Entity*>(bodyUserData);
-        }
-        else
-            return nullptr;
+        return getEntity(fixture->GetBody());
     }
 
     void World::start()
     {
         m_ltime = SDL_GetTicks();
+        m_accum = 0.0f;
+        m_alpha = 1.0f;
     }
 
     void World::step()
     {
         Uint32 time = SDL_GetTicks();
-        m_world->Step(float(time - m_ltime) / 1000.0f, 10, 8);
+        step(float(time - m_ltime) / 1000.0f);
         m_ltime = time;
     }
 
+    void World::step(float dt)
+    {
+        m_evRecorded = 0;
+        m_evDispatched = 0;
+        if(!m_fixed) {
+            m_world->Step(dt, m_velIt, m_posIt);
+            recordStats();
+            m_alpha = 1.0f;
+            dispatchEvents();
+            return;
+        }
+
+        /* The forces applied since the last call act during all its substeps. */
+        m_world->SetAutoClearForces(false);
+        m_accum += dt;
+        int nb = 0;
+        while(m_accum >= m_dt && nb < m_maxSubsteps) {
+            /* Keeping the positions before the step for interpolation. */
+            for(b2Body* body = m_world->GetBodyList(); body; body = body->GetNext()) {
+                Entity* ent = static_cast<Entity*>(body->GetUserData());
+                if(ent)
+                    ent->m_prevPos = body->GetPosition();
+            }
+            m_world->Step(m_dt, m_velIt, m_posIt);
+            recordStats();
+            m_accum -= m_dt;
+            ++nb;
+        }
+        m_world->ClearForces();
+        m_world->SetAutoClearForces(true);
+
+        /* Too late : the time that couldn't be simulated is dropped. */
+        if(m_accum >= m_dt)
+            m_accum = std::fmod(m_accum, m_dt);
+        m_alpha = m_accum / m_dt;
+        dispatchEvents();
+    }
+
+    void World::fixedStep(bool en)
+    {
+        m_fixed = en;
+        m_accum = 0.0f;
+        m_alpha = 1.0f;
+    }
+
+    bool World::fixedStep() const
+    {
+        return m_fixed;
+    }
+
+    void World::stepRate(float hz)
+    {
+        if(hz <= 0.0f) {
+            core::logger::logm("Tried to set a negative or null physics step rate : cancelled operation.", core::logger::WARNING);
+            return;
+        }
+        m_dt = 1.0f / hz;
+    }
+
+    float World::stepDuration() const
+    {
+        return m_dt;
+    }
+
+    void World::maxSubsteps(int nb)
+    {
+        if(nb > 0)
+            m_maxSubsteps = nb;
+    }
+
+    void World::iterations(int velocity, int position)
+    {
+        if(velocity > 0)
+            m_velIt = velocity;
+        if(position > 0)
+            m_posIt = position;
+    }
+
+    float World::interpolation() const
+    {
+        return m_alpha;
+    }
+
+    void World::solverThreads(int nb)
+    {
+        if(nb <= 0) {
+            core::logger::logm("Tried to set a negative or null number of physics threads : cancelled operation.", core::logger::WARNING);
+            return;
+        }
+        m_world->SetSolverThreads(nb);
+    }
+
+    int World::solverThreads() const
+    {
+        return m_world->GetSolverThreads();
+    }
+
+    void World::simdSolver(bool en)
+    {
+        m_world->SetSimdSolver(en);
+    }
+
+    bool World::simdSolver() const
+    {
+        return m_world->GetSimdSolver();
+    }
+
+    void World::deferEvents(bool en, size_t capacity)
+    {
+        m_defer = en;
+        if(m_defer) {
+            m_events.reserve(capacity);
+            m_pending.reserve(capacity);
+        }
+    }
+
+    bool World::deferEvents() const
+    {
+        return m_defer;
+    }
+
+    unsigned int World::eventsRecorded() const
+    {
+        return m_evRecorded;
+    }
+
+    unsigned int World::eventsDispatched() const
+    {
+        return m_evDispatched;
+    }
+
+    World::Stats World::stats() const
+    {
+        Stats st;
+        std::memset(&st, 0, sizeof(Stats));
+        st.last = m_world->GetProfile();
+        st.window = m_statsRecorded;
+        st.steps = m_statsSteps;
+        st.toi = m_world->GetTOICount();
+
+        /* Averaging the steps recorded. */
+        for(unsigned int i = 0; i < m_statsRecorded; ++i) {
+            const StepStats& rec = m_stepStats[i];
+            st.average.step          += rec.profile.step;
+            st.average.collide       += rec.profile.collide;
+            st.average.solve         += rec.profile.solve;
+            st.average.solveInit     += rec.profile.solveInit;
+            st.average.solveVelocity += rec.profile.solveVelocity;
+            st.average.solvePosition += rec.profile.solvePosition;
+            st.average.broadphase    += rec.profile.broadphase;
+            st.average.solveTOI      += rec.profile.solveTOI;
+            st.toiAverage            += (float)rec.toi;
+        }
+        if(m_statsRecorded > 0) {
+            float inv = 1.0f / (float)m_statsRecorded;
+            st.average.step          *= inv;
+            st.average.collide       *= inv;
+            st.average.solve         *= inv;
+            st.average.solveInit     *= inv;
+            st.average.solveVelocity *= inv;
+            st.average.solvePosition *= inv;
+            st.average.broadphase    *= inv;
+            st.average.solveTOI      *= inv;
+            st.toiAverage            *= inv;
+        }
+
+        /* Counting the content of the world. */
+        st.bodies = m_world->GetBodyCount();
+        for(const b2Body* body = m_world->GetBodyList(); body; body = body->GetNext()) {
+            if(body->IsAwake() && body->GetType() != b2_staticBody)
+                ++st.awake;
+        }
+        st.contacts = m_world->GetContactCount();
+        for(const b2Contact* contact = m_world->GetContactList(); contact; contact = contact->GetNext()) {
+            if(contact->IsTouching())
+                ++st.touching;
+        }
+        st.proxies = m_world->GetProxyCount();
+        return st;
+    }
+
+    void World::statsWindow(unsigned int nb)
+    {
+        if(nb == 0) {
+            core::logger::logm("Tried to average the physics statistics over no step : cancelled operation.", core::logger::WARNING);
+            return;
+        }
+        m_stepStats.assign(nb, StepStats());
+        m_statsHead = 0;
+        m_statsRecorded = 0;
+    }
+
+    void World::logStats(unsigned int period, core::logger::Level lvl)
+    {
+        m_statsPeriod = period;
+        m_statsLevel = lvl;
+    }
+
+    void World::printStats(core::logger::Level lvl) const
+    {
+        Stats st = stats();
+        std::ostringstream oss;
+        oss << "Physics : step " << st.last.step << " ms (average " << st.average.step << " ms over " << st.window << " steps"
+            << ", collide " << st.average.collide << ", solve " << st.average.solve << ", TOI " << st.average.solveTOI
+            << ", broad-phase " << st.average.broadphase << "), "
+            << st.bodies << " bodies, " << st.awake << " awake, "
+            << st.contacts << " contacts, " << st.touching << " touching, "
+            << st.proxies << " proxies, " << st.toi << " TOI events (average " << st.toiAverage << ").";
+        core::logger::logm(oss.str(), lvl);
+    }
+
+    void World::recordStats()
+    {
+        StepStats& rec = m_stepStats[m_statsHead];
+        m_statsHead = (m_statsHead + 1) % m_stepStats.size();
+        rec.profile = m_world->GetProfile();
+        rec.toi = m_world->GetTOICount();
+        ++m_statsSteps;
+        if(m_statsRecorded < m_stepStats.size())
+            ++m_statsRecorded;
+
+        if(m_statsPeriod > 0 && m_statsSteps % m_statsPeriod == 0)
+            printStats(m_statsLevel);
+    }
+
+    /* The state saved by snapshot : the time left, the size of the Box2D state followed by it,
+     * then for each body the previous position of its entity and, for the characters, the index of the bodies under them. */
+    size_t World::snapshot(std::vector<char>& buffer) const
+    {
+        int32 b2size = m_world->GetStateSize();
+        size_t size = 2 * sizeof(float) + sizeof(int32) + (size_t)b2size;
+        for(const b2Body* body = m_world->GetBodyList(); body; body = body->GetNext()) {
+            Entity* ent = getEntity(body);
+            size += sizeof(b2Vec2);
+            if(ent && ent->getType() == Entity::Type::Character)
+                size += sizeof(int32) * (1 + static_cast<Character*>(ent)->m_underfoot.size());
+        }
+        buffer.resize(size);
+
+        char* data = &buffer[0];
+        memcpy(data, &m_accum, sizeof(float));
+        memcpy(data + sizeof(float), &m_alpha, sizeof(float));
+        memcpy(data + 2 * sizeof(float), &b2size, sizeof(int32));
+        data += 2 * sizeof(float) + sizeof(int32);
+        m_world->SaveState(data);
+        data += b2size;
+
+        for(const b2Body* body = m_world->GetBodyList(); body; body = body->GetNext()) {
+            Entity* ent = getEntity(body);
+            b2Vec2 prev = ent ? ent->m_prevPos : body->GetPosition();
+            memcpy(data, &prev, sizeof(b2Vec2));
+            data += sizeof(b2Vec2);
+            if(!ent || ent->getType() != Entity::Type::Character)
+                continue;
+
+            const std::vector<Entity*>& underfoot = static_cast<Character*>(ent)->m_underfoot;
+            int32 count = (int32)underfoot.size();
+            memcpy(data, &count, sizeof(int32));
+            data += sizeof(int32);
+            for(Entity* ground : underfoot) {
+                int32 index = 0;
+                const b2Body* other = m_world->GetBodyList();
+                while(other && other != ground->getBody()) {
+                    other = other->GetNext();
+                    ++index;
+                }
+                memcpy(data, &index, sizeof(int32));
+                data += sizeof(int32);
+            }
+        }
+        return size;
+    }
+
+    bool World::restore(const std::vector<char>& buffer)
+    {
+        if(m_world->IsLocked()) {
+            core::logger::logm("Tried to restore the physics state during a step : cancelled operation.", core::logger::WARNING);
+            return false;
+        }
+
+        size_t head = 2 * sizeof(float) + sizeof(int32);
+        int32 b2size = -1;
+        if(buffer.size() >= head)
+            memcpy(&b2size, &buffer[2 * sizeof(float)], sizeof(int32));
+        if(b2size < 0 || buffer.size() < head + (size_t)b2size) {
+            core::logger::logm("Tried to restore an invalid physics state : cancelled operation.", core::logger::WARNING);
+            return false;
+        }
+
+        /* Checking the part saved by the entities before restoring anything. */
+        const char* tail = &buffer[0] + head + b2size;
+        size_t left = buffer.size() - head - b2size;
+        size_t pos = 0;
+        std::vector<b2Body*> bodies;
+        bool valid = true;
+        for(b2Body* body = m_world->GetBodyList(); body && valid; body = body->GetNext()) {
+            bodies.push_back(body);
+            Entity* ent = getEntity(body);
+            pos += sizeof(b2Vec2);
+            if(ent && ent->getType() == Entity::Type::Character) {
+                int32 count = -1;
+                if(pos + sizeof(int32) <= left)
+                    memcpy(&count, tail + pos, sizeof(int32));
+                pos += sizeof(int32) + sizeof(int32) * (size_t)std::max(count, 0);
+                valid = count >= 0;
+            }
+            valid = valid && pos <= left;
+        }
+        if(!valid || pos != left || !m_world->RestoreState(&buffer[head], b2size)) {
+            core::logger::logm("Tried to restore a physics state not matching the world : cancelled operation.", core::logger::WARNING);
+            return false;
+        }
+
+        memcpy(&m_accum, &buffer[0], sizeof(float));
+        memcpy(&m_alpha, &buffer[sizeof(float)], sizeof(float));
+        pos = 0;
+        for(b2Body* body : bodies) {
+            Entity* ent = getEntity(body);
+            b2Vec2 prev;
+            memcpy(&prev, tail + pos, sizeof(b2Vec2));
+            pos += sizeof(b2Vec2);
+            if(ent)
+                ent->m_prevPos = prev;
+            if(!ent || ent->getType() != Entity::Type::Character)
+                continue;
+
+            std::vector<Entity*>& underfoot = static_cast<Character*>(ent)->m_underfoot;
+            int32 count;
+            memcpy(&count, tail + pos, sizeof(int32));
+            pos += sizeof(int32);
+            underfoot.clear();
+            for(int32 i = 0; i < count; ++i) {
+                int32 index;
+                memcpy(&index, tail + pos, sizeof(int32));
+                pos += sizeof(int32);
+                if(index >= 0 && (size_t)index < bodies.size() && getEntity(bodies[index]))
+                    underfoot.push_back(getEntity(bodies[index]));
+            }
+        }
+
+        /* The events of the last step were already dispatched. */
+        m_events.clear();
+        m_pending.clear();
+        return true;
+    }
+
+    void World::hash(core::Hash& h) const
+    {
+        h.add(m_accum);
+        for(const b2Body* body = m_world->GetBodyList(); body; body = body->GetNext()) {
+            h.add(body->GetPosition().x);
+            h.add(body->GetPosition().y);
+            h.add(body->GetAngle());
+            h.add(body->GetLinearVelocity().x);
+            h.add(body->GetLinearVelocity().y);
+            h.add(body->GetAngularVelocity());
+            h.add(body->IsAwake());
+            h.add(body->IsActive());
+
+            Entity* ent = getEntity(body);
+            if(ent && ent->getType() == Entity::Type::Character)
+                h.add((uint32_t)static_cast<Character*>(ent)->m_underfoot.size());
+        }
+    }
+
+    /** @brief Collects the fixtures found by a query of the broad-phase. */
+    class FixtureCollector : public b2QueryCallback
+    {
+        public:
+            FixtureCollector(std::vector<b2Fixture*>* fixtures)
+                : m_fixtures(fixtures)
+            {}
+
+            bool ReportFixture(b2Fixture* fixture)
+            {
+                m_fixtures->push_back(fixture);
+                return true;
+            }
+
+        private:
+            std::vector<b2Fixture*>* m_fixtures; /**< @brief Where the fixtures are added. */
+    };
+
+    /** @brief Keeps the closest fixture hit by a ray, of an entity of the types wanted. */
+    class ClosestRayCast : public b2RayCastCallback
+    {
+        public:
+            ClosestRayCast(const World* world, uint16 types, const Entity* ignore)
+                : m_world(world), m_types(types), m_ignore(ignore), m_hit(false)
+            {}
+
+            float32 ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float32 fraction)
+            {
+                Entity* ent = m_world->getEntity(fixture->GetBody());
+                if(!ent || ent == m_ignore || !(ent->getType() & m_types))
+                    return -1.0f;
+                m_hit = true;
+                m_result.entity   = ent;
+                m_result.fixture  = fixture;
+                m_result.point    = geometry::Point(toPixels(point.x), toPixels(point.y));
+                m_result.normal   = geometry::Point(normal.x, normal.y);
+                m_result.fraction = fraction;
+                /* Only the fixtures closer than this one are reported from now. */
+                return fraction;
+            }
+
+            bool hit() const
+            {
+                return m_hit;
+            }
+
+            const World::RayHit& result() const
+            {
+                return m_result;
+            }
+
+        private:
+            const World* m_world;   /**< @brief The world, to get the entities of the fixtures. */
+            uint16 m_types;         /**< @brief The types of entities which can be hit. */
+            const Entity* m_ignore; /**< @brief The entity never hit. */
+            bool m_hit;             /**< @brief Has an entity been hit. */
+            World::RayHit m_result; /**< @brief The closest hit. */
+    };
+
+    size_t World::queryAABB(const geometry::Point& center, const geometry::AABB& rect, std::vector<Entity*>& result, uint16 types, const Entity* ignore, std::vector<b2Fixture*>* fixtures) const
+    {
+        b2AABB box;
+        box.lowerBound.Set(toMeters(center.x - rect.width / 2.0f), toMeters(center.y - rect.height / 2.0f));
+        box.upperBound.Set(toMeters(center.x + rect.width / 2.0f), toMeters(center.y + rect.height / 2.0f));
+        m_queryFixtures.clear();
+        FixtureCollector collector(&m_queryFixtures);
+        m_world->QueryAABB(&collector, box);
+
+        /* The entities with several fixtures are reported once. */
+        ++m_queryStamp;
+        size_t count = 0;
+        for(b2Fixture* fixture : m_queryFixtures) {
+            Entity* ent = getEntity(fixture->GetBody());
+            if(!ent || ent == ignore || !(ent->getType() & types) || !report(ent, fixtures != NULL))
+                continue;
+            result.push_back(ent);
+            if(fixtures)
+                fixtures->push_back(fixture);
+            ++count;
+        }
+        return count;
+    }
+
+    size_t World::overlap(const geometry::Point& center, const geometry::AABB& rect, std::vector<Entity*>& result, uint16 types, const Entity* ignore, std::vector<b2Fixture*>* fixtures) const
+    {
+        b2AABB box;
+        box.lowerBound.Set(toMeters(center.x - rect.width / 2.0f), toMeters(center.y - rect.height / 2.0f));
+        box.upperBound.Set(toMeters(center.x + rect.width / 2.0f), toMeters(center.y + rect.height / 2.0f));
+        m_queryFixtures.clear();
+        FixtureCollector collector(&m_queryFixtures);
+        m_world->QueryAABB(&collector, box);
+
+        b2PolygonShape shape;
+        shape.SetAsBox(toMeters(rect.width / 2.0f), toMeters(rect.height / 2.0f));
+        b2Transform xf(b2Vec2(toMeters(center.x), toMeters(center.y)), b2Rot(0.0f));
+
+        ++m_queryStamp;
+        size_t count = 0;
+        for(b2Fixture* fixture : m_queryFixtures) {
+            Entity* ent = getEntity(fixture->GetBody());
+            bool perFixture = fixtures && ent && ent->m_baked;
+            if(!ent || ent == ignore || !(ent->getType() & types) || (!perFixture && ent->m_queryStamp == m_queryStamp))
+                continue;
+
+            /* The broad-phase only found the fixtures whose bounding box overlaps. */
+            const b2Shape* fshape = fixture->GetShape();
+            bool touch = false;
+            for(int32 child = 0; child < fshape->GetChildCount() && !touch; ++child)
+                touch = b2TestOverlap(fshape, child, &shape, 0, fixture->GetBody()->GetTransform(), xf);
+            if(!touch || !report(ent, fixtures != NULL))
+                continue;
+
+            result.push_back(ent);
+            if(fixtures)
+                fixtures->push_back(fixture);
+            ++count;
+        }
+        return count;
+    }
+
+    bool World::report(Entity* ent, bool perFixture) const
+    {
+        if(perFixture && ent->m_baked)
+            return true;
+        if(ent->m_queryStamp == m_queryStamp)
+            return false;
+        ent->m_queryStamp = m_queryStamp;
+        return true;
+    }
+
+    bool World::raycast(const geometry::Point& from, const geometry::Point& to, RayHit* hit, uint16 types, const Entity* ignore) const
+    {
+        b2Vec2 p1(toMeters(from.x), toMeters(from.y));
+        b2Vec2 p2(toMeters(to.x), toMeters(to.y));
+        /* Box2D asserts on empty rays. */
+        if((p2 - p1).LengthSquared() <= 0.0f)
+            return false;
+
+        ClosestRayCast callback(this, types, ignore);
+        m_world->RayCast(&callback, p1, p2);
+        if(!callback.hit())
+            return false;
+        if(hit)
+            *hit = callback.result();
+        return true;
+    }
+
+    size_t World::FixturePairHash::operator()(const FixturePair& p) const
+    {
+        size_t h1 = std::hash<b2Fixture*>()(p.first);
+        size_t h2 = std::hash<b2Fixture*>()(p.second);
+        return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+    }
+
+    void World::recordEvent(b2Fixture* fA, b2Fixture* fB, bool begin)
+    {
+        ++m_evRecorded;
+        FixturePair key = fA < fB ? FixturePair(fA, fB) : FixturePair(fB, fA);
+        auto it = m_pending.find(key);
+
+        /* The contact ended and started again : nothing changed for the callbacks.
+         * A beginning followed by an end is kept, the callbacks must know about the touch. */
+        if(begin && it != m_pending.end() && !m_events[it->second].begin) {
+            m_events[it->second].fA = NULL;
+            m_pending.erase(it);
+            return;
+        }
+
+        ContactEvent ev;
+        ev.fA = fA;
+        ev.fB = fB;
+        ev.begin = begin;
+        m_pending[key] = m_events.size();
+        m_events.push_back(ev);
+    }
+
+    void World::dispatchEvents()
+    {
+        /* The callbacks may destroy fixtures, cancelling the next events : m_events musn't be iterated with iterators. */
+        for(size_t i = 0; i < m_events.size(); ++i) {
+            const ContactEvent ev = m_events[i];
+            if(ev.fA == NULL)
+                continue;
+            Entity* entityA = getEntityFromFixture(ev.fA);
+            Entity* entityB = getEntityFromFixture(ev.fB);
+            if(entityA == nullptr || entityB == nullptr)
+                continue;
+            collisionCallback(entityA, ev.fA, entityB, ev.fB, ev.begin);
+            ++m_evDispatched;
+        }
+        m_events.clear();
+        m_pending.clear();
+    }
+
+    void World::forgetFixture(b2Fixture* fixture)
+    {
+        for(ContactEvent& ev : m_events) {
+            if(ev.fA == fixture || ev.fB == fixture)
+                ev.fA = NULL;
+        }
+    }
+
     bool World::createNamespace(const std::string& path)
     {
         return m_entities.createNamespace(path);
@@ -478,11 +1239,27 @@ namespace physics
             if(!m_ddraw)
                 m_ddraw = new DebugDraw;
             m_world->SetDebugDraw(m_ddraw);
-            m_ddraw->SetFlags(b2Draw::e_shapeBit);
             m_dd = true;
+            debugDrawAABBs(m_ddaabbs);
         }
     }
 
+    void World::debugDrawAABBs(bool en)
+    {
+        m_ddaabbs = en;
+        if(!m_ddraw)
+            return;
+        if(m_ddaabbs)
+            m_ddraw->SetFlags(b2Draw::e_shapeBit | b2Draw::e_aabbBit);
+        else
+            m_ddraw->SetFlags(b2Draw::e_shapeBit);
+    }
+
+    void World::debugDrawContacts(bool en)
+    {
+        m_ddcontacts = en;
+    }
+
     bool World::debugDraw() const
     {
         return m_dd;
@@ -494,6 +1271,19 @@ namespace physics
             return;
         m_ddraw->set(gfx);
         m_world->DrawDebugData();
+
+        if(m_ddcontacts) {
+            b2WorldManifold manifold;
+            for(b2Contact* c = m_world->GetContactList(); c; c = c->GetNext()) {
+                if(!c->IsTouching())
+                    continue;
+                c->GetWorldManifold(&manifold);
+                int32 nb = c->GetManifold()->pointCount;
+                for(int32 i = 0; i < nb; ++i)
+                    m_ddraw->DrawContact(manifold.points[i], manifold.normal, b2Color(0.9f, 0.2f, 0.2f));
+            }
+        }
+        m_ddraw->flush();
     }
 
 }
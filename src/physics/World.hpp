@@ -3,10 +3,14 @@
 #define DEF_PHYSICS_WORLD
 
 #include <map>
+#include <unordered_map>
+#include <vector>
+#include <utility>
 #include <memory>
 #include <SDL.h>
 #include "core/logger.hpp"
 #include "core/fakefs.hpp"
+#include "core/hash.hpp"
 #include "Box2D/Box2D.h"
 #include "geometry/point.hpp"
 #include "Entity.hpp"
@@ -27,6 +31,8 @@ namespace physics
     /** @brief The main class, instanciated by the user and used to manage physical entities and relations between them */
     class World : public b2DestructionListener, b2ContactListener
     {
+        friend class Entity;
+
         public:
             /** @brief The callback type. The two first arguments are the entities concerned by the collision,
              * the third indicates if the collision has started (true) or has ended (false) and the last is
@@ -34,10 +40,41 @@ namespace physics
              */
             typedef void (*Callback)(Entity*, Entity*, bool, void*);
 
+            /** @brief A rectangle of static geometry, baked with others by bakeStatic. */
+            struct StaticRect {
+                geometry::Point center; /**< @brief The center of the rectangle. */
+                geometry::AABB rect;    /**< @brief The size of the rectangle. */
+                float friction;         /**< @brief The friction of the rectangle. */
+            };
+
+            /** @brief The closest entity hit by a ray cast. */
+            struct RayHit {
+                Entity* entity;         /**< @brief The entity hit. */
+                b2Fixture* fixture;     /**< @brief The fixture of the entity hit. */
+                geometry::Point point;  /**< @brief The point where the ray hit the fixture. */
+                geometry::Point normal; /**< @brief The normal of the fixture at this point. */
+                float fraction;         /**< @brief The fraction of the ray before the hit, in [0;1]. */
+            };
+
+            /** @brief Statistics on the steps of the simulation and on its content. The times are in milliseconds. */
+            struct Stats {
+                b2Profile last;         /**< @brief The times of the last Box2D step. */
+                b2Profile average;      /**< @brief The average times over the last steps. */
+                unsigned int window;    /**< @brief The number of steps averaged. */
+                unsigned long steps;    /**< @brief The number of Box2D steps done since the creation of the world. */
+                int bodies;             /**< @brief The number of bodies. */
+                int awake;              /**< @brief The number of bodies awake. */
+                int contacts;           /**< @brief The number of contacts, their fixtures' bounding boxes overlapping. */
+                int touching;           /**< @brief The number of contacts whose fixtures are really touching. */
+                int proxies;            /**< @brief The number of proxies in the broad-phase. */
+                int toi;                /**< @brief The number of time of impact events solved during the last step. */
+                float toiAverage;       /**< @brief The average number of time of impact events over the last steps. */
+            };
+
             World();
             /** @brief Creates a new World with x and y gravity */
             World(float x, float y);
-            /** @brief Initializes m_world from world. Not so useful, except for testing purposes with Testbed */
+            /** @brief Initializes m_world from world, which is then deleted with the World. Not so useful, except for testing purposes with Testbed */
             World(b2World* world); 
             ~World();
 
@@ -45,6 +82,10 @@ namespace physics
             Entity* getEntity(const std::string& name) const; 
             /** @brief Returns a unique_ptr to the joint named "name" in the world joints map */
             b2Joint* getJoint(const std::string& name) const; 
+            /** @brief Returns the entity owning a body, or nullptr if the body doesn't belong to an entity */
+            Entity* getEntity(const b2Body* body) const;
+            /** @brief Returns the name of a joint, or an empty string if the joint wasn't created by the world */
+            std::string getJointName(b2Joint* joint) const;
 
             /** @brief Get world's x gravity */
             float getXGravity() const; 
@@ -77,6 +118,20 @@ namespace physics
             Obstacle* createObstacle(const std::string& name, const geometry::Point& position);
             /** @brief Adds an Obstacle to the world with specified rect and friction */
             Obstacle* createObstacle(const std::string& name, const geometry::Point& position, const geometry::AABB& rect, float friction = 1);
+            /** @brief Adds a single static entity made of many rectangles, instead of an entity per rectangle.
+             * The rectangles side by side in a row or a column, with the same friction, are merged in one fixture :
+             * there are less proxies in the broad-phase, and no seam between them for the characters to catch on.
+             * @param type Entity::Type::Platform to create a one-way platform, else an obstacle is created.
+             * @return The entity, its fixtures being named "0", "1"..., or nullptr if the name is already used.
+             */
+            Entity* bakeStatic(const std::string& name, const std::vector<StaticRect>& rects, uint16 type);
+            /** @brief Removes a rectangle from an entity created by bakeStatic, at any time.
+             * Only the fixture it was merged in is destroyed, the other rectangles of this fixture being merged again.
+             * @param name The name of the baked entity.
+             * @param rect The index of the rectangle in the ones given to bakeStatic.
+             * @return False if the entity isn't baked or the rectangle isn't in it.
+             */
+            bool unbakeStatic(const std::string& name, size_t rect);
 
             /** @brief Adds a RopeJoint to the world, useful to create link CC */
             b2RopeJoint* createRopeJoint(const std::string& name, Entity* entityA, Entity* entityB, float maxLength, const geometry::Point& localAnchorA = geometry::Point(0, 0), const geometry::Point& localAnchorB = geometry::Point(0, 0), bool collideConnected = true); 
@@ -110,10 +165,82 @@ namespace physics
             void start();
             /** @brief Do the simulation, must be called once per loop. */
             void step();
+            /** @brief Advance the simulation of dt seconds, with fixed steps if enabled. */
+            void step(float dt);
+            /** @brief Enable/disable the fixed step mode : the simulation advances by steps of the same duration,
+             * the time remaining being kept for the next call. If disabled, each call does one step of the elapsed time.
+             * The forces applied to the entities before a call to step act during all of its fixed steps, and are
+             * cleared once it returns, even if no step was done.
+             */
+            void fixedStep(bool en);
+            /** @brief Indicates if the fixed step mode is enabled. */
+            bool fixedStep() const;
+            /** @brief Sets the number of fixed steps per second. */
+            void stepRate(float hz);
+            /** @brief Returns the duration of a fixed step in seconds. */
+            float stepDuration() const;
+            /** @brief Sets the maximum number of fixed steps done by a call to step : the late time is dropped, avoiding to take always more time to catch up. */
+            void maxSubsteps(int nb);
+            /** @brief Sets the number of iterations of the velocity and position solvers of each step. */
+            void iterations(int velocity, int position);
+            /** @brief Returns the fraction of step remaining, used to interpolate the positions between the two last steps. */
+            float interpolation() const;
+            /** @brief Sets the number of threads solving the separated groups of entities in contact, 1 by default.
+             * The results of the simulation don't depend on it.
+             */
+            void solverThreads(int nb);
+            /** @brief Returns the number of threads solving the groups of entities in contact. */
+            int solverThreads() const;
+            /** @brief Enable/disable the solving of the independent contacts by groups of 4 with SIMD instructions, disabled by default.
+             * The contacts are solved in another order, so the results are close to the scalar ones but not the same.
+             */
+            void simdSolver(bool en);
+            /** @brief Indicates if the contacts are solved by groups of 4. */
+            bool simdSolver() const;
+            /** @brief Enable/disable the deferred contact events : the collision callbacks aren't called during the steps
+             * but once step has returned, so they can modify the world. An end of contact followed by a new beginning
+             * of the same contact during a call to step cancel each other.
+             * @param capacity The number of events the queue is preallocated for.
+             */
+            void deferEvents(bool en, size_t capacity = 256);
+            /** @brief Indicates if the contact events are deferred. */
+            bool deferEvents() const;
+            /** @brief Returns the number of contact events recorded during the last call to step. */
+            unsigned int eventsRecorded() const;
+            /** @brief Returns the number of contact events dispatched after the last call to step, once coalesced. */
+            unsigned int eventsDispatched() const;
+            /** @brief Returns the statistics of the simulation : the times of the steps, as measured by Box2D, and the
+             * counts of bodies and contacts. The counts are computed by this call.
+             */
+            Stats stats() const;
+            /** @brief Sets the number of steps the times of the statistics are averaged over, 60 by default. */
+            void statsWindow(unsigned int nb);
+            /** @brief Logs the statistics every period steps, with a level, 0 disabling it (the default). */
+            void logStats(unsigned int period, core::logger::Level lvl = core::logger::MSG);
+            /** @brief Logs the statistics now, with a level. */
+            void printStats(core::logger::Level lvl) const;
+            /** @brief Saves the state of the simulation in buffer, resized to fit, and returns its size : the motion and
+             * contacts of the entities, the joints, the ground under the characters and the time left of the fixed steps.
+             * The entities, their fixtures and the callbacks aren't saved : they are kept as they are by restore.
+             */
+            size_t snapshot(std::vector<char>& buffer) const;
+            /** @brief Restores a state saved by snapshot : the simulation goes on exactly as it did after it.
+             * The world must have the same entities, fixtures and joints. No collision callback is called.
+             * @return false, nothing being changed, if the state doesn't match the world or if called during a step.
+             */
+            bool restore(const std::vector<char>& buffer);
+            /** @brief Adds the state of the simulation to a hash : the transforms and velocities of the bodies, their
+             * activity and the ground under the characters. Two worlds simulating the same way hash the same.
+             */
+            void hash(core::Hash& h) const;
             /** @brief Enable/disable debug drawing. */
             void enableDebugDraw(bool en);
             /** @brief Indicates if the debug draw is enabled. */
             bool debugDraw() const;
+            /** @brief Enable/disable the drawing of the broad-phase AABBs of the fixtures in the debug draw. */
+            void debugDrawAABBs(bool en);
+            /** @brief Enable/disable the drawing of the contact points and normals in the debug draw. */
+            void debugDrawContacts(bool en);
             /** @brief Do the debug draw (won't do anything if the debug draw isn't enabled). */
             void debugDraw(graphics::Graphics* gfx);
 
@@ -123,6 +250,25 @@ namespace physics
             void deleteNamespace(const std::string& path);
             /** @brief Check the existence of a namespace. */
             bool existsNamespace(const std::string& path) const;
+            /** @brief Finds the entities with a fixture whose bounding box overlaps a rectangle, using the broad-phase.
+             * @param center   The center of the rectangle.
+             * @param rect     The size of the rectangle.
+             * @param result   Where the entities found are added, once each, in the order of the broad-phase.
+             * @param types    The types of entities reported (Entity::Type flags), all of them by default.
+             * @param ignore   An entity never reported, like the one doing the query.
+             * @param fixtures If not NULL, the fixture found of each entity is added in the same order. The baked entities
+             *                 are then reported once per fixture found, each of them being a shape of its own.
+             * @return The number of entities found.
+             */
+            size_t queryAABB(const geometry::Point& center, const geometry::AABB& rect, std::vector<Entity*>& result, uint16 types = Entity::Type::All, const Entity* ignore = NULL, std::vector<b2Fixture*>* fixtures = NULL) const;
+            /** @brief Finds the entities with a fixture really overlapping a rectangle : like queryAABB, but the shapes of the fixtures are tested. */
+            size_t overlap(const geometry::Point& center, const geometry::AABB& rect, std::vector<Entity*>& result, uint16 types = Entity::Type::All, const Entity* ignore = NULL, std::vector<b2Fixture*>* fixtures = NULL) const;
+            /** @brief Casts a ray from a point to another, and finds the first entity of the types given it hits, ignore excepted.
+             * The sensors are hit too, the inactive entities aren't. hit can be NULL to only know if something is hit.
+             * @return False if nothing was hit, hit being unchanged.
+             */
+            bool raycast(const geometry::Point& from, const geometry::Point& to, RayHit* hit, uint16 types = Entity::Type::All, const Entity* ignore = NULL) const;
+
             /** @brief Enter a namespace. */
             void enterNamespace(const std::string& path);
             /** @brief Get the actual namespace. */
@@ -144,6 +290,37 @@ namespace physics
 
             /** @brief Returns a pointer to the Entity owning the fixture passed in parameter */
             Entity* getEntityFromFixture(b2Fixture* fixture) const; 
+            /** @brief Sets the callback of entA for collisions with entB. */
+            void setPairCallback(Entity* entA, Entity* entB, Callback callback, void* data);
+            /** @brief Removes the callback of entA for collisions with entB. */
+            void removePairCallback(Entity* entA, Entity* entB);
+
+            /** @brief A deferred contact event. */
+            struct ContactEvent {
+                b2Fixture* fA; /**< @brief The first fixture, NULL if the event has been cancelled. */
+                b2Fixture* fB; /**< @brief The second fixture. */
+                bool begin;    /**< @brief Is it the beginning of the contact. */
+            };
+            /** @brief The key of a pair of fixtures, the smallest pointer first. */
+            typedef std::pair<b2Fixture*, b2Fixture*> FixturePair;
+            /** @brief The hash of a pair of fixtures. */
+            struct FixturePairHash {
+                size_t operator()(const FixturePair& p) const;
+            };
+            /** @brief Adds an event to the queue, or cancels the pending end of the same contact. */
+            void recordEvent(b2Fixture* fA, b2Fixture* fB, bool begin);
+            /** @brief Calls the callbacks of the queued events, and empties the queue. */
+            void dispatchEvents();
+
+            /** @brief The times and TOI events of a Box2D step, kept for the averages of the statistics. */
+            struct StepStats {
+                b2Profile profile;
+                int toi;
+            };
+            /** @brief Records the statistics of the Box2D step just done, and logs them if it's time to. */
+            void recordStats();
+            /** @brief Cancels the queued events of a fixture about to be destroyed. */
+            void forgetFixture(b2Fixture* fixture);
 
         protected:
             /** @brief The world used in Box2D for simulation, containing all the bodies and fixtures (that we grouped in the Entity class) */
@@ -152,24 +329,71 @@ namespace physics
             core::FakeFS<Entity*> m_entities; 
             /** @brief A FakeFS containing all the joints of the world, allowing to access them with a specific name given by the user when created */
             core::FakeFS<b2Joint*> m_joints; 
-            /** @brief A two-dimensional map containing all the collision callbacks */
-            std::map<Entity*, std::map<Entity*, std::pair<Callback, void*>>> m_callbacks;
-            /** @brief A map containing the global callbacks. */
-            std::map<Entity*, std::pair<Callback, void*>> m_glcallbacks;
-            /** @brief Represents a callback for fixture. */
-            struct FtCallback {
-                Callback cb;  /**< @brief The function to call. */
-                void* data;   /**< @brief The data to pass to the called function. */
-                bool sensors; /**< @brief Indicates if collisions with sensors must be reported. */
-            };
-            /** @brief A map containing the fixtures callbacks. */
-            std::map<Entity*, std::map<b2Fixture*, FtCallback>> m_ftcallbacks;
+            /** @brief The names of the joints, to find them quickly from a joint pointer */
+            std::unordered_map<b2Joint*, std::string> m_jointNames;
             /** @brief Timestamp used to compute the time of each step. */
             Uint32 m_ltime;
+            /** @brief Is the fixed step mode enabled. */
+            bool m_fixed;
+            /** @brief The duration of a fixed step, in seconds. */
+            float m_dt;
+            /** @brief The time not simulated yet, in seconds. */
+            float m_accum;
+            /** @brief The maximum number of fixed steps per call. */
+            int m_maxSubsteps;
+            /** @brief The number of iterations of the velocity solver. */
+            int m_velIt;
+            /** @brief The number of iterations of the position solver. */
+            int m_posIt;
+            /** @brief Are the contact events deferred. */
+            bool m_defer;
+            /** @brief The contact events recorded during the actual call to step. */
+            std::vector<ContactEvent> m_events;
+            /** @brief The index in m_events of the last event of each pair of fixtures. */
+            std::unordered_map<FixturePair, size_t, FixturePairHash> m_pending;
+            /** @brief The number of events recorded during the last call to step. */
+            unsigned int m_evRecorded;
+            /** @brief The number of events dispatched after the last call to step. */
+            unsigned int m_evDispatched;
+            /** @brief The interpolation factor between the two last steps. */
+            float m_alpha;
             /** @brief Is the debug draw enabled. */
             bool m_dd;
+            /** @brief Are the broad-phase AABBs debug drawn. */
+            bool m_ddaabbs;
+            /** @brief Are the contact points debug drawn. */
+            bool m_ddcontacts;
             /** @brief The debug draw class. */
             DebugDraw* m_ddraw;
+            /** @brief Merges some rectangles of a baked entity and creates a fixture per run, recording where each one went.
+             * @return The number of fixtures created.
+             */
+            size_t bakeRuns(Entity* ent, const std::vector<size_t>& ids);
+            /** @brief Indicates if a fixture found by a query reports its entity, marking the entity as reported. */
+            bool report(Entity* ent, bool perFixture) const;
+            /** @brief The fixtures found by the broad-phase for the spatial queries, kept to avoid allocations. */
+            mutable std::vector<b2Fixture*> m_queryFixtures;
+            /** @brief The number of the last spatial query, marking the entities already reported. */
+            mutable unsigned int m_queryStamp;
+            /** @brief The statistics of the last steps, used as a ring. */
+            std::vector<StepStats> m_stepStats;
+            /** @brief The index in m_stepStats where the next step is recorded. */
+            unsigned int m_statsHead;
+            /** @brief The number of steps recorded in m_stepStats, at most its size. */
+            unsigned int m_statsRecorded;
+            /** @brief The number of Box2D steps done. */
+            unsigned long m_statsSteps;
+            /** @brief The number of steps between two logs of the statistics, 0 if they aren't logged. */
+            unsigned int m_statsPeriod;
+            /** @brief The level the statistics are logged with. */
+            core::logger::Level m_statsLevel;
+    };
+
+    /** @brief The rectangles baked in an entity by World::bakeStatic, kept so they can be removed later. */
+    struct BakedRects {
+        std::vector<World::StaticRect> rects; /**< @brief The rectangles given to bakeStatic. */
+        std::vector<int> fixtures;            /**< @brief The fixture each rectangle was merged in, -1 once removed. */
+        int count;                            /**< @brief The number of fixtures created, naming the next one. */
     };
 }
 
@@ -1,9 +1,14 @@
 
 #include "debugDraw.hpp"
 #include "graphics/graphics.hpp"
+#include <cmath>
 
 namespace physics
 {
+    DebugDraw::DebugDraw()
+        : m_gfx(NULL)
+    {}
+
     void DebugDraw::set(graphics::Graphics* gfx)
     {
         m_gfx = gfx;
@@ -16,14 +21,14 @@ namespace physics
 
     void DebugDraw::DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color)
     {
-        geometry::Polygon poly;
-        poly.points.resize(vertexCount);
-        for(int i = 0; i < vertexCount; ++i)
-            poly.points[i] = geometry::Point(vertices[i].x, vertices[i].y);
+        /* Box2D polygons are convex : a fan is enough. */
         graphics::Color c;
         c.set(color.r, color.g, color.b, 0.5f);
-
-        m_gfx->draw(poly, c);
+        for(int i = 1; i < vertexCount - 1; ++i) {
+            vertex(m_tris, vertices[0].x,     vertices[0].y,     c);
+            vertex(m_tris, vertices[i].x,     vertices[i].y,     c);
+            vertex(m_tris, vertices[i + 1].x, vertices[i + 1].y, c);
+        }
     }
 
     void DebugDraw::DrawCircle(const b2Vec2& center, float32 radius, const b2Color& color)
@@ -33,34 +38,31 @@ namespace physics
 
     void DebugDraw::DrawSolidCircle(const b2Vec2& center, float32 radius, const b2Vec2& axis, const b2Color& color)
     {
-        geometry::Circle circle;
-        circle.radius = radius;
         graphics::Color c;
         c.set(color.r, color.g, color.b, 0.5f);
+        const float step = 2.0f * b2_pi / (float)m_segments;
+        for(int i = 0; i < m_segments; ++i) {
+            float a0 = step * (float)i;
+            float a1 = step * (float)(i + 1);
+            vertex(m_tris, center.x, center.y, c);
+            vertex(m_tris, center.x + radius * std::cos(a1), center.y + radius * std::sin(a1), c);
+            vertex(m_tris, center.x + radius * std::cos(a0), center.y + radius * std::sin(a0), c);
+        }
 
-        geometry::Line ax;
-        ax.p1 = geometry::Point(0.0f, 0.0f);
         float norm = std::sqrt(axis.x * axis.x + axis.y * axis.y);
-        ax.p2.x = axis.x / norm * radius;
-        ax.p2.y = axis.y / norm * radius;
-
-        m_gfx->push();
-        m_gfx->move(center.x, center.y);
-        m_gfx->draw(circle, c);
-        c.a = 255;
-        m_gfx->draw(ax, c);
-        m_gfx->pop();
+        if(norm > b2_epsilon) {
+            c.a = 255;
+            vertex(m_lines, center.x, center.y, c);
+            vertex(m_lines, center.x + axis.x / norm * radius, center.y + axis.y / norm * radius, c);
+        }
     }
 
     void DebugDraw::DrawSegment(const b2Vec2& p1, const b2Vec2& p2, const b2Color& color)
     {
-        geometry::Line l;
-        l.p1 = geometry::Point(p1.x, p1.y);
-        l.p2 = geometry::Point(p2.x, p2.y);
         graphics::Color c;
         c.set(color.r, color.g, color.b);
-
-        m_gfx->draw(l, c);
+        vertex(m_lines, p1.x, p1.y, c);
+        vertex(m_lines, p2.x, p2.y, c);
     }
 
     void DebugDraw::DrawTransform(const b2Transform&)
@@ -68,5 +70,40 @@ namespace physics
         /* Transforms won't be drawn. */
     }
 
+    void DebugDraw::DrawContact(const b2Vec2& point, const b2Vec2& normal, const b2Color& color)
+    {
+        /* A small cross on the point, and the normal. */
+        const float size = 0.05f;
+        const float length = 0.3f;
+        graphics::Color c;
+        c.set(color.r, color.g, color.b);
+        vertex(m_lines, point.x - size, point.y - size, c);
+        vertex(m_lines, point.x + size, point.y + size, c);
+        vertex(m_lines, point.x - size, point.y + size, c);
+        vertex(m_lines, point.x + size, point.y - size, c);
+        vertex(m_lines, point.x, point.y, c);
+        vertex(m_lines, point.x + normal.x * length, point.y + normal.y * length, c);
+    }
+
+    void DebugDraw::flush()
+    {
+        if(m_gfx) {
+            m_gfx->drawTriangles(m_tris);
+            m_gfx->drawLines(m_lines);
+        }
+        /* The capacity is kept for the next pass. */
+        m_tris.clear();
+        m_lines.clear();
+    }
+
+    void DebugDraw::vertex(std::vector<graphics::Vertex>& array, float x, float y, const graphics::Color& col)
+    {
+        graphics::Vertex v;
+        v.x = x;
+        v.y = y;
+        v.col = col;
+        array.push_back(v);
+    }
+
 }
 
@@ -2,7 +2,9 @@
 #ifndef DEF_PHYSICS_DEBUGDRAW
 #define DEF_PHYSICS_DEBUGDRAW
 
+#include <vector>
 #include "Box2D/Box2D.h"
+#include "graphics/vertex.hpp"
 
 namespace graphics
 {
@@ -12,12 +14,13 @@ namespace graphics
 namespace physics
 {
     /** @brief A class used to draw physics, for debug.
-     * This class is reserved for physics::World use.
+     * The shapes of a whole b2World::DrawDebugData pass are accumulated in two vertex arrays, one of triangles and
+     * one of lines, drawn at once by flush(). This class is reserved for physics::World use.
      */
     class DebugDraw : public b2Draw
     {
         public:
-            DebugDraw() = default;
+            DebugDraw();
             void set(graphics::Graphics* gfx);
             ~DebugDraw() = default;
 
@@ -28,12 +31,27 @@ namespace physics
             virtual void DrawSolidCircle(const b2Vec2& center, float32 radius, const b2Vec2& axis, const b2Color& color);
             virtual void DrawSegment(const b2Vec2& p1, const b2Vec2& p2, const b2Color& color);
             virtual void DrawTransform(const b2Transform&);
+            /** @brief Draws a contact point with its normal. */
+            void DrawContact(const b2Vec2& point, const b2Vec2& normal, const b2Color& color);
+
+            /** @brief Draws all the primitives accumulated since the last flush. */
+            void flush();
 
         private:
+            /** @brief The number of segments used to approximate circles, as Graphics::draw does. */
+            static const int m_segments = 360;
+
             /** @brief The graphics instance to draw to.
              * The virtual isn't changed, nor the axes are, so they must be configured before by the user.
              */
             graphics::Graphics* m_gfx;
+            /** @brief The triangles accumulated, three vertices per triangle. */
+            std::vector<graphics::Vertex> m_tris;
+            /** @brief The lines accumulated, two vertices per line. */
+            std::vector<graphics::Vertex> m_lines;
+
+            /** @brief Adds a vertex to an array. */
+            void vertex(std::vector<graphics::Vertex>& array, float x, float y, const graphics::Color& col);
     };
 }
 
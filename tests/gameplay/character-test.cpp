@@ -6,7 +6,6 @@
 #include "graphics/graphics.hpp"
 #include "events/events.hpp"
 #include "gameplay/character.hpp"
-#include "lua/graphicsExposure.hpp"
 #include "global.hpp"
 
 namespace global {
@@ -19,7 +18,6 @@ int main()
     core::logger::addOutput(&std::cout);
     graphics::Graphics* gfx = new graphics::Graphics;
     global::gfx = gfx;
-    lua::exposure::Graphics::setGraphicsInstance(gfx);
 
     bool cont = false;
     events::Events evs;
@@ -34,14 +32,15 @@ int main()
     if(!cont)
         return 1;
 
-    gameplay::Character* chara = new gameplay::Character("rcs/chara/stick");
+    gameplay::Character* chara = new gameplay::Character("rcs/chara/stick", gfx);
     if(!chara->preload()) {
         core::logger::logm("Couldn't load the character preview.", core::logger::FATAL);
         return 1;
     }
     std::cout << "Character **" << chara->name() << "** loaded : " << chara->desc() << std::endl;
 
-    if(!chara->load(gameplay::Character::None, 0)) {
+    gameplay::Character* charas[4] = {chara, NULL, NULL, NULL};
+    if(!chara->load(gameplay::Character::None, 0, charas)) {
         core::logger::logm("Couldn't load the character.", core::logger::FATAL);
         return 1;
     }
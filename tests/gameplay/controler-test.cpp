@@ -7,8 +7,6 @@
 #include "events/events.hpp"
 #include "gameplay/character.hpp"
 #include "gameplay/controler.hpp"
-#include "lua/graphicsExposure.hpp"
-#include "lua/charaExposure.hpp"
 #include "global.hpp"
 
 namespace global {
@@ -27,7 +25,6 @@ int main()
     core::logger::addOutput(&std::cout);
     graphics::Graphics* gfx = new graphics::Graphics;
     global::gfx = gfx;
-    lua::exposure::Graphics::setGraphicsInstance(gfx);
 
     bool cont = false;
     events::Events evs;
@@ -39,15 +36,15 @@ int main()
     if(!cont)
         return 1;
 
-    gameplay::Character* chara = new gameplay::Character("rcs/chara/fighter");
+    gameplay::Character* chara = new gameplay::Character("rcs/chara/fighter", gfx);
     if(!chara->preload()) {
         core::logger::logm("Couldn't load the character preview.", core::logger::FATAL);
         return 1;
     }
     std::cout << "Character **" << chara->name() << "** loaded : " << chara->desc() << std::endl;
-    lua::exposure::characters[0] = chara;
+    gameplay::Character* charas[4] = {chara, NULL, NULL, NULL};
 
-    if(!chara->load(gameplay::Character::None, 0)) {
+    if(!chara->load(gameplay::Character::None, 0, charas)) {
         core::logger::logm("Couldn't load the character.", core::logger::FATAL);
         return 1;
     }
@@ -0,0 +1,167 @@
+#include <iostream>
+#include <string>
+#include "core/logger.hpp"
+#include "core/config.hpp"
+#include "core/trace.hpp"
+#include "events/events.hpp"
+#include "gameplay/character.hpp"
+#include "gameplay/controler.hpp"
+#include "gameplay/stage.hpp"
+#include "global.hpp"
+
+/* Checks the traces of a real match : two characters, driven by the same inputs at each update, play on a stage with
+ * their lua scripts for 900 updates, without graphics and with tracing enabled, so that each update is one physics step
+ * and the timers of the characters follow the number of updates. The match is played twice with 1 solver thread and once with 4 : the
+ * three traces must be identical. A fourth match, where the second character attacks at update 600 instead of
+ * walking, must diverge. Usage : stage_determinism-test <stage> <character> [directory of the traces]. */
+
+namespace global {
+    events::Events* evs;
+}
+
+const int players = 2;
+const int updates = 900;
+const int changed = 600;
+
+/** @brief Gives the inputs of an update to the characters, always the same for an update. */
+void play(int u, gameplay::Character* charas[4], bool change)
+{
+    const gameplay::Character::Control controls[] = {
+        gameplay::Character::Walk, gameplay::Character::Walk, gameplay::Character::Run,
+        gameplay::Character::Attack, gameplay::Character::Walk, gameplay::Character::Spell,
+    };
+    const gameplay::Character::Direction directions[] = {
+        gameplay::Character::Left, gameplay::Character::Right, gameplay::Character::Up,
+        gameplay::Character::Fixed, gameplay::Character::Fixed, gameplay::Character::Left,
+    };
+
+    for(int i = 0; i < players; ++i) {
+        int phase = (u / 30 + i * 2) % 6;
+        if(change && i == 1 && u == changed)
+            charas[i]->action(gameplay::Character::Attack, gameplay::Character::Fixed);
+        else
+            charas[i]->action(controls[phase], directions[phase]);
+    }
+}
+
+/** @brief Plays a match, writing its trace in path. */
+bool match(core::Config* cfg, const std::string& stage, const std::string& chara, const std::string& path, int threads, bool change)
+{
+    cfg->set<std::string>("phtrace", path);
+    cfg->set<int>("phthreads", threads);
+
+    gameplay::Character* charas[4] = {NULL, NULL, NULL, NULL};
+    gameplay::Controler* ctrls[4] = {NULL, NULL, NULL, NULL};
+    bool ok = true;
+    for(int i = 0; i < players && ok; ++i) {
+        charas[i] = new gameplay::Character(chara, NULL);
+        ok = charas[i]->preload() && charas[i]->load(gameplay::Character::None, i, charas);
+        /* The controler isn't opened : the characters only receive the inputs of play. */
+        ctrls[i] = new gameplay::Controler("");
+        ctrls[i]->attach(charas[i]);
+    }
+
+    gameplay::Stage* st = NULL;
+    if(ok) {
+        st = new gameplay::Stage(stage, NULL, cfg);
+        ok = st->preload() && st->load(ctrls);
+    }
+
+    for(int u = 0; u < updates && ok; ++u) {
+        play(u, charas, change);
+        st->update(*global::evs);
+        st->draw();
+    }
+
+    /* The characters remove themselves from the world of the stage, so they are deleted before it. */
+    for(int i = 0; i < players; ++i) {
+        if(charas[i])
+            delete charas[i];
+    }
+    if(st)
+        delete st;
+    for(int i = 0; i < players; ++i) {
+        if(ctrls[i])
+            delete ctrls[i];
+    }
+    return ok;
+}
+
+/** @brief Compares two traces, returning 1 if they can't be read, 0 otherwise. */
+int compare(const std::string& first, const std::string& second, core::Trace::Divergence* div)
+{
+    if(core::Trace::diff(first, second, div))
+        return 0;
+    std::cout << "Couldn't compare the traces " << first << " and " << second << "." << std::endl;
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 3) {
+        std::cout << "Usage : " << argv[0] << " <stage> <character> [directory of the traces]" << std::endl;
+        return 1;
+    }
+    std::string dir = argc > 3 ? std::string(argv[3]) + "/" : std::string();
+
+    core::logger::init();
+    core::logger::addOutput(&std::cout);
+    events::Events evs;
+    evs.enableInput(false);
+    global::evs = &evs;
+
+    /* The options read by the stage. */
+    core::Config cfg;
+    cfg.define("phdebug",         0, "", false);
+    cfg.define("phdebugaabb",     0, "", false);
+    cfg.define("phdebugcontacts", 0, "", false);
+    cfg.define("phfixed",         0, "", true);
+    cfg.define("phrate",          0, "", 60.0f);
+    cfg.define("phsubsteps",      0, "", 5);
+    cfg.define("phvelit",         0, "", 10);
+    cfg.define("phposit",         0, "", 8);
+    cfg.define("phdeferevents",   0, "", false);
+    cfg.define("phthreads",       0, "", 1);
+    cfg.define("phsimd",          0, "", false);
+    cfg.define("phbake",          0, "", true);
+    cfg.define("phstats",         0, "", 0);
+    cfg.define("phstatslevel",    0, "", 1);
+    cfg.define("phtrace",         0, "", "");
+
+    const std::string ref = dir + "stage-ref.trace";
+    const std::string again = dir + "stage-again.trace";
+    const std::string threads = dir + "stage-threads.trace";
+    const std::string change = dir + "stage-changed.trace";
+    if(!match(&cfg, argv[1], argv[2], ref, 1, false) || !match(&cfg, argv[1], argv[2], again, 1, false)
+            || !match(&cfg, argv[1], argv[2], threads, 4, false) || !match(&cfg, argv[1], argv[2], change, 1, true)) {
+        std::cout << "Couldn't play the matches." << std::endl;
+        return 1;
+    }
+
+    int ret = 0;
+    core::Trace::Divergence div;
+    const std::string same[] = {again, threads};
+    for(const std::string& path : same) {
+        if(compare(ref, path, &div) != 0)
+            ret = 1;
+        else if(div.diverged) {
+            std::cout << "The traces " << ref << " and " << path << " diverge at frame " << div.frame << " in " << div.column << "." << std::endl;
+            ret = 1;
+        }
+        else
+            std::cout << "The traces " << ref << " and " << path << " are identical." << std::endl;
+    }
+
+    if(compare(ref, change, &div) != 0)
+        ret = 1;
+    else if(!div.diverged) {
+        std::cout << "The attack at update " << changed << " wasn't found : the traces are identical." << std::endl;
+        ret = 1;
+    }
+    else
+        std::cout << "The attack at update " << changed << " was found at frame " << div.frame << " in " << div.column << "." << std::endl;
+
+    core::logger::free();
+    return ret;
+}
+
@@ -0,0 +1,150 @@
+
+#include "graphics/particles.hpp"
+#include <iostream>
+#include <chrono>
+#include <cmath>
+
+/* Checks the particle system, then benchmarks its simulation and vertex array building : no window is needed.
+ * The checks are on the number of particles emitted, their life durations and their positions, moved by their
+ * velocities and the gravity. The test fails if one of them is wrong. */
+
+/** @brief Checks the number of particles spawned by burst and by the continuous emission. */
+bool counts()
+{
+    graphics::internal::Particles parts(100);
+    if(parts.burst(150) != 100 || parts.count() != 100 || parts.burst(10) != 0) {
+        std::cout << "burst didn't stop at the maximum number of particles." << std::endl;
+        return false;
+    }
+    parts.clear();
+    if(parts.count() != 0) {
+        std::cout << "clear didn't kill all the particles." << std::endl;
+        return false;
+    }
+
+    parts.life(10000.0f, 10000.0f);
+    parts.rate(40.0f);
+    parts.update(500.0f);
+    if(parts.count() != 20) {
+        std::cout << "The continuous emission spawned " << parts.count() << " particles instead of 20." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/** @brief Checks that the particles die between their minimum and maximum life durations. */
+bool lifetimes()
+{
+    const size_t nb = 1000;
+    graphics::internal::Particles parts(nb);
+    parts.life(1000.0f, 2000.0f);
+    parts.burst(nb);
+
+    parts.update(990.0f);
+    if(parts.count() != nb) {
+        std::cout << nb - parts.count() << " particles died before their minimum life." << std::endl;
+        return false;
+    }
+    parts.update(510.0f);
+    if(parts.count() == 0 || parts.count() == nb) {
+        std::cout << "The life durations aren't spread between the bounds : " << parts.count() << " particles alive at half." << std::endl;
+        return false;
+    }
+    parts.update(510.0f);
+    if(parts.count() != 0) {
+        std::cout << parts.count() << " particles outlived their maximum life." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/** @brief Checks the positions of the particles, emitted in a cone and then falling. */
+bool positions()
+{
+    const size_t nb = 1000;
+    const geometry::Point emitter(10.0f, 20.0f);
+    graphics::internal::Particles parts(nb);
+    parts.life(10000.0f, 10000.0f);
+    parts.position(emitter);
+    parts.velocity(90.0f, 60.0f, 50.0f, 100.0f);
+    parts.burst(nb);
+
+    for(size_t i = 0; i < nb; ++i) {
+        geometry::Point p = parts.particle(i);
+        if(p.x != emitter.x || p.y != emitter.y) {
+            std::cout << "The particle " << i << " wasn't emitted at the position of the emitter." << std::endl;
+            return false;
+        }
+    }
+
+    /* Half a second without gravity : between 25 and 50 units away, in the cone going up between 60 and 120 degres. */
+    parts.update(500.0f);
+    for(size_t i = 0; i < nb; ++i) {
+        geometry::Point p = parts.particle(i);
+        float dx = p.x - emitter.x;
+        float dy = p.y - emitter.y;
+        float dist = std::sqrt(dx * dx + dy * dy);
+        float angle = std::atan2(dy, dx) * 57.2957795f;
+        if(dist < 25.0f - 1e-3f || dist > 50.0f + 1e-3f || angle < 60.0f - 1e-2f || angle > 120.0f + 1e-2f) {
+            std::cout << "The particle " << i << " is at " << dist << " units and " << angle << " degres from the emitter." << std::endl;
+            return false;
+        }
+    }
+
+    /* Still particles only moved by the gravity : v += g * dt, then x += v * dt. */
+    parts.clear();
+    parts.velocity(0.0f, 0.0f, 0.0f, 0.0f);
+    parts.gravity(4.0f, -10.0f);
+    parts.burst(nb);
+    parts.update(1000.0f);
+    for(size_t i = 0; i < nb; ++i) {
+        geometry::Point p = parts.particle(i);
+        if(std::abs(p.x - 14.0f) > 1e-4f || std::abs(p.y - 10.0f) > 1e-4f) {
+            std::cout << "The gravity moved the particle " << i << " to (" << p.x << ", " << p.y << ") instead of (14, 10)." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    bool ok = counts();
+    ok = lifetimes() && ok;
+    ok = positions() && ok;
+    std::cout << (ok ? "All the particle checks passed." : "Some particle checks FAILED.") << std::endl;
+
+    const size_t sizes[] = {10000, 25000, 50000, 100000, 0};
+    const int frames = 300;
+    const float frameTime = 1000.0f / 60.0f;
+
+    for(int i = 0; sizes[i] != 0; ++i) {
+        graphics::internal::Particles parts(sizes[i]);
+        parts.life(2000.0f, 4000.0f);
+        parts.velocity(90.0f, 360.0f, 10.0f, 50.0f);
+        parts.gravity(0.0f, -9.8f);
+        parts.sizeCurve({0.5f, 1.0f, 0.2f});
+        parts.alphaCurve({1.0f, 0.0f});
+        /* Keep the system full. */
+        parts.rate((float)sizes[i]);
+        parts.burst(sizes[i]);
+
+        std::chrono::duration<double, std::milli> update(0), build(0);
+        for(int f = 0; f < frames; ++f) {
+            auto begin = std::chrono::steady_clock::now();
+            parts.update(frameTime);
+            auto middle = std::chrono::steady_clock::now();
+            parts.build(8.0f, 8.0f, false);
+            auto end = std::chrono::steady_clock::now();
+            update += middle - begin;
+            build  += end - middle;
+        }
+
+        std::cout << sizes[i] << " particles (" << parts.count() << " alive at end) : "
+            << "update " << update.count() / frames << " ms/frame, "
+            << "build " << build.count() / frames << " ms/frame." << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
+
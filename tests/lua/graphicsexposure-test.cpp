@@ -26,8 +26,7 @@ int main()
 
     try {
         /* Exposing graphics */
-        lua::exposure::Graphics::setGraphicsInstance(gfx);
-        lua::exposure::Graphics::expose(&scr);
+        lua::exposure::Graphics::expose(&scr, gfx);
 
         /* Load scripts */
         if(!scr.load("gfx.lua"))
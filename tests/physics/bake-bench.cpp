@@ -0,0 +1,122 @@
+
+#include "scenes.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <chrono>
+
+/* Measures the time to create a ground of 400 tiles and a one-way platform of 10 tiles, as the stage scripts build
+ * them, and the time of a step on them : with an entity per tile, then baked in one static entity per kind. A
+ * character walking across the baked tiles must never leave the ground on the seams, and must land on the platform
+ * after jumping through it from below. */
+
+const int tiles = 200;
+const float tile = 1.0f;
+
+struct Result {
+    double create;      /* Time to create the stage, in ms. */
+    double step;        /* Time of a step, in ms. */
+    int fixtures;       /* Number of static fixtures. */
+    int proxies;        /* Number of proxies in the broad-phase. */
+    int airborne;       /* Number of steps the walking character wasn't on the ground. */
+    bool landed;        /* Has the character landed on the one-way platform. */
+};
+
+void rects(std::vector<physics::World::StaticRect>& ground, std::vector<physics::World::StaticRect>& platform)
+{
+    for(int i = 0; i < tiles; ++i) {
+        /* Two rows of tiles for the ground. */
+        for(int j = 0; j < 2; ++j) {
+            physics::World::StaticRect r = {geometry::Point((float)i * tile, -(float)j * tile - tile / 2.0f),
+                geometry::AABB(tile, tile), 1.0f};
+            ground.push_back(r);
+        }
+    }
+    for(int i = 0; i < 10; ++i) {
+        physics::World::StaticRect r = {geometry::Point(-3.0f + (float)i * tile, 4.0f), geometry::AABB(tile, 0.5f), 1.0f};
+        platform.push_back(r);
+    }
+}
+
+Result simulate(bool bake)
+{
+    Result res;
+    physics::World world(0.0f, -20.0f);
+    world.fixedStep(true);
+    std::vector<physics::World::StaticRect> ground, platform;
+    rects(ground, platform);
+
+    auto begin = std::chrono::steady_clock::now();
+    if(bake) {
+        world.bakeStatic("ground", ground, physics::Entity::Type::Obstacle);
+        world.bakeStatic("platform", platform, physics::Entity::Type::Platform);
+    }
+    else {
+        for(size_t i = 0; i < ground.size(); ++i) {
+            std::ostringstream oss;
+            oss << "ground" << i;
+            world.createObstacle(oss.str(), ground[i].center, ground[i].rect, ground[i].friction);
+        }
+        for(size_t i = 0; i < platform.size(); ++i) {
+            std::ostringstream oss;
+            oss << "platform" << i;
+            world.createPlatform(oss.str(), platform[i].center, platform[i].rect, platform[i].friction);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    res.create = std::chrono::duration<double, std::milli>(end - begin).count();
+
+    res.fixtures = 0;
+    for(b2Body* body = world.getWorld()->GetBodyList(); body; body = body->GetNext()) {
+        for(b2Fixture* fixt = body->GetFixtureList(); fixt; fixt = fixt->GetNext())
+            res.fixtures += body->GetType() == b2_staticBody ? 1 : 0;
+    }
+    res.proxies = world.getWorld()->GetProxyCount();
+
+    physics::Character* ch = world.createCharacter("player", geometry::Point(0.0f, 2.0f), geometry::AABB(1.0f, 2.0f),
+            physics::Character::Weight::Medium);
+
+    /* Landing, then walking across the tiles. */
+    scenes::StepTimer timer;
+    res.airborne = 0;
+    for(int s = 0; s < 600; ++s) {
+        if(s >= 60) {
+            ch->setXLinearVelocity(10.0f);
+            if(!ch->onGround())
+                ++res.airborne;
+        }
+        timer.step(world, 1.0f / 60.0f);
+    }
+
+    /* Jumping through the one-way platform from below. */
+    ch->setPosition(geometry::Point(2.0f, 1.0f));
+    ch->setXLinearVelocity(0.0f);
+    for(int s = 0; s < 30; ++s)
+        world.step(1.0f / 60.0f);
+    if(ch->onGround())
+        ch->jump(40.0f);
+    for(int s = 0; s < 120; ++s) {
+        ch->setXLinearVelocity(0.0f);
+        timer.step(world, 1.0f / 60.0f);
+    }
+    res.landed = ch->onGround() && ch->getPosition().y > 4.25f;
+    res.step = timer.average();
+    return res;
+}
+
+int main()
+{
+    bool ok = true;
+    for(int k = 0; k < 2; ++k) {
+        bool bake = k == 1;
+        Result res = simulate(bake);
+        std::cout << (bake ? "Baked, " : "Separated, ") << res.fixtures << " static fixtures, " << res.proxies
+            << " proxies : " << res.create << " ms to create, " << res.step << " ms/step, "
+            << res.airborne << " steps in the air while walking, "
+            << (res.landed ? "landed" : "NOT LANDED") << " on the platform." << std::endl;
+        if(bake)
+            ok = res.airborne == 0 && res.landed && res.fixtures == 2;
+    }
+    return ok ? 0 : 1;
+}
+
@@ -0,0 +1,85 @@
+
+#include "scenes.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+/* Measures the time of a step when hundreds of contacts start and end at each step : grids of 100 to 800 sensors move
+ * back and forth through grids of as many obstacles. Each sensor has a fixture callback and a pair callback with its
+ * obstacle, and each obstacle a global one. The callbacks are called during the steps, then deferred after them. */
+
+static unsigned int called = 0;
+
+void count(physics::Entity*, physics::Entity*, bool, void*)
+{
+    ++called;
+}
+
+int main()
+{
+    const int sizes[] = {100, 200, 400, 800};
+    const int steps = 600;
+    const int period = 8;
+    const float dt = 1.0f / 60.0f;
+    const float speed = 30.0f;
+
+    for(int k = 0; k < 2 * 4; ++k) {
+        int i = k % 4;
+        bool defer = k >= 4;
+        physics::World world(0.0f, 0.0f);
+        world.fixedStep(true);
+        world.deferEvents(defer);
+        int side = 1;
+        while(side * side < sizes[i])
+            ++side;
+
+        std::vector<physics::Entity*> sensors;
+        for(int j = 0; j < sizes[i]; ++j) {
+            geometry::Point pos((float)(j % side) * 2.0f, (float)(j / side) * 2.0f);
+
+            /* The obstacle, with a global callback. */
+            std::ostringstream obs;
+            obs << "obstacle" << j;
+            world.createObstacle(obs.str(), pos, geometry::AABB(1.0f, 1.0f));
+            world.setCallback(obs.str(), count);
+
+            /* The sensor, with a fixture callback and a pair callback with its obstacle. */
+            std::ostringstream sens;
+            sens << "sensor" << j;
+            pos.x -= 1.0f;
+            physics::Attack* att = world.createAttack(sens.str(), pos, b2_dynamicBody);
+            b2Fixture* fixt = att->createFixture("hit", geometry::AABB(1.5f, 1.5f), 1, 1,
+                    physics::Entity::Type::ThisType, physics::Entity::Type::ThisCollideWith, geometry::Point(0, 0), true);
+            world.setCallback(att, fixt, count);
+            world.setCallback(sens.str(), obs.str(), count);
+            att->setXLinearVelocity(speed);
+            sensors.push_back(att);
+        }
+
+        called = 0;
+        size_t contacts = 0;
+        size_t recorded = 0;
+        scenes::StepTimer timer;
+        for(int s = 0; s < steps; ++s) {
+            if(s > 0 && s % period == 0) {
+                for(physics::Entity* att : sensors)
+                    att->setXLinearVelocity(-att->getXLinearVelocity());
+            }
+
+            timer.step(world, dt);
+            contacts += (size_t)world.getWorld()->GetContactCount();
+            recorded += world.eventsRecorded();
+        }
+
+        std::cout << (defer ? "Deferred, " : "Immediate, ") << sizes[i] << " obstacles and sensors : "
+            << timer.average() << " ms/step, "
+            << (float)contacts / (float)steps << " contacts/step, "
+            << (float)called / (float)steps << " callbacks/step";
+        if(defer)
+            std::cout << ", " << (float)recorded / (float)steps << " events/step";
+        std::cout << "." << std::endl;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,82 @@
+
+#include "scenes.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+
+/* Checks the SIMD contact solver against the scalar one : 8 stacks of 12 boxes and a pyramid of 36 boxes are simulated
+ * for 10 seconds with each. The contacts are solved in another order, so the positions can't be the same, but they
+ * must differ by less than 0.05, and the top of each stack must have dropped by less than 0.5. */
+
+struct Result {
+    std::vector<geometry::Point> positions;
+    float maxDrop;
+};
+
+Result simulate(bool simd)
+{
+    const int stacks = 8;
+    const int height = 12;
+    const int base = 8;
+    const int steps = 600;
+    const float dt = 1.0f / 60.0f;
+
+    physics::World world(0.0f, -10.0f);
+    world.fixedStep(true);
+    world.simdSolver(simd);
+    scenes::ground(world, 50.0f, 120.0f);
+
+    std::vector<physics::Entity*> boxes;
+    std::vector<physics::Entity*> tops;
+    for(int i = 0; i < stacks; ++i) {
+        std::ostringstream oss;
+        oss << "stack" << i;
+        scenes::stack(world, oss.str(), (float)i * 3.0f, height, 0.0f, &boxes);
+        tops.push_back(boxes.back());
+    }
+    scenes::pyramid(world, "pyramid", 40.0f, base, &boxes);
+    tops.push_back(boxes.back());
+
+    std::vector<float> starts;
+    for(physics::Entity* ent : tops)
+        starts.push_back(ent->getPosition().y);
+
+    for(int s = 0; s < steps; ++s)
+        world.step(dt);
+
+    Result res;
+    for(physics::Entity* ent : boxes)
+        res.positions.push_back(ent->getPosition());
+    res.maxDrop = 0.0f;
+    for(size_t i = 0; i < tops.size(); ++i)
+        res.maxDrop = std::max(res.maxDrop, starts[i] - tops[i]->getPosition().y);
+    return res;
+}
+
+int main()
+{
+    const float tolerance = 0.05f;
+    const float fallen = 0.5f;
+
+    Result scalar = simulate(false);
+    Result simd = simulate(true);
+
+    float maxDiff = 0.0f;
+    for(size_t i = 0; i < scalar.positions.size(); ++i) {
+        maxDiff = std::max(maxDiff, std::abs(scalar.positions[i].x - simd.positions[i].x));
+        maxDiff = std::max(maxDiff, std::abs(scalar.positions[i].y - simd.positions[i].y));
+    }
+
+    bool ok = maxDiff < tolerance;
+    std::cout << "Maximum difference of position : " << maxDiff << " (tolerance " << tolerance << ")." << std::endl;
+
+    /* The top of each stack must be about where it started. */
+    std::cout << "Maximum drop of the top of a stack : " << scalar.maxDrop << " with the scalar solver, "
+        << simd.maxDrop << " with the SIMD one." << std::endl;
+    ok = ok && scalar.maxDrop < fallen && simd.maxDrop < fallen;
+
+    std::cout << (ok ? "Passed." : "FAILED.") << std::endl;
+    return ok ? 0 : 1;
+}
+
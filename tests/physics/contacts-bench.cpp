@@ -0,0 +1,47 @@
+
+#include "scenes.hpp"
+#include <iostream>
+#include <sstream>
+
+/* Measures the time of a step of the contact solver, with the scalar solver then with the SIMD one solving the
+ * independent contacts by groups of 4. The scenes are 4, 16 and 64 pyramids of 55 boxes side by side : the bodies never
+ * sleep, so all their contacts are solved at each step, and the number of contacts per step is printed too. */
+
+int main()
+{
+    const int sizes[] = {4, 16, 64};
+    const int base = 10;
+    const int steps = 300;
+    const float dt = 1.0f / 60.0f;
+
+    for(int k = 0; k < 2 * 3; ++k) {
+        int i = k % 3;
+        bool simd = k >= 3;
+        physics::World world(0.0f, -10.0f);
+        world.fixedStep(true);
+        world.simdSolver(simd);
+        world.getWorld()->SetAllowSleeping(false);
+
+        float width = (float)sizes[i] * ((float)base + 2.0f);
+        scenes::ground(world, width / 2.0f, width + 2.0f);
+        for(int p = 0; p < sizes[i]; ++p) {
+            std::ostringstream oss;
+            oss << "box" << p;
+            scenes::pyramid(world, oss.str(), (float)p * ((float)base + 2.0f), base, NULL);
+        }
+
+        size_t contacts = 0;
+        scenes::StepTimer timer;
+        for(int s = 0; s < steps; ++s) {
+            timer.step(world, dt);
+            contacts += (size_t)world.getWorld()->GetContactCount();
+        }
+
+        std::cout << (simd ? "SIMD, " : "Scalar, ") << sizes[i] << " pyramids of " << base * (base + 1) / 2 << " boxes : "
+            << timer.average() << " ms/step, "
+            << (float)contacts / (float)steps << " contacts/step." << std::endl;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,87 @@
+
+#include "scenes.hpp"
+#include "core/hash.hpp"
+#include "core/trace.hpp"
+#include <iostream>
+#include <vector>
+
+/* Checks the traces of the hashes of a match : a four characters match is simulated for 600 steps with 1 then 4 solver
+ * threads, the state of the world and the characters on the ground being hashed after each step. Both traces must be
+ * identical, and an impulse of 0.001 given to a character at step 250 must make the trace diverge at that step. */
+
+const int players = 4;
+const int steps = 600;
+const int pushed = 250;
+
+bool simulate(const std::string& path, int threads, bool push)
+{
+    physics::World world(0.0f, -20.0f);
+    world.fixedStep(true);
+    world.solverThreads(threads);
+    scenes::Match match;
+    scenes::match(world, players, 1, false, &match);
+
+    core::Trace trace;
+    std::vector<std::string> columns = {"physics", "ground"};
+    if(!trace.open(path, columns))
+        return false;
+
+    for(int s = 0; s < steps; ++s) {
+        scenes::play(s, match);
+        if(push && s == pushed)
+            match.charas[2]->applyLinearImpulse(0.001f, 0.0f);
+        world.step(world.stepDuration());
+
+        core::Hash physics, ground;
+        world.hash(physics);
+        for(physics::Character* ch : match.charas)
+            ground.add(ch->onGround());
+        uint64_t hashes[2] = {physics.value(), ground.value()};
+        trace.record((unsigned long)s, hashes);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    /* The traces are written in the directory given as argument, the current one by default. */
+    std::string dir = argc > 1 ? std::string(argv[1]) + "/" : std::string();
+    const std::string ref = dir + "determinism-ref.trace";
+    const std::string threads = dir + "determinism-threads.trace";
+    const std::string push = dir + "determinism-push.trace";
+    if(!simulate(ref, 1, false) || !simulate(threads, 4, false) || !simulate(push, 1, true)) {
+        std::cout << "Couldn't write the traces in \"" << (dir.empty() ? "." : argv[1]) << "\"." << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+    core::Trace::Divergence div;
+    if(!core::Trace::diff(ref, threads, &div)) {
+        std::cout << "Couldn't compare the traces with 1 and 4 threads." << std::endl;
+        ok = false;
+    }
+    else if(div.diverged) {
+        std::cout << "The traces with 1 and 4 threads diverge at frame " << div.frame << " in " << div.column << "." << std::endl;
+        ok = false;
+    }
+    else
+        std::cout << "The traces with 1 and 4 threads are identical." << std::endl;
+
+    if(!core::Trace::diff(ref, push, &div)) {
+        std::cout << "Couldn't compare the traces with and without the push." << std::endl;
+        ok = false;
+    }
+    else if(!div.diverged) {
+        std::cout << "The push wasn't found : the traces are identical." << std::endl;
+        ok = false;
+    }
+    else if(div.frame != pushed || div.column != "physics") {
+        std::cout << "The push at frame " << pushed << " was found at frame " << div.frame << " in " << div.column << "." << std::endl;
+        ok = false;
+    }
+    else
+        std::cout << "The push was found at frame " << div.frame << " in " << div.column << "." << std::endl;
+
+    return ok ? 0 : 1;
+}
+
@@ -0,0 +1,160 @@
+
+#include "physics/World.hpp"
+#include "physics/FixtureTable.hpp"
+#include "core/fakefs.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+
+/* Benchmark of the creation and destruction of short-lived entities, like the attacks : each one gets two fixtures,
+ * which are looked up by name a few times before the entity is destroyed. The world does a step between the creation
+ * and the destruction, like in a game : else Box2D would scan all the new proxies at each destruction.
+ * The storage of the fixtures is then measured alone, with the same operations on the FixtureTable used by the
+ * entities and on the FakeFS and name map they used before, so that both can be compared on the same machine. */
+
+/** @brief The storage of the fixtures of an entity before FixtureTable. */
+struct BaselineStorage {
+    core::FakeFS<b2Fixture*> fixtures;
+    std::unordered_map<b2Fixture*, std::string> names;
+
+    void add(const std::string& name, b2Fixture* fixture)
+    {
+        fixtures.createEntity(name, fixture);
+        names[fixture] = name;
+    }
+
+    b2Fixture* find(const std::string& name) const
+    {
+        if(!fixtures.existsEntity(name))
+            return nullptr;
+        return fixtures.getEntityValue(name);
+    }
+
+    void remove(b2Fixture* fixture)
+    {
+        auto it = names.find(fixture);
+        fixtures.deleteEntity(it->second);
+        names.erase(it);
+    }
+};
+
+/** @brief The storage of the fixtures of an entity with FixtureTable. */
+struct TableStorage {
+    physics::FixtureTable fixtures;
+
+    void add(const std::string& name, b2Fixture* fixture)
+    {
+        fixtures.add(name, fixture);
+    }
+
+    b2Fixture* find(const std::string& name) const
+    {
+        return fixtures.find(name);
+    }
+
+    void remove(b2Fixture* fixture)
+    {
+        fixtures.remove(fixture);
+    }
+};
+
+/** @brief Measures the life of nb storages of two fixtures, looked up lookups times each, in us per entity. */
+template <typename Storage> double storage(int nb, int rounds, int lookups, size_t* found)
+{
+    /* The fixtures are never dereferenced : fake pointers are enough. */
+    b2Fixture* main = reinterpret_cast<b2Fixture*>(0x10);
+    b2Fixture* foot = reinterpret_cast<b2Fixture*>(0x20);
+    std::vector<Storage*> storages(nb);
+
+    auto begin = std::chrono::steady_clock::now();
+    for(int r = 0; r < rounds; ++r) {
+        for(int j = 0; j < nb; ++j) {
+            storages[j] = new Storage;
+            storages[j]->add("main", main);
+            storages[j]->add("foot", foot);
+        }
+        for(int j = 0; j < nb; ++j) {
+            for(int k = 0; k < lookups; ++k) {
+                if(storages[j]->find(k % 2 ? "main" : "foot"))
+                    ++*found;
+            }
+        }
+        for(int j = 0; j < nb; ++j) {
+            storages[j]->remove(main);
+            storages[j]->remove(foot);
+            delete storages[j];
+        }
+    }
+    std::chrono::duration<double, std::micro> total = std::chrono::steady_clock::now() - begin;
+    return total.count() / ((double)nb * rounds);
+}
+
+int main()
+{
+    const int sizes[] = {100, 1000, 10000, 0};
+    const int rounds = 20;
+    const int lookups = 8;
+
+    for(int i = 0; sizes[i] != 0; ++i) {
+        physics::World world(0.0f, 0.0f);
+        std::vector<std::string> names;
+        for(int j = 0; j < sizes[i]; ++j) {
+            std::ostringstream oss;
+            oss << "entity" << j;
+            names.push_back(oss.str());
+        }
+
+        std::chrono::duration<double, std::micro> create(0), lookup(0), destroy(0);
+        size_t found = 0;
+        for(int r = 0; r < rounds; ++r) {
+            auto begin = std::chrono::steady_clock::now();
+            for(int j = 0; j < sizes[i]; ++j) {
+                physics::Entity* ent = world.createEntity(names[j], geometry::Point((float)j * 2.0f, 0.0f), b2_dynamicBody);
+                ent->createFixture("main", geometry::AABB(1.0f, 1.0f), 1, 1, physics::Entity::Type::ThisType,
+                        physics::Entity::Type::ThisCollideWith, geometry::Point(0, 0), true);
+                ent->createFixture("foot", geometry::AABB(0.5f, 0.1f), 1, 1, physics::Entity::Type::ThisType,
+                        physics::Entity::Type::ThisCollideWith, geometry::Point(0, -0.5f), true);
+            }
+            auto middle = std::chrono::steady_clock::now();
+            world.step(1.0f / 60.0f);
+            auto stepped = std::chrono::steady_clock::now();
+            for(int j = 0; j < sizes[i]; ++j) {
+                physics::Entity* ent = world.getEntity(names[j]);
+                for(int k = 0; k < lookups; ++k) {
+                    if(ent->getFixture(k % 2 ? "main" : "foot"))
+                        ++found;
+                }
+            }
+            auto end = std::chrono::steady_clock::now();
+            for(int j = 0; j < sizes[i]; ++j)
+                world.destroyEntity(names[j]);
+            auto last = std::chrono::steady_clock::now();
+
+            create  += middle - begin;
+            lookup  += end - stepped;
+            destroy += last - end;
+        }
+
+        double nb = (double)sizes[i] * rounds;
+        std::cout << sizes[i] << " entities : "
+            << create.count() / nb << " us to create, "
+            << lookup.count() / (nb * lookups) << " us per fixture lookup, "
+            << destroy.count() / nb << " us to destroy ("
+            << found << " fixtures found)." << std::endl;
+    }
+
+    for(int i = 0; sizes[i] != 0; ++i) {
+        size_t found = 0;
+        double baseline = storage<BaselineStorage>(sizes[i], rounds, lookups, &found);
+        double table = storage<TableStorage>(sizes[i], rounds, lookups, &found);
+        std::cout << sizes[i] << " fixture storages : "
+            << baseline << " us with FakeFS, "
+            << table << " us with FixtureTable ("
+            << found << " fixtures found)." << std::endl;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,76 @@
+
+#include "scenes.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cstring>
+
+/* Measures the time of a step with the islands solved by 1, 2 and 4 threads. The scenes are 50, 200 and 800 stacks of
+ * 10 boxes on the same ground, far enough from each other to be separated islands, and kept awake. The positions and
+ * angles of the boxes after 300 steps must be exactly the same whatever the number of threads. */
+
+std::vector<float> simulate(int stacks, int height, int steps, int threads, double* ms)
+{
+    const float dt = 1.0f / 60.0f;
+    physics::World world(0.0f, -10.0f);
+    world.fixedStep(true);
+    world.solverThreads(threads);
+    /* The stacks would fall asleep once stable, and there would be nothing left to solve. */
+    world.getWorld()->SetAllowSleeping(false);
+    scenes::ground(world, (float)stacks * 1.5f, (float)stacks * 3.0f + 2.0f);
+
+    std::vector<physics::Entity*> boxes;
+    for(int i = 0; i < stacks; ++i) {
+        std::ostringstream oss;
+        oss << "box" << i;
+        /* A small shift so the stacks move a bit. */
+        scenes::stack(world, oss.str(), (float)i * 3.0f, height, 0.05f, &boxes);
+    }
+
+    scenes::StepTimer timer;
+    for(int s = 0; s < steps; ++s)
+        timer.step(world, dt);
+    *ms = timer.average();
+
+    std::vector<float> state;
+    for(physics::Entity* ent : boxes) {
+        const b2Body* body = ent->getBody();
+        state.push_back(body->GetPosition().x);
+        state.push_back(body->GetPosition().y);
+        state.push_back(body->GetAngle());
+    }
+    return state;
+}
+
+int main()
+{
+    const int sizes[] = {50, 200, 800, 0};
+    const int threads[] = {1, 2, 4, 0};
+    const int height = 10;
+    const int steps = 300;
+    bool identical = true;
+
+    for(int i = 0; sizes[i] != 0; ++i) {
+        std::vector<float> serial;
+        for(int t = 0; threads[t] != 0; ++t) {
+            double ms;
+            std::vector<float> state = simulate(sizes[i], height, steps, threads[t], &ms);
+            bool same = true;
+            if(t == 0)
+                serial = state;
+            else
+                same = state.size() == serial.size()
+                    && std::memcmp(&state[0], &serial[0], state.size() * sizeof(float)) == 0;
+            identical = identical && same;
+
+            std::cout << sizes[i] << " stacks of " << height << " boxes, " << threads[t] << " thread(s) : "
+                << ms << " ms/step";
+            if(t > 0)
+                std::cout << (same ? ", same results" : ", DIFFERENT RESULTS");
+            std::cout << "." << std::endl;
+        }
+    }
+
+    return identical ? 0 : 1;
+}
+
@@ -7,8 +7,6 @@
 #include "events/events.hpp"
 #include "gameplay/character.hpp"
 #include "gameplay/controler.hpp"
-#include "lua/graphicsExposure.hpp"
-#include "lua/charaExposure.hpp"
 #include "physics/World.hpp"
 #include "global.hpp"
 
@@ -112,7 +110,6 @@ int main()
     core::logger::minLevel(core::logger::WARNING);
     graphics::Graphics* gfx = new graphics::Graphics;
     global::gfx = gfx;
-    lua::exposure::Graphics::setGraphicsInstance(gfx);
     physics::World world(0,-10.0f);
 
     bool cont = false;
@@ -125,15 +122,15 @@ int main()
     if(!cont)
         return 1;
 
-    gameplay::Character* chara = new gameplay::Character("rcs/chara/fighter");
+    gameplay::Character* chara = new gameplay::Character("rcs/chara/fighter", gfx);
     if(!chara->preload()) {
         core::logger::logm("Couldn't load the character preview.", core::logger::FATAL);
         return 1;
     }
     std::cout << "Character **" << chara->name() << "** loaded : " << chara->desc() << std::endl;
-    lua::exposure::characters[0] = chara;
+    gameplay::Character* charas[4] = {chara, NULL, NULL, NULL};
 
-    if(!chara->load(gameplay::Character::None, 0)) {
+    if(!chara->load(gameplay::Character::None, 0, charas)) {
         core::logger::logm("Couldn't load the character.", core::logger::FATAL);
         return 1;
     }
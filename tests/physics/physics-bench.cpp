@@ -0,0 +1,114 @@
+
+#include "scenes.hpp"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <new>
+
+/* Measures the steps per second of the matches of 2, 4 and 32 characters running and jumping through one-way platforms,
+ * with attacks enabled and disabled from a pool in the last two. Each match is stepped the number of thousands of steps
+ * given as argument (5 by default), and a JSON object is printed per match : the steps per second, the time per step
+ * split as b2Profile does and the counts given by World::stats, and the allocations per step made with new. */
+
+static size_t allocations = 0;
+static size_t allocated = 0;
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    allocated += size;
+    void* ptr = std::malloc(size ? size : 1);
+    if(!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+/** @brief A match to simulate. */
+struct Scenario {
+    const char* name; /**< @brief The name printed. */
+    int characters;   /**< @brief The number of characters. */
+    int floors;       /**< @brief The number of rows of platforms above the ground. */
+    bool attacks;     /**< @brief Do the characters attack. */
+};
+
+void run(const Scenario& sc, int steps)
+{
+    physics::World world(0.0f, -20.0f);
+    world.fixedStep(true);
+    scenes::Match match;
+    scenes::match(world, sc.characters, sc.floors, sc.attacks, &match);
+
+    /* Warming up, so the pools of Box2D and of the world are filled. */
+    const int warmup = 120;
+    for(int s = 0; s < warmup; ++s) {
+        scenes::play(s, match);
+        world.step(world.stepDuration());
+    }
+
+    /* The times of all the steps measured are averaged by the statistics of the world. */
+    world.statsWindow(steps);
+    size_t contacts = 0;
+    match.hits = 0;
+    size_t allocs = allocations;
+    size_t bytes = allocated;
+    scenes::StepTimer timer;
+    for(int s = warmup; s < warmup + steps; ++s) {
+        scenes::play(s, match);
+        timer.step(world, world.stepDuration());
+        contacts += (size_t)world.getWorld()->GetContactCount();
+    }
+    allocs = allocations - allocs;
+    bytes = allocated - bytes;
+
+    double nb = (double)steps;
+    physics::World::Stats stats = world.stats();
+    const b2Profile& avg = stats.average;
+    std::cout << "{\"scenario\": \"" << sc.name << "\""
+        << ", \"characters\": " << sc.characters
+        << ", \"platforms\": " << match.platforms
+        << ", \"bodies\": " << stats.bodies
+        << ", \"awake\": " << stats.awake
+        << ", \"steps\": " << steps
+        << ", \"steps_per_second\": " << nb * 1000.0 / timer.total()
+        << ", \"ms_per_step\": " << timer.average()
+        << ", \"profile_ms\": {"
+        << "\"step\": " << avg.step
+        << ", \"collide\": " << avg.collide
+        << ", \"solve\": " << avg.solve
+        << ", \"solve_init\": " << avg.solveInit
+        << ", \"solve_velocity\": " << avg.solveVelocity
+        << ", \"solve_position\": " << avg.solvePosition
+        << ", \"broadphase\": " << avg.broadphase
+        << ", \"solve_toi\": " << avg.solveTOI << "}"
+        << ", \"allocations_per_step\": " << (double)allocs / nb
+        << ", \"bytes_per_step\": " << (double)bytes / nb
+        << ", \"contacts_per_step\": " << (double)contacts / nb
+        << ", \"touching\": " << stats.touching
+        << ", \"toi_per_step\": " << stats.toiAverage
+        << ", \"hits\": " << match.hits << "}" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int thousands = argc > 1 ? std::atoi(argv[1]) : 5;
+    if(thousands <= 0) {
+        std::cout << "Usage : " << argv[0] << " [thousands of steps]" << std::endl;
+        return 1;
+    }
+
+    const Scenario scenarios[] = {
+        {"duel",  2,  2, false},
+        {"brawl", 4,  3, true},
+        {"crowd", 32, 4, true},
+    };
+    for(const Scenario& sc : scenarios)
+        run(sc, thousands * 1000);
+
+    return 0;
+}
+
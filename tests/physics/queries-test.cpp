@@ -0,0 +1,181 @@
+
+#include "physics/World.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+/* Checks the spatial queries of physics::World on 64 characters scattered over 10 rows of 20 platforms. The entities
+ * found by 2000 overlap and queryAABB queries are checked against a loop over all the entities, and the rays cast down
+ * on the platforms must stop on their top. The average time of an overlap is printed with the one of the loop.
+ * A row of 5 baked platforms, merged in one fixture, is then split by unbaking the middle one : overlap must report the
+ * two fixtures left, each with its own center. */
+
+const int rows = 10;
+const int perRow = 20;
+const int characters = 64;
+const int queries = 2000;
+
+/** @brief An entity created, with its rectangle. */
+struct Placed {
+    physics::Entity* ent;
+    geometry::Point center;
+    geometry::AABB rect;
+};
+
+/* Does a fixture of the entity touch the rectangle : all the fixtures are boxes, so their bounding boxes are exact.
+ * Box2D keeps a skin of b2_polygonRadius around the polygons, counted in the rectangle too. */
+bool inside(const Placed& p, const geometry::Point& c, const geometry::AABB& r)
+{
+    const b2Body* body = p.ent->getBody();
+    for(const b2Fixture* fixt = body->GetFixtureList(); fixt; fixt = fixt->GetNext()) {
+        b2AABB box;
+        fixt->GetShape()->ComputeAABB(&box, body->GetTransform(), 0);
+        float margin = b2_polygonRadius;
+        if(box.lowerBound.x < c.x + r.width / 2.0f + margin && box.upperBound.x > c.x - r.width / 2.0f - margin
+                && box.lowerBound.y < c.y + r.height / 2.0f + margin && box.upperBound.y > c.y - r.height / 2.0f - margin)
+            return true;
+    }
+    return false;
+}
+
+/** @brief Unbakes the middle of a row of baked platforms, and checks the fixtures reported by overlap. */
+bool unbake()
+{
+    physics::World world(0.0f, -10.0f);
+    std::vector<physics::World::StaticRect> rects;
+    for(int i = 0; i < 5; ++i) {
+        physics::World::StaticRect r = {geometry::Point((float)i * 2.0f, 0.0f), geometry::AABB(2.0f, 0.5f), 1.0f};
+        rects.push_back(r);
+    }
+    physics::Entity* ent = world.bakeStatic("baked", rects, physics::Entity::Type::Platform);
+    if(!ent || ent->getBody()->GetFixtureList()->GetNext()) {
+        std::cout << "bakeStatic didn't merge the row of platforms in one fixture." << std::endl;
+        return false;
+    }
+    if(!world.unbakeStatic("baked", 2) || world.unbakeStatic("baked", 2)) {
+        std::cout << "unbakeStatic didn't remove the middle platform once." << std::endl;
+        return false;
+    }
+
+    std::vector<physics::Entity*> found;
+    std::vector<b2Fixture*> fixtures;
+    world.overlap(geometry::Point(4.0f, 0.0f), geometry::AABB(10.0f, 1.0f), found, physics::Entity::Type::All, NULL, &fixtures);
+    std::vector<float> centers;
+    for(b2Fixture* fixt : fixtures) {
+        b2AABB box;
+        fixt->GetShape()->ComputeAABB(&box, ent->getBody()->GetTransform(), 0);
+        centers.push_back(box.GetCenter().x);
+    }
+    std::sort(centers.begin(), centers.end());
+    if(found.size() != 2 || centers.size() != 2 || std::abs(centers[0] - 1.0f) > 1e-4f || std::abs(centers[1] - 7.0f) > 1e-4f) {
+        std::cout << "overlap doesn't report the two fixtures left around the unbaked platform." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    physics::World world(0.0f, -10.0f);
+    std::vector<Placed> placed;
+    for(int r = 0; r < rows; ++r) {
+        for(int i = 0; i < perRow; ++i) {
+            std::ostringstream oss;
+            oss << "platform" << r << "_" << i;
+            Placed p;
+            p.center = geometry::Point((float)i * 10.0f, (float)r * 6.0f);
+            p.rect = geometry::AABB(6.0f, 0.5f);
+            p.ent = world.createPlatform(oss.str(), p.center, p.rect);
+            placed.push_back(p);
+        }
+    }
+    for(int i = 0; i < characters; ++i) {
+        std::ostringstream oss;
+        oss << "player" << i;
+        Placed p;
+        p.center = geometry::Point((float)((i * 37) % 190) + 0.5f, (float)((i * 13) % rows) * 6.0f + 2.0f);
+        p.rect = geometry::AABB(1.0f, 2.0f);
+        physics::Character* ch = world.createCharacter(oss.str(), p.center, p.rect, physics::Character::Weight::Medium);
+        ch->setID(i);
+        p.ent = ch;
+        placed.push_back(p);
+    }
+    /* A step, so the bodies are in the broad-phase where they are. */
+    world.step(1.0f / 60.0f);
+    for(Placed& p : placed)
+        p.center = p.ent->getPosition();
+
+    bool ok = true;
+    std::vector<physics::Entity*> found;
+    std::chrono::duration<double, std::micro> tquery(0), tloop(0);
+    size_t total = 0;
+    for(int q = 0; q < queries; ++q) {
+        geometry::Point c((float)((q * 53) % 200), (float)((q * 29) % 60));
+        geometry::AABB r(8.0f, 7.0f);
+        uint16 types = q % 2 ? physics::Entity::Type::All : physics::Entity::Type::Character;
+
+        found.clear();
+        auto begin = std::chrono::steady_clock::now();
+        world.overlap(c, r, found, types);
+        auto middle = std::chrono::steady_clock::now();
+        std::vector<physics::Entity*> expected;
+        for(const Placed& p : placed) {
+            if((p.ent->getType() & types) && inside(p, c, r))
+                expected.push_back(p.ent);
+        }
+        auto end = std::chrono::steady_clock::now();
+        tquery += middle - begin;
+        tloop += end - middle;
+        total += found.size();
+
+        std::sort(found.begin(), found.end());
+        std::sort(expected.begin(), expected.end());
+        if(found != expected) {
+            std::cout << "overlap differs at query " << q << " : " << found.size() << " entities found, "
+                << expected.size() << " expected." << std::endl;
+            ok = false;
+        }
+
+        /* queryAABB finds the same ones, with maybe some more because of the margin of the broad-phase. */
+        std::vector<physics::Entity*> boxes;
+        world.queryAABB(c, r, boxes, types);
+        std::sort(boxes.begin(), boxes.end());
+        if(!std::includes(boxes.begin(), boxes.end(), expected.begin(), expected.end())
+                || std::adjacent_find(boxes.begin(), boxes.end()) != boxes.end()) {
+            std::cout << "queryAABB misses an entity or reports it twice at query " << q << "." << std::endl;
+            ok = false;
+        }
+    }
+
+    /* Down from above each platform of the first row : the ray must stop on its top. */
+    for(int i = 0; i < perRow; ++i) {
+        physics::World::RayHit hit;
+        geometry::Point from((float)i * 10.0f, 4.0f);
+        bool touched = world.raycast(from, geometry::Point(from.x, -4.0f), &hit, physics::Entity::Type::Platform);
+        if(!touched || hit.entity != placed[i].ent || std::abs(hit.point.y - 0.25f) > 1e-4f || hit.normal.y < 0.99f) {
+            std::cout << "raycast missed the platform " << i << "." << std::endl;
+            ok = false;
+        }
+    }
+    physics::World::RayHit none;
+    if(world.raycast(geometry::Point(5.0f, 1.0f), geometry::Point(5.0f, 5.0f), &none, physics::Entity::Type::Platform)) {
+        std::cout << "raycast hit a platform between two rows." << std::endl;
+        ok = false;
+    }
+    /* Without a hit to fill, it only tells if the ray touches something. */
+    if(!world.raycast(geometry::Point(0.0f, 4.0f), geometry::Point(0.0f, -4.0f), NULL, physics::Entity::Type::Platform)) {
+        std::cout << "raycast without a hit to fill missed a platform." << std::endl;
+        ok = false;
+    }
+
+    ok = unbake() && ok;
+
+    std::cout << placed.size() << " entities, " << (float)total / (float)queries << " found per query : "
+        << tquery.count() / queries << " us per overlap, " << tloop.count() / queries << " us per loop over all the entities." << std::endl;
+    std::cout << (ok ? "All the queries are right." : "Some queries are WRONG.") << std::endl;
+    return ok ? 0 : 1;
+}
+
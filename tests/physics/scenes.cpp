@@ -0,0 +1,140 @@
+
+#include "scenes.hpp"
+#include <sstream>
+
+namespace scenes
+{
+    void ground(physics::World& world, float x, float width)
+    {
+        world.createObstacle("ground", geometry::Point(x, -0.5f), geometry::AABB(width, 1.0f));
+    }
+
+    /** @brief Creates a dynamic box of 1*1. */
+    static physics::Entity* box(physics::World& world, const std::string& name, const geometry::Point& pos)
+    {
+        physics::Entity* ent = world.createEntity(name, pos, b2_dynamicBody,
+                physics::Entity::Type::Default, physics::Entity::Type::All, 1, false);
+        ent->createFixture("main", geometry::AABB(1.0f, 1.0f), 1, 0.6f);
+        return ent;
+    }
+
+    void stack(physics::World& world, const std::string& name, float x, int height, float shift, std::vector<physics::Entity*>* boxes)
+    {
+        for(int j = 0; j < height; ++j) {
+            std::ostringstream oss;
+            oss << name << "_" << j;
+            physics::Entity* ent = box(world, oss.str(), geometry::Point(x + (float)(j % 3) * shift, 0.5f + (float)j));
+            if(boxes)
+                boxes->push_back(ent);
+        }
+    }
+
+    void pyramid(physics::World& world, const std::string& name, float x, int base, std::vector<physics::Entity*>* boxes)
+    {
+        for(int row = 0; row < base; ++row) {
+            for(int col = 0; col < base - row; ++col) {
+                std::ostringstream oss;
+                oss << name << "_" << row << "_" << col;
+                physics::Entity* ent = box(world, oss.str(), geometry::Point(x + (float)col + (float)row * 0.5f, 0.5f + (float)row));
+                if(boxes)
+                    boxes->push_back(ent);
+            }
+        }
+    }
+
+    /** @brief Counts the contacts begun by an attack in the match given as data. */
+    static void hit(physics::Entity*, physics::Entity*, bool bg, void* data)
+    {
+        if(bg)
+            ++static_cast<Match*>(data)->hits;
+    }
+
+    void match(physics::World& world, int characters, int floors, bool attacks, Match* m)
+    {
+        m->charas.clear();
+        m->attacks.clear();
+        m->platforms = 0;
+        m->hits = 0;
+
+        float width = 10.0f * (float)characters + 10.0f;
+        world.createObstacle("ground", geometry::Point(0.0f, -1.0f), geometry::AABB(width, 2.0f));
+        world.createObstacle("wallleft", geometry::Point(-width / 2.0f, 10.0f), geometry::AABB(1.0f, 24.0f));
+        world.createObstacle("wallright", geometry::Point(width / 2.0f, 10.0f), geometry::AABB(1.0f, 24.0f));
+        for(int f = 0; f < floors; ++f) {
+            for(float x = -width / 2.0f + 6.0f + (float)(f % 2) * 4.0f; x < width / 2.0f - 6.0f; x += 12.0f) {
+                std::ostringstream oss;
+                oss << "platform" << m->platforms++;
+                world.createPlatform(oss.str(), geometry::Point(x, 4.0f + 4.0f * (float)f), geometry::AABB(6.0f, 0.5f));
+            }
+        }
+
+        for(int i = 0; i < characters; ++i) {
+            std::ostringstream name;
+            name << "player" << i;
+            float x = -width / 2.0f + 5.0f + (float)i * 10.0f;
+            physics::Character* ch = world.createCharacter(name.str(), geometry::Point(x, 2.0f),
+                    geometry::AABB(1.0f, 2.0f), physics::Character::Weight::Medium);
+            ch->setID(i % 4);
+            m->charas.push_back(ch);
+            if(!attacks)
+                continue;
+
+            /* A pooled attack, as the ones of gameplay::Character. */
+            std::ostringstream att;
+            att << "attack" << i;
+            physics::Attack* ent = world.createAttack(att.str(), geometry::Point(x, 2.0f), b2_dynamicBody,
+                    physics::Attack::CollideType::Normal, 0.0f);
+            ent->createFixture("main", geometry::AABB(1.0f, 1.0f), 1, 1, physics::Entity::Type::ThisType,
+                    physics::Entity::Type::ThisCollideWith, geometry::Point(0, 0), true);
+            ent->setActive(false);
+            world.setCallback(att.str(), hit, m);
+            m->attacks.push_back(ent);
+        }
+    }
+
+    void play(int step, Match& m)
+    {
+        for(size_t i = 0; i < m.charas.size(); ++i) {
+            physics::Character* ch = m.charas[i];
+            int id = (int)i;
+            ch->setXLinearVelocity((float)((step / 40 + id) % 3 - 1) * 6.0f);
+            if((step * 7 + id * 13) % 50 == 0 && ch->onGround())
+                ch->jump(12.0f);
+
+            if(m.attacks.empty())
+                continue;
+            int phase = (step + id * 11) % 45;
+            if(phase == 0) {
+                geometry::Point pos = ch->getPosition();
+                m.attacks[i]->setPosition(geometry::Point(pos.x + 1.0f, pos.y));
+                m.attacks[i]->setActive(true);
+            }
+            else if(phase == 10)
+                m.attacks[i]->setActive(false);
+        }
+    }
+
+    StepTimer::StepTimer()
+        : m_time(0), m_steps(0)
+    {}
+
+    void StepTimer::step(physics::World& world, float dt)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        world.step(dt);
+        auto end = std::chrono::steady_clock::now();
+        m_time += end - begin;
+        ++m_steps;
+    }
+
+    double StepTimer::total() const
+    {
+        return m_time.count();
+    }
+
+    double StepTimer::average() const
+    {
+        return m_steps > 0 ? m_time.count() / m_steps : 0.0;
+    }
+}
+
@@ -0,0 +1,59 @@
+
+#ifndef DEF_TESTS_PHYSICS_SCENES
+#define DEF_TESTS_PHYSICS_SCENES
+
+#include "physics/World.hpp"
+#include <string>
+#include <vector>
+#include <chrono>
+
+/** @brief The scenes shared by the headless tests and benchmarks of physics::World. */
+namespace scenes
+{
+    /** @brief Creates a static ground named "ground", of the given width, centred on x, its top at y = 0. */
+    void ground(physics::World& world, float x, float width);
+    /** @brief Creates a stack of height boxes of 1*1, the lowest one centred at (x, 0.5).
+     * The box j is shifted by (j % 3) * shift along x. The boxes are appended to boxes if it isn't NULL.
+     */
+    void stack(physics::World& world, const std::string& name, float x, int height, float shift, std::vector<physics::Entity*>* boxes);
+    /** @brief Creates a pyramid of boxes of 1*1, with base boxes in its lowest row, the first one centred at (x, 0.5).
+     * The boxes are appended row by row to boxes if it isn't NULL.
+     */
+    void pyramid(physics::World& world, const std::string& name, float x, int base, std::vector<physics::Entity*>* boxes);
+
+    /** @brief A match : characters running and jumping through rows of one-way platforms, between two walls. */
+    struct Match {
+        std::vector<physics::Character*> charas; /**< @brief The characters. */
+        std::vector<physics::Attack*> attacks;   /**< @brief The pooled attacks of the characters, empty if they don't attack. */
+        int platforms;                           /**< @brief The number of platforms. */
+        unsigned int hits;                       /**< @brief The number of contacts begun by the attacks. */
+    };
+    /** @brief Creates a match in world : the ground is 10 wide per character plus 10, with floors rows of platforms above it.
+     * The match must stay at the same address as long as the world is stepped, its hits being counted by the callbacks.
+     */
+    void match(physics::World& world, int characters, int floors, bool attacks, Match* m);
+    /** @brief Gives the inputs of a step to the characters of a match, always the same for a step. */
+    void play(int step, Match& m);
+
+    /** @brief Measures the time of the steps of a world. */
+    class StepTimer
+    {
+        public:
+            StepTimer();
+            ~StepTimer() = default;
+
+            /** @brief Advances the world of dt seconds, timing it. */
+            void step(physics::World& world, float dt);
+            /** @brief Returns the total time of the steps in ms. */
+            double total() const;
+            /** @brief Returns the average time of a step in ms. */
+            double average() const;
+
+        private:
+            std::chrono::duration<double, std::milli> m_time; /**< @brief The total time of the steps. */
+            int m_steps;                                      /**< @brief The number of steps timed. */
+    };
+}
+
+#endif
+
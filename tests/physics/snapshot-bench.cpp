@@ -0,0 +1,82 @@
+
+#include "scenes.hpp"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstring>
+
+/* Measures the size of a snapshot of the physics of a four characters match, with attacks and a rope between two
+ * characters, and the time to save and restore it. The match is then replayed from a restored snapshot with the same
+ * inputs : the positions, the velocities and the hits of the attacks must be exactly the same as the first time. */
+
+const int players = 4;
+const int warmup = 120;
+const int replay = 240;
+const int repeats = 1000;
+
+std::vector<float> run(physics::World& world, int begin, int end, scenes::Match& match)
+{
+    std::vector<float> trace;
+    for(int s = begin; s < end; ++s) {
+        scenes::play(s, match);
+        world.step(1.0f / 60.0f);
+        for(b2Body* body = world.getWorld()->GetBodyList(); body; body = body->GetNext()) {
+            trace.push_back(body->GetPosition().x);
+            trace.push_back(body->GetPosition().y);
+            trace.push_back(body->GetLinearVelocity().x);
+            trace.push_back(body->GetLinearVelocity().y);
+        }
+        for(physics::Character* ch : match.charas)
+            trace.push_back(ch->onGround() ? 1.0f : 0.0f);
+    }
+    return trace;
+}
+
+int main()
+{
+    physics::World world(0.0f, -20.0f);
+    world.fixedStep(true);
+    scenes::Match match;
+    scenes::match(world, players, 2, true, &match);
+    world.createRopeJoint("rope", match.charas[0], match.charas[1], 10.0f);
+
+    run(world, 0, warmup, match);
+
+    std::vector<char> state;
+    size_t size = world.snapshot(state);
+    match.hits = 0;
+    std::vector<float> first = run(world, warmup, warmup + replay, match);
+    unsigned int firstHits = match.hits;
+
+    if(!world.restore(state)) {
+        std::cout << "The snapshot couldn't be restored." << std::endl;
+        return 1;
+    }
+    match.hits = 0;
+    std::vector<float> second = run(world, warmup, warmup + replay, match);
+    bool same = first.size() == second.size()
+        && std::memcmp(&first[0], &second[0], first.size() * sizeof(float)) == 0
+        && match.hits == firstHits;
+
+    /* Timing the snapshots and restorations, in a match going on. */
+    std::vector<char> other;
+    std::chrono::duration<double, std::micro> save(0), load(0);
+    for(int r = 0; r < repeats; ++r) {
+        auto begin = std::chrono::steady_clock::now();
+        world.snapshot(other);
+        auto middle = std::chrono::steady_clock::now();
+        world.restore(state);
+        auto end = std::chrono::steady_clock::now();
+        save += middle - begin;
+        load += end - middle;
+    }
+
+    std::cout << players << " characters, " << world.getWorld()->GetBodyCount() << " bodies, "
+        << world.getWorld()->GetContactCount() << " contacts : snapshot of " << size << " bytes, "
+        << save.count() / repeats << " us to save, " << load.count() / repeats << " us to restore." << std::endl;
+    std::cout << "Replay after the restoration : " << (same ? "same" : "DIFFERENT") << " positions and callbacks ("
+        << firstHits << " hits)." << std::endl;
+
+    return same ? 0 : 1;
+}
+
@@ -0,0 +1,341 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include "core/logger.hpp"
+#include "core/config.hpp"
+#include "core/hash.hpp"
+#include "events/events.hpp"
+#include "gameplay/character.hpp"
+#include "gameplay/controler.hpp"
+#include "gameplay/stage.hpp"
+#include "global.hpp"
+
+/* Plays many AI-vs-AI matches of the game without window nor graphics, spread over threads, for balance testing.
+ * Each match loads the stage and the characters with their lua scripts as the game does, but without graphics, and
+ * lasts as long as a game : the appearance, then 3 minutes. Each update is one physics step of game time, so a match
+ * is played as fast as the CPU allows. The characters are driven by a simple AI whose random choices only depend on
+ * the seed of the match, and the physics are solved on one thread : the results of a match don't depend on the number
+ * of threads. A JSON object is printed per match, then one with the totals.
+ * Usage : matchrunner <stage> <characters, 2 to 4, separated by commas> [matches] [threads] [seed] */
+
+/** @brief The duration of a game in ms, as in GameMenu. */
+const Uint32 gameDuration = 180000;
+
+/** @brief A small random generator (xorshift), one per match. */
+class Random
+{
+    public:
+        explicit Random(uint32_t seed) : m_state(seed ? seed : 0x9e3779b9u)
+        {}
+
+        uint32_t next()
+        {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return m_state;
+        }
+
+        /** @brief Returns true once in n calls. */
+        bool chance(uint32_t n)
+        {
+            return next() % n == 0;
+        }
+
+    private:
+        uint32_t m_state;
+};
+
+/** @brief The results of a match. */
+struct Result {
+    int id;                     /**< @brief The index of the match. */
+    uint32_t seed;              /**< @brief The seed of its random generator. */
+    bool loaded;                /**< @brief Could the stage and the characters be loaded. */
+    unsigned long updates;      /**< @brief The updates played. */
+    int winner;                 /**< @brief The player with the most points, -1 for a draw. */
+    std::vector<int> points;    /**< @brief The points of each player : one per KO, minus one per death. */
+    std::vector<int> damages;   /**< @brief The damages of each player at the end. */
+    uint64_t hash;              /**< @brief The hash of the final state of the characters, the same for the same seed. */
+    double ms;                  /**< @brief The time taken by the match. */
+};
+
+/** @brief Defines the physics options read by the stages, with the defaults of the game. */
+void options(core::Config& cfg)
+{
+    cfg.define("phdebug",         0, "", false);
+    cfg.define("phdebugaabb",     0, "", false);
+    cfg.define("phdebugcontacts", 0, "", false);
+    cfg.define("phfixed",         0, "", true);
+    cfg.define("phrate",          0, "", 60.0f);
+    cfg.define("phsubsteps",      0, "", 5);
+    cfg.define("phvelit",         0, "", 10);
+    cfg.define("phposit",         0, "", 8);
+    cfg.define("phdeferevents",   0, "", false);
+    cfg.define("phthreads",       0, "", 1);
+    cfg.define("phsimd",          0, "", false);
+    cfg.define("phbake",          0, "", true);
+    cfg.define("phstats",         0, "", 0);
+    cfg.define("phstatslevel",    0, "", 1);
+    cfg.define("phtrace",         0, "", "");
+}
+
+/** @brief A match on a real stage between real characters, played without graphics. */
+class Match
+{
+    public:
+        Match(int id, uint32_t seed, const std::string& stage, const std::vector<std::string>& charas)
+            : m_random(seed), m_stage(NULL), m_players((int)charas.size())
+        {
+            m_result.id = id;
+            m_result.seed = seed;
+            m_result.loaded = false;
+            m_result.updates = 0;
+            m_result.winner = -1;
+            m_result.hash = 0;
+            m_result.ms = 0.0;
+            options(m_cfg);
+
+            for(int i = 0; i < 4; ++i) {
+                m_charas[i] = NULL;
+                m_ctrls[i] = NULL;
+            }
+
+            bool ok = true;
+            for(int i = 0; i < m_players && ok; ++i) {
+                m_charas[i] = new gameplay::Character(charas[i], NULL);
+                ok = m_charas[i]->preload() && m_charas[i]->load(gameplay::Character::None, i, m_charas);
+                /* The controler isn't opened : the character only receives the inputs of the AI. */
+                m_ctrls[i] = new gameplay::Controler("");
+                m_ctrls[i]->attach(m_charas[i]);
+            }
+            if(ok) {
+                m_stage = new gameplay::Stage(stage, NULL, &m_cfg);
+                ok = m_stage->preload() && m_stage->load(m_ctrls);
+            }
+            m_result.loaded = ok;
+        }
+
+        ~Match()
+        {
+            /* The characters remove themselves from the world of the stage, so they are deleted before it. */
+            for(int i = 0; i < 4; ++i) {
+                if(m_charas[i])
+                    delete m_charas[i];
+            }
+            if(m_stage)
+                delete m_stage;
+            for(int i = 0; i < 4; ++i) {
+                if(m_ctrls[i])
+                    delete m_ctrls[i];
+            }
+        }
+
+        /** @brief Plays the appearance and the game. */
+        const Result& run(const events::Events& evs)
+        {
+            if(!m_result.loaded)
+                return m_result;
+
+            auto begin = std::chrono::steady_clock::now();
+            while(m_stage->appearProgress() < 1.0f)
+                update(evs);
+            unsigned long updates = (unsigned long)((double)gameDuration / 1000.0 * (double)m_cfg.get<float>("phrate"));
+            for(unsigned long u = 0; u < updates; ++u) {
+                for(int i = 0; i < m_players; ++i)
+                    think(i);
+                update(evs);
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            core::Hash h;
+            int best = 0;
+            for(int i = 0; i < m_players; ++i) {
+                m_result.points.push_back(m_charas[i]->getPoints());
+                m_result.damages.push_back(m_charas[i]->getDamages());
+                core::Hash state, damages, attacks;
+                m_charas[i]->hash(state, damages, attacks);
+                h.add(state.value());
+                h.add(damages.value());
+                h.add(attacks.value());
+                if(m_result.points[i] > m_result.points[best])
+                    best = i;
+            }
+            m_result.winner = best;
+            for(int i = 0; i < m_players; ++i) {
+                if(i != best && m_result.points[i] == m_result.points[best])
+                    m_result.winner = -1;
+            }
+            m_result.hash = h.value();
+            m_result.ms = std::chrono::duration<double, std::milli>(end - begin).count();
+            return m_result;
+        }
+
+    private:
+        core::Config m_cfg;
+        Random m_random;
+        gameplay::Stage* m_stage;
+        gameplay::Character* m_charas[4];
+        gameplay::Controler* m_ctrls[4];
+        int m_players;
+        Result m_result;
+
+        /** @brief One update of the game : draw only runs the scripts of the characters without graphics. */
+        void update(const events::Events& evs)
+        {
+            m_stage->update(evs);
+            m_stage->draw();
+            ++m_result.updates;
+        }
+
+        /** @brief The inputs of the AI of a character for the next update : chasing the nearest opponent and hitting it. */
+        void think(int id)
+        {
+            gameplay::Character* me = m_charas[id];
+            if(me->dead())
+                return;
+            geometry::Point pos = me->getPos();
+
+            gameplay::Character* target = NULL;
+            float best = 0.0f;
+            for(int i = 0; i < m_players; ++i) {
+                if(i == id || m_charas[i]->dead())
+                    continue;
+                geometry::Point op = m_charas[i]->getPos();
+                float dist = std::abs(op.x - pos.x) + std::abs(op.y - pos.y);
+                if(!target || dist < best) {
+                    target = m_charas[i];
+                    best = dist;
+                }
+            }
+            if(!target) {
+                me->action(gameplay::Character::Walk, gameplay::Character::Fixed);
+                return;
+            }
+
+            geometry::Point tp = target->getPos();
+            float dx = tp.x - pos.x;
+            float dy = tp.y - pos.y;
+            gameplay::Character::Direction side = dx < 0.0f ? gameplay::Character::Left : gameplay::Character::Right;
+
+            if(std::abs(dx) < 2.0f && std::abs(dy) < 1.5f && m_random.chance(4)) {
+                uint32_t pick = m_random.next() % 8;
+                if(pick < 4)
+                    me->action(gameplay::Character::Attack, gameplay::Character::Fixed);
+                else if(pick < 6)
+                    me->action(gameplay::Character::Smash, side);
+                else
+                    me->action(gameplay::Character::Spell, pick == 6 ? side : gameplay::Character::Fixed);
+            }
+            else if((dy > 1.5f && me->onGround() && m_random.chance(15)) || (!me->onGround() && dy > 3.0f && m_random.chance(20)))
+                me->action(gameplay::Character::Run, gameplay::Character::Up);
+            else if(std::abs(dx) > 1.5f)
+                me->action(std::abs(dx) > 4.0f ? gameplay::Character::Run : gameplay::Character::Walk, side);
+            else if(m_random.chance(60))
+                me->action(gameplay::Character::Dodge, gameplay::Character::Fixed);
+            else
+                me->action(gameplay::Character::Walk, gameplay::Character::Fixed);
+        }
+};
+
+/** @brief Splits a list separated by commas. */
+std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::istringstream iss(list);
+    std::string item;
+    while(std::getline(iss, item, ','))
+        items.push_back(item);
+    return items;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> charas = argc > 2 ? split(argv[2]) : std::vector<std::string>();
+    int matches = argc > 3 ? std::atoi(argv[3]) : 100;
+    int threads = argc > 4 ? std::atoi(argv[4]) : (int)std::thread::hardware_concurrency();
+    uint32_t seed = argc > 5 ? (uint32_t)std::strtoul(argv[5], NULL, 10) : 1;
+    int players = (int)charas.size();
+    if(threads <= 0)
+        threads = 1;
+    if(argc < 3 || matches <= 0 || players < 2 || players > 4) {
+        std::cout << "Usage : " << argv[0] << " <stage> <characters, 2 to 4, separated by commas> [matches] [threads] [seed]" << std::endl;
+        return 1;
+    }
+    std::string stage = argv[1];
+
+    core::logger::init();
+    core::logger::addOutput(&std::cerr);
+    core::logger::minLevel(core::logger::WARNING);
+    events::Events evs;
+    evs.enableInput(false);
+    global::evs = &evs;
+
+    /* The matches are taken one after the other by the threads, each result having its place. */
+    std::vector<Result> results(matches);
+    std::atomic<int> next(0);
+    auto worker = [&] () {
+        for(int i = next++; i < matches; i = next++) {
+            Match match(i, seed + (uint32_t)i * 7919u, stage, charas);
+            results[i] = match.run(evs);
+        }
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for(int t = 0; t < threads; ++t)
+        pool.push_back(std::thread(worker));
+    for(std::thread& th : pool)
+        th.join();
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - begin).count();
+
+    std::vector<int> wins(players, 0);
+    int draws = 0;
+    int failed = 0;
+    unsigned long updates = 0;
+    for(const Result& res : results) {
+        if(!res.loaded) {
+            std::cout << "{\"match\": " << res.id << ", \"seed\": " << res.seed << ", \"loaded\": false}" << std::endl;
+            ++failed;
+            continue;
+        }
+        std::cout << "{\"match\": " << res.id << ", \"seed\": " << res.seed << ", \"updates\": " << res.updates
+            << ", \"winner\": " << res.winner << ", \"points\": [";
+        for(int i = 0; i < players; ++i)
+            std::cout << (i ? ", " : "") << res.points[i];
+        std::cout << "], \"damages\": [";
+        for(int i = 0; i < players; ++i)
+            std::cout << (i ? ", " : "") << res.damages[i];
+        std::cout << "], \"hash\": \"" << std::hex << std::setw(16) << std::setfill('0') << res.hash << std::dec
+            << std::setfill(' ') << "\", \"ms\": " << res.ms << "}" << std::endl;
+
+        if(res.winner >= 0)
+            ++wins[res.winner];
+        else
+            ++draws;
+        updates += res.updates;
+    }
+
+    std::cout << "{\"stage\": \"" << stage << "\", \"characters\": [";
+    for(int i = 0; i < players; ++i)
+        std::cout << (i ? ", " : "") << "\"" << charas[i] << "\"";
+    std::cout << "], \"matches\": " << matches << ", \"failed\": " << failed << ", \"threads\": " << threads
+        << ", \"seconds\": " << seconds
+        << ", \"matches_per_second\": " << (double)matches / seconds
+        << ", \"updates_per_second\": " << (double)updates / seconds
+        << ", \"wins\": [";
+    for(int i = 0; i < players; ++i)
+        std::cout << (i ? ", " : "") << wins[i];
+    std::cout << "], \"draws\": " << draws << "}" << std::endl;
+
+    core::logger::free();
+    return failed == 0 ? 0 : 1;
+}
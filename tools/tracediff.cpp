@@ -0,0 +1,37 @@
+#include <iostream>
+#include "core/logger.hpp"
+#include "core/trace.hpp"
+
+/* Compare two traces written with the phtrace option, and print the first frame and subsystem which diverge.
+ * Returns 0 if the traces are the same, 1 if they diverge and 2 if they couldn't be compared. */
+int main(int argc, char *argv[])
+{
+    /* Get arguments */
+    if(argc != 3) {
+        std::cout << "Usage : " << argv[0] << " reference.trace other.trace" << std::endl;
+        return 2;
+    }
+
+    core::logger::init();
+    core::logger::addOutput(&std::cerr);
+
+    core::Trace::Divergence div;
+    if(!core::Trace::diff(argv[1], argv[2], &div)) {
+        core::logger::free();
+        return 2;
+    }
+    core::logger::free();
+
+    if(!div.diverged) {
+        std::cout << "The traces are identical." << std::endl;
+        return 0;
+    }
+
+    if(div.column == "end")
+        std::cout << "A trace ends before the other, at frame " << div.frame << " (line " << div.line << ")." << std::endl;
+    else
+        std::cout << "The traces diverge at frame " << div.frame << " (line " << div.line << ") : first in "
+            << div.column << "." << std::endl;
+    return 1;
+}
+